@@ -1383,6 +1383,24 @@ CIVETWEB_API struct mg_connection *mg_connect_client(const char *host,
 													 size_t error_buffer_size);
 
 
+/* Urho3D: connect as mg_connect_client(), but give up waiting for the
+   connection once *stop_flag becomes non-zero. The flag is checked every
+   few seconds. */
+CIVETWEB_API struct mg_connection *
+mg_connect_client_interruptible(const char *host,
+								int port,
+								int use_ssl,
+								char *error_buffer,
+								size_t error_buffer_size,
+								volatile int *stop_flag);
+
+
+/* Urho3D: shut down the socket of a client connection from another thread,
+   so that a read or write blocked on it fails. The connection must still be
+   closed with mg_close_connection() by the thread using it. */
+CIVETWEB_API void mg_interrupt_connection(struct mg_connection *conn);
+
+
 struct mg_client_options {
 	const char *host;
 	int port;
@@ -6763,6 +6763,24 @@ mg_read(struct mg_connection *conn, void *buf, size_t len) {
                     return -1;
                 }
                 if (chunkSize == 0) {
+                    // Urho3D: consume the trailer up to the empty line ending the message, so that a kept-alive
+                    // client connection is positioned at the start of the next response
+                    int line_len = 0;
+                    for (;;) {
+                        char c;
+                        conn->content_len++;
+                        c = mg_getc(conn);
+                        if (c == '\n') {
+                            if (line_len == 0) {
+                                break;
+                            }
+                            line_len = 0;
+                        } else if (c == 0) {
+                            break;
+                        } else if (c != '\r') {
+                            line_len++;
+                        }
+                    }
                     break;
                 }
 
@@ -8734,7 +8752,8 @@ connect_socket(struct mg_context *ctx /* may be NULL */,
                char *ebuf,
                size_t ebuf_len,
                SOCKET *sock /* output: socket, must not be NULL */,
-               union usa *sa /* output: socket address, must not be NULL  */
+               union usa *sa /* output: socket address, must not be NULL  */,
+               volatile int *stop_flag /* Urho3D: may be NULL to use the stop flag of ctx */
 ) {
     int ip_ver = 0;
     int conn_ret = -1;
@@ -8914,7 +8933,7 @@ conn_ret = (int)err;
 		 */
         pfd[0].fd = *sock;
         pfd[0].events = POLLOUT;
-        pollres = mg_poll(pfd, 1, (int) (ms_wait), &(ctx->stop_flag));
+        pollres = mg_poll(pfd, 1, (int) (ms_wait), stop_flag ? stop_flag : &(ctx->stop_flag));
 
         if (pollres != 1) {
 /* Not connected */
@@ -16317,7 +16336,8 @@ static struct mg_connection *
 mg_connect_client_impl(const struct mg_client_options *client_options,
                        int use_ssl,
                        char *ebuf,
-                       size_t ebuf_len) {
+                       size_t ebuf_len,
+                       volatile int *stop_flag) {
     struct mg_connection *conn = NULL;
     SOCKET sock;
     union usa sa;
@@ -16368,7 +16388,8 @@ mg_connect_client_impl(const struct mg_client_options *client_options,
                         ebuf,
                         ebuf_len,
                         &sock,
-                        &sa)) {
+                        &sa,
+                        stop_flag)) {
 /* ebuf is set by connect_socket,
 		 * free all memory and return NULL; */
         mg_free(conn);
@@ -16523,7 +16544,8 @@ mg_connect_client_secure(const struct mg_client_options *client_options,
     return mg_connect_client_impl(client_options,
                                   1,
                                   error_buffer,
-                                  error_buffer_size);
+                                  error_buffer_size,
+                                  NULL);
 }
 
 
@@ -16540,7 +16562,37 @@ mg_connect_client(const char *host,
     return mg_connect_client_impl(&opts,
                                   use_ssl,
                                   error_buffer,
-                                  error_buffer_size);
+                                  error_buffer_size,
+                                  NULL);
+}
+
+
+// Urho3D: connect as mg_connect_client(), but give up once *stop_flag becomes non-zero
+struct mg_connection *
+mg_connect_client_interruptible(const char *host,
+                                int port,
+                                int use_ssl,
+                                char *error_buffer,
+                                size_t error_buffer_size,
+                                volatile int *stop_flag) {
+    struct mg_client_options opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.host = host;
+    opts.port = port;
+    return mg_connect_client_impl(&opts,
+                                  use_ssl,
+                                  error_buffer,
+                                  error_buffer_size,
+                                  stop_flag);
+}
+
+
+// Urho3D: shut down the socket of a client connection, so that a read or write blocked on it in another thread fails
+void
+mg_interrupt_connection(struct mg_connection *conn) {
+    if (conn && (conn->client.sock != INVALID_SOCKET)) {
+        shutdown(conn->client.sock, SHUTDOWN_BOTH);
+    }
 }
 
 
@@ -16764,13 +16816,31 @@ return 0;
 
 static int
 get_message(struct mg_connection *conn, char *ebuf, size_t ebuf_len, int *err) {
+    // Urho3D: on a reused connection, keep the data received beyond the previous message, so that pipelined
+    // requests and responses are not discarded
+    int unread_start = 0;
+    int unread_len = 0;
+
     if (ebuf_len > 0) {
         ebuf[0] = '\0';
     }
     *err = 0;
 
+    if (conn && (conn->connection_type == CONNECTION_TYPE_RESPONSE) && (conn->request_len > 0)) {
+        unread_start = conn->request_len + (int) conn->consumed_content;
+        unread_len = conn->data_len - unread_start;
+    } else if (conn && (conn->connection_type == CONNECTION_TYPE_REQUEST)) {
+        // The server has already moved the unread data to the start of the buffer
+        unread_len = conn->data_len;
+    }
+
     reset_per_request_attributes(conn);
 
+    if (unread_len > 0) {
+        memmove(conn->buf, conn->buf + unread_start, (size_t) unread_len);
+        conn->data_len = unread_len;
+    }
+
     if (!conn) {
         mg_snprintf(conn,
                     NULL, /* No truncation check for ebuf */
@@ -0,0 +1,465 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/Engine.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/Input/InputEvents.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Network/Protocol.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SmoothedTransform.h>
+
+#include <slikenet/MessageIdentifiers.h>
+#include <slikenet/peerinterface.h>
+
+#include <EASTL/sort.h>
+
+using namespace Urho3D;
+
+/// Simulated client: a client-side Connection with its own peer and scene, pumped by the load test instead of the Network subsystem.
+struct SimulatedClient
+{
+    /// Peer used only by this client.
+    SLNet::RakPeerInterface* peer_{};
+    /// Client connection to the server.
+    SharedPtr<Connection> connection_;
+    /// Scene replicated from the server.
+    SharedPtr<Scene> scene_;
+    /// Replicated probe node, found once the scene has been received.
+    WeakPtr<Node> probe_;
+    /// Last server time stamp seen on the probe node.
+    float lastStamp_{};
+    /// Whether the connection has been accepted.
+    bool connected_{};
+    /// Whether the connection was refused or lost.
+    bool failed_{};
+};
+
+/// Return value at given percentile (0-100) of sorted samples.
+static float GetPercentile(const ea::vector<float>& sorted, float percentile)
+{
+    if (sorted.empty())
+        return 0.0f;
+    const auto index = static_cast<unsigned>(percentile * 0.01f * (sorted.size() - 1) + 0.5f);
+    return sorted[Min(index, static_cast<unsigned>(sorted.size() - 1))];
+}
+
+/// Return average of samples.
+static float GetAverage(const ea::vector<float>& samples)
+{
+    if (samples.empty())
+        return 0.0f;
+    double sum = 0.0;
+    for (float value : samples)
+        sum += value;
+    return static_cast<float>(sum / samples.size());
+}
+
+/// Headless network load test. Runs a server scene with scripted movement and a number of simulated clients over
+/// loopback in the same process, then reports server tick time, bandwidth per client and replication latency.
+class NetworkLoadTest : public Application
+{
+    URHO3D_OBJECT(NetworkLoadTest, Application);
+
+public:
+    explicit NetworkLoadTest(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_RESOURCE_PATHS] = "CoreData";
+        engineParameters_[EP_LOG_NAME] = EMPTY_STRING;
+        engineParameters_[EP_LOG_LEVEL] = LOG_WARNING;
+
+        auto& app = GetCommandLineParser();
+        app.add_option("-c,--clients", numClients_, "Number of simulated clients.")->set_default_val("8");
+        app.add_option("-n,--nodes", numNodes_, "Number of moving replicated nodes.")->set_default_val("1000");
+        app.add_option("-d,--duration", duration_, "Measurement duration in seconds.")->set_default_val("10");
+        app.add_option("-f,--fps", fps_, "Server frame rate and network update rate.")->set_default_val("30");
+        app.add_option("-p,--port", port_, "Loopback port of the server.")->set_default_val("2345");
+        app.add_option("--latency", latency_, "Simulated latency in milliseconds.")->set_default_val("0");
+        app.add_option("--loss", packetLoss_, "Simulated packet loss probability.")->set_default_val("0");
+        app.add_flag("--snapshot", snapshot_, "Send latest data in unreliable snapshots.");
+        app.add_flag("--parallel", parallel_, "Build server updates for connections in parallel.");
+    }
+
+    void Start() override
+    {
+        auto* network = GetSubsystem<Network>();
+        network->SetUpdateFps(fps_);
+        network->SetSnapshotReplication(snapshot_);
+        network->SetParallelReplication(parallel_);
+        network->SetSimulatedLatency(latency_);
+        network->SetSimulatedPacketLoss(packetLoss_);
+        engine_->SetMaxFps(fps_);
+
+        CreateServerScene();
+        if (!network->StartServer(port_, numClients_))
+        {
+            ErrorExit(Format("Failed to start server on port {}", port_));
+            return;
+        }
+
+        clients_.resize(numClients_);
+        for (SimulatedClient& client : clients_)
+            ConnectClient(client);
+
+        SubscribeToEvent(E_CLIENTCONNECTED, URHO3D_HANDLER(NetworkLoadTest, HandleClientConnected));
+        SubscribeToEvent(E_NETWORKUPDATE, URHO3D_HANDLER(NetworkLoadTest, HandleNetworkUpdate));
+        SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(NetworkLoadTest, HandleBeginFrame));
+        SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(NetworkLoadTest, HandleUpdate));
+        SubscribeToEvent(E_POSTRENDERUPDATE, URHO3D_HANDLER(NetworkLoadTest, HandlePostRenderUpdate));
+
+        PrintLine(Format("Connecting {} clients to a server scene with {} nodes...", numClients_, numNodes_));
+    }
+
+    void Stop() override
+    {
+        for (SimulatedClient& client : clients_)
+        {
+            client.connection_.Reset();
+            if (client.peer_)
+            {
+                client.peer_->Shutdown(0);
+                SLNet::RakPeerInterface::DestroyInstance(client.peer_);
+            }
+        }
+        clients_.clear();
+    }
+
+private:
+    /// Create the server scene with the moving nodes and the latency probe.
+    void CreateServerScene()
+    {
+        scene_ = new Scene(context_);
+
+        const auto gridSize = static_cast<unsigned>(ceilf(sqrtf(static_cast<float>(numNodes_))));
+        nodes_.reserve(numNodes_);
+        homePositions_.reserve(numNodes_);
+        for (unsigned i = 0; i < numNodes_; ++i)
+        {
+            const Vector3 home = Vector3(static_cast<float>(i % gridSize), 0.0f, static_cast<float>(i / gridSize)) * 4.0f;
+            Node* node = scene_->CreateChild("Mover");
+            node->SetPosition(home);
+            nodes_.push_back(node);
+            homePositions_.push_back(home);
+        }
+
+        // The probe carries the server clock in its position, so that clients can measure how long a transform takes to arrive
+        probe_ = scene_->CreateChild("Probe");
+    }
+
+    /// Start the peer of a simulated client and begin connecting to the server.
+    void ConnectClient(SimulatedClient& client)
+    {
+        client.peer_ = SLNet::RakPeerInterface::GetInstance();
+        SLNet::SocketDescriptor socket;
+        client.peer_->Startup(2, &socket, 1);
+        if (client.peer_->Connect("127.0.0.1", port_, nullptr, 0) != SLNet::CONNECTION_ATTEMPT_STARTED)
+        {
+            URHO3D_LOGERROR("Failed to start connection of simulated client");
+            client.failed_ = true;
+            return;
+        }
+
+        client.scene_ = new Scene(context_);
+        client.scene_->SetUpdateEnabled(false);
+        client.connection_ = new Connection(context_);
+        client.connection_->Initialize(false, client.peer_->GetMyBoundAddress(), client.peer_);
+        client.connection_->SetScene(client.scene_);
+        client.connection_->SetConnectPending(true);
+        client.connection_->ConfigureNetworkSimulator(latency_, packetLoss_);
+    }
+
+    /// Process incoming packets of a simulated client, as the Network subsystem does for its own server connection.
+    void ReceiveClientPackets(SimulatedClient& client)
+    {
+        while (SLNet::Packet* packet = client.peer_->Receive())
+        {
+            unsigned char packetID = packet->data[0];
+            unsigned dataStart = sizeof(char);
+            if (packetID == ID_TIMESTAMP)
+            {
+                dataStart += sizeof(SLNet::Time);
+                packetID = packet->data[dataStart];
+                dataStart += sizeof(char);
+            }
+
+            if (packetID == ID_CONNECTION_REQUEST_ACCEPTED)
+            {
+                client.connected_ = true;
+                client.connection_->SetConnectPending(false);
+                client.connection_->SetAddressOrGUID(packet->systemAddress);
+
+                VectorBuffer msg;
+                msg.WriteVariantMap(client.connection_->GetIdentity());
+                client.connection_->SendMessage(MSG_IDENTITY, true, true, msg);
+            }
+            else if (packetID == ID_CONNECTION_ATTEMPT_FAILED || packetID == ID_CONNECTION_LOST ||
+                packetID == ID_DISCONNECTION_NOTIFICATION || packetID == ID_NO_FREE_INCOMING_CONNECTIONS)
+            {
+                URHO3D_LOGERROR("Simulated client lost connection to server");
+                client.failed_ = true;
+            }
+            else if (packetID >= ID_USER_PACKET_ENUM)
+            {
+                const unsigned messageID = *reinterpret_cast<unsigned*>(packet->data + dataStart);
+                dataStart += sizeof(unsigned);
+
+                MemoryBuffer buffer(packet->data + dataStart, packet->length - dataStart);
+                client.connection_->ProcessMessage(messageID, buffer);
+            }
+
+            client.peer_->DeallocatePacket(packet);
+        }
+    }
+
+    /// Return the server time stamp last received on a client probe node. Client scenes are not updated, to keep the clients
+    /// lightweight, so the received transform is read from the smoothing target rather than the node itself.
+    static float GetProbeStamp(Node* probe)
+    {
+        auto* transform = probe->GetComponent<SmoothedTransform>();
+        return transform ? transform->GetTargetPosition().y_ : probe->GetPosition().y_;
+    }
+
+    /// Sample replication latency from the probe node of a simulated client.
+    void SampleLatency(SimulatedClient& client, float now)
+    {
+        if (!client.probe_)
+        {
+            client.probe_ = client.scene_->GetChild("Probe");
+            if (!client.probe_)
+                return;
+            client.lastStamp_ = GetProbeStamp(client.probe_);
+        }
+
+        const float stamp = GetProbeStamp(client.probe_);
+        if (stamp != client.lastStamp_)
+        {
+            client.lastStamp_ = stamp;
+            if (measuring_)
+                latencies_.push_back(now - stamp);
+        }
+    }
+
+    /// Return whether every simulated client has loaded the scene and received the probe node.
+    bool AreClientsReady() const
+    {
+        for (const SimulatedClient& client : clients_)
+        {
+            if (!client.failed_ && (!client.connection_->IsSceneLoaded() || !client.probe_))
+                return false;
+        }
+        return true;
+    }
+
+    /// Handle a client connecting to the server: make it join the scene.
+    void HandleClientConnected(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace ClientConnected;
+
+        auto* connection = static_cast<Connection*>(eventData[P_CONNECTION].GetPtr());
+        connection->SetScene(scene_);
+    }
+
+    /// Handle network update: simulated clients send their controls on the same schedule as a real client.
+    void HandleNetworkUpdate(StringHash eventType, VariantMap& eventData)
+    {
+        sendClientUpdates_ = true;
+    }
+
+    /// Handle the start of a frame: run the simulated clients, then start timing the server tick.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+    {
+        const float now = GetClockMSec();
+        for (SimulatedClient& client : clients_)
+        {
+            if (client.failed_)
+                continue;
+
+            ReceiveClientPackets(client);
+            SampleLatency(client, now);
+
+            if (sendClientUpdates_ && client.connected_)
+            {
+                Controls controls;
+                controls.yaw_ = now * 0.01f;
+                client.connection_->SetControls(controls);
+                client.connection_->SendClientUpdate();
+                client.connection_->SendRemoteEvents();
+                client.connection_->SendAllBuffers();
+            }
+        }
+        sendClientUpdates_ = false;
+
+        if (!measuring_ && AreClientsReady())
+        {
+            PrintLine(Format("All clients joined in {:.1f} s, measuring for {} s...", now * 0.001f, duration_));
+            measuring_ = true;
+            measureTimer_.Reset();
+        }
+        else if (!measuring_ && now > 30000.0f)
+        {
+            PrintLine("Timed out waiting for clients to join the scene.", true);
+            SendEvent(E_EXITREQUESTED);
+        }
+
+        tickTimer_.Reset();
+    }
+
+    /// Handle scene update: move the nodes along scripted circles and stamp the probe with the server clock.
+    void HandleUpdate(StringHash eventType, VariantMap& eventData)
+    {
+        const float time = GetClockMSec() * 0.001f;
+        for (unsigned i = 0; i < nodes_.size(); ++i)
+        {
+            const float angle = time * 90.0f + i * 37.0f;
+            nodes_[i]->SetPosition(homePositions_[i] + Vector3(Cos(angle), 0.0f, Sin(angle)));
+            nodes_[i]->SetRotation(Quaternion(angle, Vector3::UP));
+        }
+
+        probe_->SetPosition(Vector3(0.0f, GetClockMSec(), 0.0f));
+    }
+
+    /// Handle the end of the frame update: record the server tick time and sample bandwidth.
+    void HandlePostRenderUpdate(StringHash eventType, VariantMap& eventData)
+    {
+        if (!measuring_)
+            return;
+
+        tickTimes_.push_back(tickTimer_.GetUSec(false) * 0.001f);
+
+        if (bandwidthTimer_.GetMSec(false) >= 1000)
+        {
+            bandwidthTimer_.Reset();
+            for (Connection* connection : GetSubsystem<Network>()->GetClientConnections())
+            {
+                bytesOut_.push_back(connection->GetBytesOutPerSec());
+                bytesIn_.push_back(connection->GetBytesInPerSec());
+            }
+        }
+
+        if (measureTimer_.GetMSec(false) >= duration_ * 1000)
+        {
+            Report();
+            // Without a window there is nothing for Engine::Exit() to close, so request the exit directly
+            SendEvent(E_EXITREQUESTED);
+        }
+    }
+
+    /// Print the results.
+    void Report()
+    {
+        unsigned numConnected = 0;
+        for (const SimulatedClient& client : clients_)
+        {
+            if (!client.failed_)
+                ++numConnected;
+        }
+
+        ea::quick_sort(tickTimes_.begin(), tickTimes_.end());
+        ea::quick_sort(latencies_.begin(), latencies_.end());
+
+        PrintLine(Format("Clients: {} of {} connected, nodes: {}, frames: {}", numConnected, numClients_, numNodes_,
+            tickTimes_.size()));
+        PrintLine(Format("Server tick ms: avg {:.3f}, p50 {:.3f}, p95 {:.3f}, p99 {:.3f}, max {:.3f}", GetAverage(tickTimes_),
+            GetPercentile(tickTimes_, 50.0f), GetPercentile(tickTimes_, 95.0f), GetPercentile(tickTimes_, 99.0f),
+            tickTimes_.empty() ? 0.0f : tickTimes_.back()));
+        PrintLine(Format("Per client KB/s: out {:.2f}, in {:.2f}", GetAverage(bytesOut_) / 1024.0f,
+            GetAverage(bytesIn_) / 1024.0f));
+        PrintLine(Format("Replication latency ms: p50 {:.1f}, p95 {:.1f}, p99 {:.1f}, max {:.1f} ({} samples)",
+            GetPercentile(latencies_, 50.0f), GetPercentile(latencies_, 95.0f), GetPercentile(latencies_, 99.0f),
+            latencies_.empty() ? 0.0f : latencies_.back(), latencies_.size()));
+    }
+
+    /// Return time since start in milliseconds, shared by the server and the simulated clients.
+    float GetClockMSec() { return clock_.GetUSec(false) * 0.001f; }
+
+    /// Number of simulated clients.
+    unsigned numClients_{8};
+    /// Number of moving nodes.
+    unsigned numNodes_{1000};
+    /// Measurement duration in seconds.
+    unsigned duration_{10};
+    /// Server frame and network update rate.
+    int fps_{30};
+    /// Server port.
+    unsigned short port_{2345};
+    /// Simulated latency in milliseconds.
+    int latency_{};
+    /// Simulated packet loss probability.
+    float packetLoss_{};
+    /// Whether to use snapshot replication.
+    bool snapshot_{};
+    /// Whether to use parallel replication.
+    bool parallel_{};
+
+    /// Server scene.
+    SharedPtr<Scene> scene_;
+    /// Moving server nodes.
+    ea::vector<Node*> nodes_;
+    /// Center of the circle each moving node follows.
+    ea::vector<Vector3> homePositions_;
+    /// Server latency probe node.
+    Node* probe_{};
+    /// Simulated clients.
+    ea::vector<SimulatedClient> clients_;
+    /// Whether simulated clients should send their update this frame.
+    bool sendClientUpdates_{};
+    /// Whether all clients have joined and results are being collected.
+    bool measuring_{};
+
+    /// Clock shared by the server and the clients.
+    HiresTimer clock_;
+    /// Server tick timer.
+    HiresTimer tickTimer_;
+    /// Measurement duration timer.
+    Timer measureTimer_;
+    /// Bandwidth sampling timer.
+    Timer bandwidthTimer_;
+    /// Server tick times in milliseconds.
+    ea::vector<float> tickTimes_;
+    /// Replication latencies in milliseconds.
+    ea::vector<float> latencies_;
+    /// Bytes per second sent to each client, sampled once per second.
+    ea::vector<float> bytesOut_;
+    /// Bytes per second received from each client, sampled once per second.
+    ea::vector<float> bytesIn_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(NetworkLoadTest);
@@ -4,6 +4,7 @@
 %ignore Urho3D::Context::GetObjectCategories;
 %ignore Urho3D::Context::GetSubsystems;
 %ignore Urho3D::Context::GetObjectFactories;
+%ignore Urho3D::Context::GetEventQueue;
 
 
 // Extend Context with extra code
@@ -1,7 +1,7 @@
 %include "eastl_map.i"
 %include "eastl_unordered_map.i"
 
-%template(VariantMap)                   eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant>;
+%template(VariantMap)                   eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator>;
 %template(AttributeMap)                 eastl::unordered_map<Urho3D::StringHash, eastl::vector<Urho3D::AttributeInfo>>;
 %template(PackageMap)                   eastl::unordered_map<eastl::string, Urho3D::PackageEntry>;
 %template(JSONObject)                   eastl::map<eastl::string, Urho3D::JSONValue>;
@@ -433,6 +433,8 @@ public:
 %ignore Urho3D::NodeReplicationState::dirtyVars_;		// Needs HashSet wrapped
 %ignore Urho3D::Animatable::animatedNetworkAttributes_; // Needs HashSet wrapped
 %ignore Urho3D::AsyncProgress::resources_;
+%ignore Urho3D::AsyncProgress::parser_;
+%ignore Urho3D::AsyncProgress::parsedNodes_;
 %ignore Urho3D::ValueAnimation::GetKeyFrames;
 %ignore Urho3D::Serializable::networkState_;
 %ignore Urho3D::Serializable::instanceDefaultValues_;
@@ -458,6 +460,8 @@ public:
 %include "Urho3D/Scene/ValueAnimation.h"
 %include "Urho3D/Scene/LogicComponent.h"
 %include "Urho3D/Scene/ObjectAnimation.h"
+%ignore Urho3D::Prefab::GetNodeData;
+%include "Urho3D/Scene/Prefab.h"
 %include "Urho3D/Scene/SceneResolver.h"
 %include "Urho3D/Scene/SmoothedTransform.h"
 %include "Urho3D/Scene/UnknownComponent.h"
@@ -1,8 +1,8 @@
 %typemap(cscode) Urho3D::Context %{
-  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) EventDataMap {
+  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) EventDataMap {
     get { return GetEventDataMap(); }
   }
-  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) GlobalVars {
+  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) GlobalVars {
     get { return GetGlobalVars(); }
   }
   /*public _typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::SharedPtr<Urho3D::Object>> &) Subsystems {
@@ -89,13 +89,13 @@
 %csmethodmodifiers Urho3D::TypeInfo::GetTypeName "private";
 %csmethodmodifiers Urho3D::TypeInfo::GetBaseTypeInfo "private";
 %typemap(cscode) Urho3D::Object %{
-  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) EventDataMap {
+  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) EventDataMap {
     get { return GetEventDataMap(); }
   }
   public $typemap(cstype, Urho3D::Context *) Context {
     get { return GetContext(); }
   }
-  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) GlobalVars {
+  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) GlobalVars {
     get { return GetGlobalVars(); }
   }
   public $typemap(cstype, Urho3D::Object *) EventSender {
@@ -278,7 +278,7 @@
   public $typemap(cstype, const eastl::vector<eastl::string> &) StringList {    // custom name
     get { return GetStringVector(); }
   }
-  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) VariantMap {
+  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) VariantMap {
     get { return GetVariantMap(); }
   }
   public $typemap(cstype, const Urho3D::Rect &) Rect {
@@ -317,7 +317,7 @@
   public $typemap(cstype, eastl::vector<eastl::string> *) StringVectorPtr {
     get { return GetStringVectorPtr(); }
   }
-  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> *) VariantMapPtr {
+  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> *) VariantMapPtr {
     get { return GetVariantMapPtr(); }
   }*/
 %}
@@ -58,7 +58,7 @@
   public $typemap(cstype, Urho3D::Variant) Variant {
     get { return GetVariant(); }
   }
-  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant>) VariantMap {
+  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator>) VariantMap {
     get { return GetVariantMap(); }
   }
   public $typemap(cstype, eastl::vector<Urho3D::Variant>) VariantList {
@@ -280,7 +280,7 @@
   public $typemap(cstype, eastl::vector<eastl::string>) StringList {
     get { return GetStringVector(); }
   }
-  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant>) VariantMap {
+  public $typemap(cstype, eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator>) VariantMap {
     get { return GetVariantMap(); }
   }
   public $typemap(cstype, Urho3D::XMLFile *) File {
@@ -165,14 +165,14 @@
   public $typemap(cstype, const eastl::vector<Urho3D::WeakPtr<Urho3D::Component>>) Listeners {
     get { return GetListeners(); }
   }
-  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) Vars {
+  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) Vars {
     get { return GetVars(); }
   }
   public $typemap(cstype, const Urho3D::Vector3 &) NetPositionAttr {
     get { return GetNetPositionAttr(); }
     set { SetNetPositionAttr(value); }
   }
-  public $typemap(cstype, const eastl::vector<unsigned char> &) NetRotationAttr {
+  public $typemap(cstype, const Urho3D::Quaternion &) NetRotationAttr {
     get { return GetNetRotationAttr(); }
     set { SetNetRotationAttr(value); }
   }
@@ -1194,7 +1194,7 @@
   public $typemap(cstype, const Urho3D::Color &) DerivedColor {
     get { return GetDerivedColor(); }
   }
-  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant> &) Vars {
+  public $typemap(cstype, const eastl::unordered_map<Urho3D::StringHash, Urho3D::Variant, eastl::hash<Urho3D::StringHash>, eastl::equal_to<Urho3D::StringHash>, Urho3D::FreeListAllocator> &) Vars {
     get { return GetVars(); }
   }
   public $typemap(cstype, const eastl::vector<eastl::string> &) Tags {
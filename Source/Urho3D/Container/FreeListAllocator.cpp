@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Container/FreeListAllocator.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Granularity of cached block sizes.
+const size_t SIZE_CLASS_GRANULARITY = 16;
+/// Number of cached block sizes.
+const size_t NUM_SIZE_CLASSES = 8;
+/// Largest cached block size.
+const size_t MAX_CACHED_BLOCK_SIZE = SIZE_CLASS_GRANULARITY * NUM_SIZE_CLASSES;
+/// Maximum number of free blocks kept per size class and thread.
+const unsigned MAX_FREE_BLOCKS = 1024;
+
+/// Free block.
+struct FreeBlock
+{
+    /// Next free block.
+    FreeBlock* next_;
+};
+
+/// Per-thread free lists of small blocks. Trivially destructible, so it stays usable while other thread-local and static objects are destroyed.
+struct FreeLists
+{
+    /// First free block per size class.
+    FreeBlock* heads_[NUM_SIZE_CLASSES];
+    /// Number of free blocks per size class.
+    unsigned sizes_[NUM_SIZE_CLASSES];
+    /// Whether the releaser is registered for the thread.
+    bool registered_;
+    /// Whether the cached blocks are released on thread exit and caching is disabled.
+    bool released_;
+};
+
+thread_local FreeLists freeLists;
+
+/// Frees the cached blocks on thread exit.
+struct FreeListsReleaser
+{
+    /// Destruct.
+    ~FreeListsReleaser()
+    {
+        ea::allocator allocator;
+        for (size_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+        {
+            while (FreeBlock* block = freeLists.heads_[i])
+            {
+                freeLists.heads_[i] = block->next_;
+                allocator.deallocate(block, (i + 1) * SIZE_CLASS_GRANULARITY);
+            }
+            freeLists.sizes_[i] = 0;
+        }
+        freeLists.released_ = true;
+    }
+};
+
+thread_local FreeListsReleaser freeListsReleaser;
+
+/// Return size class index of a block size. Block size must be non-zero.
+inline size_t GetSizeClass(size_t n) { return (n - 1) / SIZE_CLASS_GRANULARITY; }
+
+}
+
+void* FreeListAllocator::allocate(size_t n, int flags)
+{
+    if (n == 0 || n > MAX_CACHED_BLOCK_SIZE)
+        return ea::allocator().allocate(n, flags);
+
+    const size_t sizeClass = GetSizeClass(n);
+    if (FreeBlock* block = freeLists.heads_[sizeClass])
+    {
+        freeLists.heads_[sizeClass] = block->next_;
+        --freeLists.sizes_[sizeClass];
+        return block;
+    }
+
+    // Allocate the whole size class so that the block may be reused for any size of the class
+    return ea::allocator().allocate((sizeClass + 1) * SIZE_CLASS_GRANULARITY, flags);
+}
+
+void* FreeListAllocator::allocate(size_t n, size_t alignment, size_t offset, int flags)
+{
+    // Cached blocks have the default alignment of the underlying allocator
+    if (alignment <= EASTL_SYSTEM_ALLOCATOR_MIN_ALIGNMENT && offset == 0)
+        return allocate(n, flags);
+
+    return ea::allocator().allocate(n, alignment, offset, flags);
+}
+
+void FreeListAllocator::deallocate(void* p, size_t n)
+{
+    if (!p)
+        return;
+
+    if (n == 0 || n > MAX_CACHED_BLOCK_SIZE)
+    {
+        ea::allocator().deallocate(p, n);
+        return;
+    }
+
+    const size_t sizeClass = GetSizeClass(n);
+    if (freeLists.released_ || freeLists.sizes_[sizeClass] >= MAX_FREE_BLOCKS)
+    {
+        ea::allocator().deallocate(p, (sizeClass + 1) * SIZE_CLASS_GRANULARITY);
+        return;
+    }
+
+    if (!freeLists.registered_)
+    {
+        // Access the releaser to construct it for this thread
+        (void)&freeListsReleaser;
+        freeLists.registered_ = true;
+    }
+
+    auto* block = static_cast<FreeBlock*>(p);
+    block->next_ = freeLists.heads_[sizeClass];
+    freeLists.heads_[sizeClass] = block;
+    ++freeLists.sizes_[sizeClass];
+}
+
+}
@@ -0,0 +1,66 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <Urho3D/Urho3D.h>
+
+#include <EASTL/allocator.h>
+
+namespace Urho3D
+{
+
+/// Stateless EASTL allocator which keeps freed small blocks in a per-thread free list for reuse.
+/// Intended for node-based containers that are frequently cleared and refilled, such as event data maps.
+/// Blocks may be freed on a different thread than they were allocated on.
+class URHO3D_API FreeListAllocator
+{
+public:
+    /// Construct.
+    explicit FreeListAllocator(const char* /*name*/ = nullptr) { }
+    /// Construct from other allocator.
+    FreeListAllocator(const FreeListAllocator& /*other*/, const char* /*name*/) { }
+    /// Copy-construct.
+    FreeListAllocator(const FreeListAllocator& other) = default;
+    /// Assign.
+    FreeListAllocator& operator =(const FreeListAllocator& other) = default;
+
+    /// Allocate memory.
+    void* allocate(size_t n, int flags = 0);
+    /// Allocate aligned memory.
+    void* allocate(size_t n, size_t alignment, size_t offset, int flags = 0);
+    /// Free memory.
+    void deallocate(void* p, size_t n);
+
+    /// Return debug name.
+    const char* get_name() const { return "FreeListAllocator"; }
+    /// Set debug name. Ignored.
+    void set_name(const char* /*name*/) { }
+};
+
+/// Compare allocators. All instances are interchangeable.
+inline bool operator ==(const FreeListAllocator& /*lhs*/, const FreeListAllocator& /*rhs*/) { return true; }
+/// Compare allocators. All instances are interchangeable.
+inline bool operator !=(const FreeListAllocator& /*lhs*/, const FreeListAllocator& /*rhs*/) { return false; }
+
+}
@@ -106,9 +106,10 @@ template <class T, class Allocator> struct hash<vector<T, Allocator>>
     }
 };
 
-template <typename Key, typename T> struct hash<unordered_map<Key, T>>
+template <typename Key, typename T, typename Hash, typename Predicate, typename Allocator, bool bCacheHashCode>
+struct hash<unordered_map<Key, T, Hash, Predicate, Allocator, bCacheHashCode>>
 {
-    size_t operator()(const unordered_map<Key, T>& s) const
+    size_t operator()(const unordered_map<Key, T, Hash, Predicate, Allocator, bCacheHashCode>& s) const
     {
         size_t result = 16777619;
         for (const auto& pair : s)
@@ -0,0 +1,173 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Math/MathDefs.h"
+
+#include <EASTL/unique_ptr.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/utility.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Map from object IDs to object pointers, for IDs that are allocated mostly sequentially upward from a first ID. Entries are stored densely for cache-friendly iteration, and a paged index gives constant-time lookup, insertion and removal without hashing. IDs too far from the first ID fall back to a hashed index. Removal moves the last entry into the hole, so iteration order is not stable.
+template <class T> class IdMap
+{
+public:
+    /// Entry of ID and object.
+    using Entry = ea::pair<unsigned, T*>;
+    /// Const iterator over entries.
+    using ConstIterator = typename ea::vector<Entry>::const_iterator;
+
+    /// Number of IDs per index page.
+    static const unsigned PAGE_SIZE = 1024;
+    /// Number of pages addressed directly from the first ID.
+    static const unsigned MAX_PAGES = 16384;
+
+    /// Construct with the first ID of the expected range.
+    explicit IdMap(unsigned firstId = 0) : firstId_(firstId) { }
+
+    /// Return object with ID, or null if not found.
+    T* Get(unsigned id) const
+    {
+        const unsigned* slot = FindSlot(id);
+        return slot && *slot ? entries_[*slot - 1].second : nullptr;
+    }
+
+    /// Return whether ID is in use.
+    bool Contains(unsigned id) const
+    {
+        const unsigned* slot = FindSlot(id);
+        return slot && *slot;
+    }
+
+    /// Set object with ID, replacing any existing one.
+    void Set(unsigned id, T* object)
+    {
+        unsigned& slot = GetOrCreateSlot(id);
+        if (slot)
+            entries_[slot - 1].second = object;
+        else
+        {
+            entries_.emplace_back(id, object);
+            slot = entries_.size();
+        }
+    }
+
+    /// Remove ID. Return true if it was in use.
+    bool Erase(unsigned id)
+    {
+        unsigned* slot = FindSlot(id);
+        if (!slot || !*slot)
+            return false;
+
+        const unsigned index = *slot - 1;
+        ClearSlot(id, slot);
+
+        // Keep the entries dense by moving the last one into the hole
+        if (index + 1 != entries_.size())
+        {
+            entries_[index] = entries_.back();
+            *FindSlot(entries_[index].first) = index + 1;
+        }
+        entries_.pop_back();
+        return true;
+    }
+
+    /// Remove all entries and free the index.
+    void Clear()
+    {
+        entries_.clear();
+        pages_.clear();
+        overflowSlots_.clear();
+    }
+
+    /// Reserve space for entries.
+    void Reserve(unsigned numEntries) { entries_.reserve(numEntries); }
+
+    /// Return number of entries.
+    unsigned Size() const { return entries_.size(); }
+    /// Return whether there are no entries.
+    bool Empty() const { return entries_.empty(); }
+
+    /// Return iterator to the first entry.
+    ConstIterator begin() const { return entries_.begin(); }
+    /// Return iterator past the last entry.
+    ConstIterator end() const { return entries_.end(); }
+
+private:
+    /// Return index slot of ID, or null if its page does not exist. Slot value is entry index + 1, or 0 if unused.
+    unsigned* FindSlot(unsigned id) const
+    {
+        const unsigned offset = id - firstId_;
+        const unsigned pageIndex = offset / PAGE_SIZE;
+        if (id >= firstId_ && pageIndex < MAX_PAGES)
+            return pageIndex < pages_.size() && pages_[pageIndex] ? &pages_[pageIndex][offset % PAGE_SIZE] : nullptr;
+
+        auto iter = overflowSlots_.find(id);
+        return iter != overflowSlots_.end() ? const_cast<unsigned*>(&iter->second) : nullptr;
+    }
+
+    /// Return index slot of ID, creating the page if necessary.
+    unsigned& GetOrCreateSlot(unsigned id)
+    {
+        const unsigned offset = id - firstId_;
+        const unsigned pageIndex = offset / PAGE_SIZE;
+        if (id >= firstId_ && pageIndex < MAX_PAGES)
+        {
+            if (pageIndex >= pages_.size())
+                pages_.resize(pageIndex + 1);
+            if (!pages_[pageIndex])
+                pages_[pageIndex].reset(new unsigned[PAGE_SIZE]());
+            return pages_[pageIndex][offset % PAGE_SIZE];
+        }
+
+        return overflowSlots_[id];
+    }
+
+    /// Clear index slot of ID.
+    void ClearSlot(unsigned id, unsigned* slot)
+    {
+        const unsigned pageIndex = (id - firstId_) / PAGE_SIZE;
+        if (id >= firstId_ && pageIndex < MAX_PAGES)
+            *slot = 0;
+        else
+            overflowSlots_.erase(id);
+    }
+
+    /// First ID of the directly indexed range.
+    unsigned firstId_;
+    /// Entries.
+    ea::vector<Entry> entries_;
+    /// Index pages for the directly indexed range. Allocated on demand.
+    ea::vector<ea::unique_ptr<unsigned[]>> pages_;
+    /// Index for IDs outside the directly indexed range.
+    ea::unordered_map<unsigned, unsigned> overflowSlots_;
+};
+
+}
@@ -56,6 +56,57 @@ enum AttributeMode
 };
 URHO3D_FLAGSET(AttributeMode, AttributeModeFlags);
 
+/// Quantization of an attribute value in network replication.
+enum AttributeQuantizationMode
+{
+    /// Value is sent at full precision.
+    AQ_NONE = 0,
+    /// Each component of a float, Vector2, Vector3 or Vector4 value is clamped to a range and sent with a fixed number of bits.
+    AQ_RANGE,
+    /// Quaternion value is sent in smallest-three form with a fixed number of bits per component.
+    AQ_QUATERNION,
+};
+
+/// Network quantization of an attribute value. Both peers must use the same quantization.
+struct AttributeQuantization
+{
+    /// Construct no quantization.
+    AttributeQuantization() = default;
+    /// Construct range quantization.
+    AttributeQuantization(float minValue, float maxValue, unsigned numBits) :
+        mode_(AQ_RANGE),
+        minValue_(minValue),
+        maxValue_(maxValue),
+        numBits_(numBits)
+    {
+    }
+    /// Construct quaternion quantization.
+    explicit AttributeQuantization(unsigned numBitsPerComponent) :
+        mode_(AQ_QUATERNION),
+        numBits_(numBitsPerComponent)
+    {
+    }
+
+    /// Return whether a value of given type is quantized.
+    bool IsApplicable(VariantType type) const
+    {
+        if (mode_ == AQ_RANGE)
+            return type == VAR_FLOAT || type == VAR_VECTOR2 || type == VAR_VECTOR3 || type == VAR_VECTOR4;
+        if (mode_ == AQ_QUATERNION)
+            return type == VAR_QUATERNION;
+        return false;
+    }
+
+    /// Quantization mode.
+    AttributeQuantizationMode mode_ = AQ_NONE;
+    /// Range minimum.
+    float minValue_ = 0.0f;
+    /// Range maximum.
+    float maxValue_ = 0.0f;
+    /// Number of bits per component. At most 32.
+    unsigned numBits_ = 0;
+};
+
 class Serializable;
 
 /// Abstract base class for invoking attribute accessors.
@@ -113,6 +164,7 @@ struct AttributeInfo
         defaultValue_ = other.defaultValue_;
         mode_ = other.mode_;
         metadata_ = other.metadata_;
+        quantization_ = other.quantization_;
         ptr_ = other.ptr_;
         enumNamesStorage_ = other.enumNamesStorage_;
 
@@ -167,6 +219,8 @@ struct AttributeInfo
     AttributeModeFlags mode_ = AM_DEFAULT;
     /// Attribute metadata.
     VariantMap metadata_;
+    /// Network quantization.
+    AttributeQuantization quantization_;
     /// Attribute data pointer if elsewhere than in the Serializable.
     void* ptr_ = nullptr;
     /// List of enum names. Used when names can not be stored externally.
@@ -214,6 +268,16 @@ public:
             networkAttributeInfo_->metadata_[key] = value;
         return *this;
     }
+
+    /// Set network quantization.
+    AttributeHandle& SetQuantization(const AttributeQuantization& quantization)
+    {
+        if (attributeInfo_)
+            attributeInfo_->quantization_ = quantization;
+        if (networkAttributeInfo_)
+            networkAttributeInfo_->quantization_ = quantization;
+        return *this;
+    }
 };
 
 }
@@ -26,6 +26,7 @@
 #   include "Urho3D/WindowsSupport.h"
 #else
 #   include <condition_variable>
+#   include <mutex>
 #endif
 #include <Urho3D/Urho3D.h>
 
@@ -56,7 +57,11 @@ public:
 #if _WIN32
         SetEvent(event_);
 #else
-        event_.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            signaled_ = true;
+        }
+        event_.notify_one();
 #endif
     }
 
@@ -67,8 +72,8 @@ public:
         WaitForSingleObject(event_, INFINITE);
 #else
         std::unique_lock<std::mutex> lock(mutex_);
-        event_.wait(lock);
-        lock.unlock();
+        event_.wait(lock, [this] { return signaled_; });
+        signaled_ = false;
 #endif
     }
 
@@ -81,6 +86,8 @@ private:
     std::mutex mutex_;
     /// Event variable.
     std::condition_variable event_;
+    /// Signaled flag. Keeps the condition set until a thread waits on it, like the Windows event.
+    bool signaled_{};
 #endif
 };
 
@@ -304,6 +304,22 @@ void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* nam
         info->defaultValue_ = defaultValue;
 }
 
+void Context::UpdateAttributeQuantization(StringHash objectType, const char* name, const AttributeQuantization& quantization)
+{
+    if (AttributeInfo* info = GetAttribute(objectType, name))
+        info->quantization_ = quantization;
+
+    auto i = networkAttributes_.find(objectType);
+    if (i != networkAttributes_.end())
+    {
+        for (AttributeInfo& info : i->second)
+        {
+            if (!info.name_.comparei(name))
+                info.quantization_ = quantization;
+        }
+    }
+}
+
 VariantMap& Context::GetEventDataMap()
 {
     unsigned nestingLevel = eventSenders_.size();
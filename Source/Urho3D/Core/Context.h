@@ -26,6 +26,7 @@
 
 #include "../Container/Ptr.h"
 #include "../Core/Attribute.h"
+#include "../Core/EventQueue.h"
 #include "../Core/Object.h"
 
 namespace Urho3D
@@ -104,8 +105,12 @@ public:
     void RemoveAllAttributes(StringHash objectType);
     /// Update object attribute's default value.
     void UpdateAttributeDefaultValue(StringHash objectType, const char* name, const Variant& defaultValue);
+    /// Update network quantization of an object's attribute. Must match on the server and all clients.
+    void UpdateAttributeQuantization(StringHash objectType, const char* name, const AttributeQuantization& quantization);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap();
+    /// Return queue of events posted from any thread.
+    EventQueue& GetEventQueue() { return eventQueue_; }
     /// Initialises the specified SDL systems, if not already. Returns true if successful. This call must be matched with ReleaseSDL() when SDL functions are no longer required, even if this call fails.
     bool RequireSDL(unsigned int sdlFlags);
     /// Indicate that you are done with using SDL. Must be called after using RequireSDL().
@@ -141,6 +146,8 @@ public:
     template <class T, class U> void CopyBaseAttributes();
     /// Template version of updating an object attribute's default value.
     template <class T> void UpdateAttributeDefaultValue(const char* name, const Variant& defaultValue);
+    /// Template version of updating network quantization of an object's attribute.
+    template <class T> void UpdateAttributeQuantization(const char* name, const AttributeQuantization& quantization);
 
     /// Return subsystem by type.
     Object* GetSubsystem(StringHash type) const;
@@ -293,6 +300,8 @@ private:
     ea::unordered_map<ea::string, ea::vector<StringHash> > objectCategories_;
     /// Variant map for global variables that can persist throughout application execution.
     VariantMap globalVars_;
+    /// Events posted from any thread, sent on the main thread.
+    EventQueue eventQueue_;
 
     /// Cached pointer of engine susbsystem.
     WeakPtr<Engine> engine_;
@@ -387,4 +396,9 @@ template <class T> void Context::UpdateAttributeDefaultValue(const char* name, c
     UpdateAttributeDefaultValue(T::GetTypeStatic(), name, defaultValue);
 }
 
+template <class T> void Context::UpdateAttributeQuantization(const char* name, const AttributeQuantization& quantization)
+{
+    UpdateAttributeQuantization(T::GetTypeStatic(), name, quantization);
+}
+
 }
@@ -0,0 +1,174 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/EventQueue.h"
+#include "../Core/Object.h"
+#include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../IO/Log.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+EventQueue::EventQueue(unsigned capacity)
+{
+    capacity = NextPowerOfTwo(Max(capacity, 2u));
+    cells_ = ea::make_unique<Cell[]>(capacity);
+    mask_ = capacity - 1;
+    for (unsigned i = 0; i < capacity; ++i)
+        cells_[i].sequence_.store(i, std::memory_order_relaxed);
+}
+
+EventQueue::~EventQueue() = default;
+
+bool EventQueue::Post(Object* sender, StringHash eventType, const VariantMap& eventData)
+{
+    // Claim a free cell. The cell is free when its sequence equals to the position
+    unsigned position = enqueuePosition_.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    for (;;)
+    {
+        cell = &cells_[position & mask_];
+        const unsigned sequence = cell->sequence_.load(std::memory_order_acquire);
+        const int difference = static_cast<int>(sequence - position);
+        if (difference == 0)
+        {
+            if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // The main thread has not sent the event posted one lap ago, the queue is full
+            numDroppedEvents_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            position = enqueuePosition_.load(std::memory_order_relaxed);
+    }
+
+    sender->numPostedEvents_.fetch_add(1, std::memory_order_relaxed);
+    cell->sender_ = sender;
+    cell->eventType_ = eventType;
+    cell->eventData_ = eventData;
+    numEvents_.fetch_add(1, std::memory_order_relaxed);
+
+    // Publish the event to the main thread
+    cell->sequence_.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+unsigned EventQueue::Process(long long maxMicroseconds)
+{
+    assert(Thread::IsMainThread());
+
+    const unsigned numDroppedEvents = numDroppedEvents_.load(std::memory_order_relaxed);
+    if (numDroppedEvents != numReportedDroppedEvents_)
+    {
+        URHO3D_LOGWARNING("{} posted events were dropped because the event queue is full",
+            numDroppedEvents - numReportedDroppedEvents_);
+        numReportedDroppedEvents_ = numDroppedEvents;
+    }
+
+    if (!numEvents_.load(std::memory_order_relaxed))
+        return 0;
+
+    URHO3D_PROFILE("ProcessPostedEvents");
+
+    HiresTimer timer;
+    VariantMap eventData;
+    unsigned numProcessed = 0;
+    for (;;)
+    {
+        Cell& cell = cells_[dequeuePosition_ & mask_];
+        if (cell.sequence_.load(std::memory_order_acquire) != dequeuePosition_ + 1)
+            break;
+
+        // Take the event out and release the cell before sending, so that event handlers may post new events
+        Object* sender = cell.sender_;
+        const StringHash eventType = cell.eventType_;
+        eventData.swap(cell.eventData_);
+        cell.eventData_.clear();
+        cell.sequence_.store(dequeuePosition_ + mask_ + 1, std::memory_order_release);
+        ++dequeuePosition_;
+        numEvents_.fetch_sub(1, std::memory_order_relaxed);
+
+        ++numProcessed;
+
+        {
+            MutexLock lock(senderMutex_);
+            auto discarded = discardedSenders_.find(sender);
+            if (discarded != discardedSenders_.end())
+            {
+                // The sender has been destroyed
+                if (--discarded->second == 0)
+                    discardedSenders_.erase(discarded);
+                sender = nullptr;
+            }
+            else
+            {
+                // Mark the sender before the count, so that a destructor seeing the decremented count also sees the mark
+                sendingSender_.store(sender, std::memory_order_relaxed);
+                sender->numPostedEvents_.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        if (sender)
+        {
+            sender->SendEvent(eventType, eventData);
+            sendingSender_.store(nullptr, std::memory_order_release);
+        }
+
+        if (maxMicroseconds > 0 && timer.GetUSec(false) >= maxMicroseconds)
+            break;
+    }
+
+    return numProcessed;
+}
+
+void EventQueue::DiscardEvents(Object* sender)
+{
+    if (sender->numPostedEvents_.load(std::memory_order_acquire))
+    {
+        // Cells are not scanned, as events may be published out of order. Instead the remaining events of the sender are
+        // counted down as they are reached
+        MutexLock lock(senderMutex_);
+        const unsigned numPostedEvents = sender->numPostedEvents_.exchange(0, std::memory_order_relaxed);
+        if (numPostedEvents)
+            discardedSenders_[sender] += numPostedEvents;
+    }
+
+    // The main thread may have taken an event of the sender before it was discarded. On the main thread this can only
+    // mean the sender is destroyed by its own event, which is safe
+    if (!Thread::IsMainThread())
+    {
+        while (sendingSender_.load(std::memory_order_acquire) == sender)
+            Time::Sleep(0);
+    }
+}
+
+}
@@ -0,0 +1,102 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Core/Variant.h"
+
+#include <EASTL/unique_ptr.h>
+#include <EASTL/unordered_map.h>
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+class Object;
+
+/// Default capacity of the posted event queue.
+static const unsigned DEFAULT_EVENT_QUEUE_CAPACITY = 4096;
+
+/// Bounded lock-free queue of events posted from any thread and sent on the main thread.
+/// Multiple threads may post at once; only the main thread may process events. Events of a destroyed sender are discarded when reached.
+class URHO3D_API EventQueue
+{
+public:
+    /// Construct with capacity. Capacity is rounded up to power of two.
+    explicit EventQueue(unsigned capacity = DEFAULT_EVENT_QUEUE_CAPACITY);
+    /// Destruct.
+    ~EventQueue();
+
+    /// Post event. Is thread-safe. The sender must stay alive until the call returns. Event data must not contain pointers to reference counted objects, because their reference counts are not thread-safe. Return false if the queue is full and the event is dropped.
+    bool Post(Object* sender, StringHash eventType, const VariantMap& eventData);
+    /// Send posted events in posting order until the time budget in microseconds is exhausted. Zero budget sends all events. At least one event is sent if there are any. Return number of events sent. Must be called from the main thread.
+    unsigned Process(long long maxMicroseconds = 0);
+    /// Discard posted events of a sender. Called on every sender destruction. Is thread-safe. When called from another thread while the main thread is sending an event of the sender, waits until it has been sent.
+    void DiscardEvents(Object* sender);
+
+    /// Return capacity.
+    unsigned GetCapacity() const { return mask_ + 1; }
+    /// Return approximate number of posted events waiting to be sent. Is thread-safe.
+    unsigned GetNumEvents() const { return numEvents_.load(std::memory_order_relaxed); }
+    /// Return number of events dropped because the queue was full. Is thread-safe.
+    unsigned GetNumDroppedEvents() const { return numDroppedEvents_.load(std::memory_order_relaxed); }
+
+private:
+    /// Posted event.
+    struct Cell
+    {
+        /// Sequence number. Equals to the cell position when the cell is free and to the position + 1 when the event is posted.
+        std::atomic<unsigned> sequence_;
+        /// Sender. May be destroyed by the time the event is reached, see discardedSenders_.
+        Object* sender_{};
+        /// Event type.
+        StringHash eventType_;
+        /// Event data.
+        VariantMap eventData_;
+    };
+
+    /// Ring buffer of cells.
+    ea::unique_ptr<Cell[]> cells_;
+    /// Index mask of the ring buffer.
+    unsigned mask_{};
+    /// Position of the next posted event. Shared between producers.
+    alignas(64) std::atomic<unsigned> enqueuePosition_{};
+    /// Position of the next event to send. Owned by the main thread.
+    alignas(64) unsigned dequeuePosition_{};
+    /// Number of posted events not sent yet.
+    std::atomic<unsigned> numEvents_{};
+    /// Number of dropped events.
+    std::atomic<unsigned> numDroppedEvents_{};
+    /// Number of dropped events already reported to the log.
+    unsigned numReportedDroppedEvents_{};
+    /// Mutex for the sender bookkeeping between the main thread and destructing senders.
+    Mutex senderMutex_;
+    /// Destroyed senders and the number of their events still in the queue. As the queue is in posting order, these are the next events reached with that sender address, even if the address is reused by a new object.
+    ea::unordered_map<Object*, unsigned> discardedSenders_;
+    /// Sender whose event is being sent by the main thread.
+    std::atomic<Object*> sendingSender_{};
+};
+
+}
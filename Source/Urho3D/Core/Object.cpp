@@ -87,6 +87,8 @@ Object::~Object()
     {
         UnsubscribeFromAllEvents();
         context_->RemoveEventSender(this);
+
+        context_->GetEventQueue().DiscardEvents(this);
     }
 }
 
@@ -316,7 +318,7 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
 {
     if (!Thread::IsMainThread())
     {
-        URHO3D_LOGERROR("Sending events is only supported from the main thread");
+        URHO3D_LOGERROR("Sending events is only supported from the main thread, use PostEvent instead");
         return;
     }
 
@@ -374,8 +376,9 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
         for (unsigned i = 0; i < numReceivers; ++i)
         {
             Object* receiver = groupNonSpec->receivers_[i];
-            // If there were specific receivers, check that the event is not sent doubly to them
-            if (!receiver || (group && group->receivers_.contains(receiver)))
+            // If there were specific receivers, check that the event is not sent doubly to them.
+            // Look up the receiver's own handlers, which are few, instead of searching the whole specific group
+            if (!receiver || (group && receiver->FindSpecificEventHandler(this, eventType) != receiver->eventHandlers_.end()))
                 continue;
 
             receiver->OnEvent(this, eventType, eventData);
@@ -394,6 +397,16 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     context->EndSendEvent();
 }
 
+bool Object::PostEvent(StringHash eventType)
+{
+    return PostEvent(eventType, Variant::emptyVariantMap);
+}
+
+bool Object::PostEvent(StringHash eventType, const VariantMap& eventData)
+{
+    return context_->GetEventQueue().Post(this, eventType, eventData);
+}
+
 VariantMap& Object::GetEventDataMap() const
 {
     return context_->GetEventDataMap();
@@ -442,6 +455,20 @@ bool Object::HasSubscribedToEvent(Object* sender, StringHash eventType) const
         return FindSpecificEventHandler(sender, eventType) != eventHandlers_.end();
 }
 
+bool Object::HasEventReceivers(StringHash eventType) const
+{
+    if (blockEvents_)
+        return false;
+
+    Context* context = context_;
+    EventReceiverGroup* group = context->GetEventReceivers(const_cast<Object*>(this), eventType);
+    if (group && !group->receivers_.empty())
+        return true;
+
+    group = context->GetEventReceivers(eventType);
+    return group && !group->receivers_.empty();
+}
+
 const ea::string& Object::GetCategory() const
 {
     const ea::unordered_map<ea::string, ea::vector<StringHash> >& objectCategories = context_->GetObjectCategories();
@@ -29,6 +29,7 @@
 #include "../Core/Profiler.h"
 #include "../Core/StringHashRegister.h"
 #include "../Core/Variant.h"
+#include <atomic>
 #include <functional>
 #include <utility>
 
@@ -114,6 +115,7 @@ private:
 class URHO3D_API Object : public RefCounted
 {
     friend class Context;
+    friend class EventQueue;
 
 public:
     /// Construct.
@@ -178,6 +180,10 @@ public:
     void SendEvent(StringHash eventType);
     /// Send event with parameters to all subscribers.
     void SendEvent(StringHash eventType, VariantMap& eventData);
+    /// Post event to be sent to all subscribers on the main thread at the beginning of the next frame. Is thread-safe. Return false if the posted event queue is full.
+    bool PostEvent(StringHash eventType);
+    /// Post event with parameters to be sent to all subscribers on the main thread at the beginning of the next frame. Is thread-safe, but event data must not contain pointers to reference counted objects. Return false if the posted event queue is full.
+    bool PostEvent(StringHash eventType, const VariantMap& eventData);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap() const;
     /// Send event with variadic parameter pairs to all subscribers. The parameter pairs is a list of paramID and paramValue separated by comma, one pair after another.
@@ -207,6 +213,8 @@ public:
     bool HasSubscribedToEvent(StringHash eventType) const;
     /// Return whether has subscribed to a specific sender's event.
     bool HasSubscribedToEvent(Object* sender, StringHash eventType) const;
+    /// Return whether an event sent by this object would reach any receiver. Can be used to skip preparing expensive event data.
+    bool HasEventReceivers(StringHash eventType) const;
 
     /// Return whether has subscribed to any event.
     bool HasEventHandlers() const { return !eventHandlers_.empty(); }
@@ -251,6 +259,8 @@ private:
 
     /// Block object from sending and receiving any events.
     bool blockEvents_;
+    /// Number of posted events from this object waiting in the event queue.
+    std::atomic<unsigned> numPostedEvents_{};
 };
 
 template <class T> T* Object::GetSubsystem() const { return static_cast<T*>(GetSubsystem(T::GetTypeStatic())); }
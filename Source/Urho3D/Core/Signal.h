@@ -33,8 +33,96 @@
 namespace Urho3D
 {
 
+/// Handler storage shared by signal specializations. Receivers may subscribe and unsubscribe while the signal is being invoked: new handlers are invoked starting from the next invocation, removed handlers are skipped immediately.
+template<typename Handler>
+class SignalHandlerList
+{
+public:
+    /// Unsubscribe all handlers of specified receiver from this events.
+    void Unsubscribe(RefCounted* receiver)
+    {
+        for (ea::pair<WeakPtr<RefCounted>, Handler>& pair : handlers_)
+        {
+            if (pair.first.Expired() || pair.first == receiver)
+                RemoveHandler(pair);
+        }
+        for (auto it = pendingHandlers_.begin(); it != pendingHandlers_.end();)
+        {
+            if (it->first.Expired() || it->first == receiver)
+                it = pendingHandlers_.erase(it);
+            else
+                ++it;
+        }
+        if (!invocationDepth_)
+            Cleanup();
+    }
+
+    /// Returns true when event has at least one subscriber.
+    bool HasSubscribers() const { return !handlers_.empty() || !pendingHandlers_.empty(); }
+
+protected:
+    /// Add handler. Handlers added during invocation are deferred so that the handler storage is never reallocated while in use.
+    void AddHandler(RefCounted* receiver, Handler handler)
+    {
+        if (invocationDepth_)
+            pendingHandlers_.emplace_back(WeakPtr<RefCounted>(receiver), ea::move(handler));
+        else
+            handlers_.emplace_back(WeakPtr<RefCounted>(receiver), ea::move(handler));
+    }
+
+    /// Begin invocation and return number of handlers to invoke.
+    unsigned BeginInvoke()
+    {
+        ++invocationDepth_;
+        return handlers_.size();
+    }
+
+    /// End invocation. Remove stale handlers and add deferred ones if the outermost invocation has finished.
+    void EndInvoke()
+    {
+        if (--invocationDepth_)
+            return;
+
+        Cleanup();
+    }
+
+    /// Mark handler as removed. The handler function is kept intact as it may be executing, storage is compacted when not invoking.
+    void RemoveHandler(ea::pair<WeakPtr<RefCounted>, Handler>& pair)
+    {
+        pair.first.Reset();
+        dirty_ = true;
+    }
+
+    /// Compact handler storage and add deferred handlers.
+    void Cleanup()
+    {
+        if (dirty_)
+        {
+            handlers_.erase(ea::remove_if(handlers_.begin(), handlers_.end(),
+                [](const ea::pair<WeakPtr<RefCounted>, Handler>& pair) { return pair.first.Expired(); }), handlers_.end());
+            dirty_ = false;
+        }
+
+        if (!pendingHandlers_.empty())
+        {
+            for (ea::pair<WeakPtr<RefCounted>, Handler>& pair : pendingHandlers_)
+                handlers_.push_back(ea::move(pair));
+            pendingHandlers_.clear();
+        }
+    }
+
+    /// A collection of event handlers. Handlers with expired receivers await cleanup.
+    ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
+    /// Handlers added during invocation.
+    ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> pendingHandlers_;
+    /// Invocation recursion depth.
+    unsigned invocationDepth_{};
+    /// Whether removed handlers await cleanup.
+    bool dirty_{};
+};
+
 template<typename T, typename Sender=RefCounted>
-class Signal
+class Signal : public SignalHandlerList<Function<bool(RefCounted*, Sender*, T&)>>
 {
 public:
     /// Signal handler type.
@@ -44,7 +132,7 @@ public:
     template<typename Receiver>
     void Subscribe(Receiver* receiver, void(Receiver::*handler)(Sender*, T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 (static_cast<Receiver*>(receiver)->*handler)(sender, args);
@@ -53,11 +141,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Handler is unsubscribed when it returns false.
     template<typename Receiver>
     void Subscribe(Receiver* receiver, bool(Receiver::*handler)(RefCounted*, T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)(sender, args);
@@ -69,7 +157,7 @@ public:
     template<typename Receiver>
     void Subscribe(Receiver* receiver, void(Receiver::*handler)(T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 (static_cast<Receiver*>(receiver)->*handler)(args);
@@ -78,11 +166,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Handler is unsubscribed when it returns false.
     template<typename Receiver>
     void Subscribe(Receiver* receiver, bool(Receiver::*handler)(T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)(args);
@@ -90,47 +178,25 @@ public:
         );
     }
 
-    /// Unsubscribe all handlers of specified receiver from this events.
-    void Unsubscribe(RefCounted* receiver)
-    {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
-        {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (pair.first.Expired() || pair.first == receiver)
-                it = handlers_.erase(it);
-            else
-                ++it;
-        }
-    }
-
     /// Invoke event.
     void operator()(Sender* sender, T& args)
     {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
+        const unsigned numHandlers = this->BeginInvoke();
+        for (unsigned i = 0; i < numHandlers; ++i)
         {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (RefCounted* receiver = pair.first.Get())
-            {
-                if (pair.second(receiver, sender, args))
-                    ++it;
-                else
-                    it = handlers_.erase(it);
-            }
-            else
-                it = handlers_.erase(it);
+            ea::pair<WeakPtr<RefCounted>, Handler>& pair = this->handlers_[i];
+            RefCounted* receiver = pair.first.Get();
+            if (!receiver)
+                this->dirty_ = true;
+            else if (!pair.second(receiver, sender, args))
+                this->RemoveHandler(pair);
         }
+        this->EndInvoke();
     }
-
-    /// Returns true when event has at least one subscriber.
-    bool HasSubscribers() const { return !handlers_.empty(); }
-
-protected:
-    /// A collection of event handlers.
-    ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
 };
 
 template<typename Sender>
-class Signal<void, Sender>
+class Signal<void, Sender> : public SignalHandlerList<Function<bool(RefCounted*, Sender*)>>
 {
 public:
     /// Signal handler type.
@@ -140,7 +206,7 @@ public:
     template<typename Receiver>
     void Subscribe(Receiver* receiver, void(Receiver::*handler)(Sender*))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 (static_cast<Receiver*>(receiver)->*handler)(sender);
@@ -149,11 +215,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Handler is unsubscribed when it returns false.
     template<typename Receiver>
     void Subscribe(Receiver* receiver, bool(Receiver::*handler)(RefCounted*))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)(sender);
@@ -165,7 +231,7 @@ public:
     template<typename Receiver>
     void Subscribe(Receiver* receiver, void(Receiver::*handler)())
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 (static_cast<Receiver*>(receiver)->*handler)();
@@ -174,11 +240,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Handler is unsubscribed when it returns false.
     template<typename Receiver>
     void Subscribe(Receiver* receiver, bool(Receiver::*handler)())
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)();
@@ -186,43 +252,21 @@ public:
         );
     }
 
-    /// Unsubscribe all handlers of specified receiver from this events.
-    void Unsubscribe(RefCounted* receiver)
-    {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
-        {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (pair.first.Expired() || pair.first == receiver)
-                it = handlers_.erase(it);
-            else
-                ++it;
-        }
-    }
-
     /// Invoke event.
     void operator()(Sender* sender)
     {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
+        const unsigned numHandlers = this->BeginInvoke();
+        for (unsigned i = 0; i < numHandlers; ++i)
         {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (RefCounted* receiver = pair.first.Get())
-            {
-                if (pair.second(receiver, sender))
-                    ++it;
-                else
-                    it = handlers_.erase(it);
-            }
-            else
-                it = handlers_.erase(it);
+            ea::pair<WeakPtr<RefCounted>, Handler>& pair = this->handlers_[i];
+            RefCounted* receiver = pair.first.Get();
+            if (!receiver)
+                this->dirty_ = true;
+            else if (!pair.second(receiver, sender))
+                this->RemoveHandler(pair);
         }
+        this->EndInvoke();
     }
-
-    /// Returns true when event has at least one subscriber.
-    bool HasSubscribers() const { return !handlers_.empty(); }
-
-protected:
-    /// A collection of event handlers.
-    ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
 };
 
 }
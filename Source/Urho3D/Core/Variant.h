@@ -30,6 +30,7 @@
 
 #include "../Container/Ptr.h"
 #include "../Container/ByteVector.h"
+#include "../Container/FreeListAllocator.h"
 #include "../Core/TypeTrait.h"
 #include "../Math/Color.h"
 #include "../Math/Matrix3.h"
@@ -88,8 +89,8 @@ using VariantVector = ea::vector<Variant>;
 /// Vector of strings.
 using StringVector = ea::vector<ea::string>;
 
-/// Map of variants.
-using VariantMap = ea::unordered_map<StringHash, Variant>;
+/// Map of variants. Nodes are recycled through a per-thread free list, because event data maps are cleared and refilled on every event.
+using VariantMap = ea::unordered_map<StringHash, Variant, ea::hash<StringHash>, ea::equal_to<StringHash>, FreeListAllocator>;
 
 /// Deprecated. Use ByteVector instead.
 /// TODO: Rename all instances of VariantBuffer to ByteVector.
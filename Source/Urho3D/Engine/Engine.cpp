@@ -52,6 +52,8 @@
 #include "../Navigation/NavigationMesh.h"
 #endif
 #ifdef URHO3D_NETWORK
+#include "../Network/HttpClient.h"
+#include "../Network/MetricsServer.h"
 #include "../Network/Network.h"
 #endif
 #ifdef URHO3D_PHYSICS
@@ -123,7 +125,8 @@ Engine::Engine(Context* context) :
     initialized_(false),
     exiting_(false),
     headless_(false),
-    audioPaused_(false)
+    audioPaused_(false),
+    postedEventTimeBudget_(2000)
 {
     // Register self as a subsystem
     context_->RegisterSubsystem(this);
@@ -139,6 +142,8 @@ Engine::Engine(Context* context) :
     context_->RegisterSubsystem(new Localization(context_));
 #ifdef URHO3D_NETWORK
     context_->RegisterSubsystem(new Network(context_));
+    context_->RegisterSubsystem(new HttpClient(context_));
+    context_->RegisterSubsystem(new MetricsServer(context_));
 #endif
     // Register UI library object factories before creation of subsystem. This is not done inside subsystem because
     // there may exist multiple instances of UI.
@@ -317,6 +322,8 @@ bool Engine::Initialize(const VariantMap& parameters)
 #ifdef URHO3D_NETWORK
     if (HasParameter(parameters, EP_PACKAGE_CACHE_DIR))
         GetSubsystem<Network>()->SetPackageCacheDir(GetParameter(parameters, EP_PACKAGE_CACHE_DIR).GetString());
+    if (GetParameter(parameters, EP_METRICS_PORT, 0).GetInt() > 0)
+        GetSubsystem<MetricsServer>()->Start((unsigned short)GetParameter(parameters, EP_METRICS_PORT).GetInt());
 #endif
 
 #ifdef URHO3D_TESTING
@@ -519,6 +526,9 @@ void Engine::RunFrame()
         URHO3D_PROFILE("DoFrame");
         time->BeginFrame(timeStep_);
 
+        // Send events posted from worker threads since the previous frame
+        context_->GetEventQueue().Process(postedEventTimeBudget_);
+
         // If pause when minimized -mode is in use, stop updates and audio as necessary
         if (pauseMinimized_ && input->IsMinimized())
         {
@@ -941,6 +951,7 @@ void Engine::DefineParameters(CLI::App& commandLine, VariantMap& engineParameter
     addOptionInt("-y,--height", EP_WINDOW_HEIGHT, "Window height");
     addOptionInt("--monitor", EP_MONITOR, "Create window on the specified monitor");
     addOptionInt("--hz", EP_REFRESH_RATE, "Use custom refresh rate");
+    addOptionInt("--metrics-port", EP_METRICS_PORT, "Serve engine metrics over HTTP on the specified port");
     addOptionInt("-m,--multisample", EP_MULTI_SAMPLE, "Multisampling samples");
     addOptionInt("-b,--sound-buffer", EP_SOUND_BUFFER, "Sound buffer size");
     addOptionInt("-r,--mix-rate", EP_SOUND_MIX_RATE, "Sound mixing rate");
@@ -77,6 +77,9 @@ public:
     /// Set whether to exit automatically on exit request (window close button).
     /// @property
     void SetAutoExit(bool enable);
+    /// Set maximum time in microseconds to spend each frame on sending events posted from worker threads. Events left over are sent on the next frame. Zero sends all events.
+    /// @property
+    void SetPostedEventTimeBudget(unsigned microseconds) { postedEventTimeBudget_ = microseconds; }
     /// Override timestep of the next frame. Should be called in between RunFrame() calls.
     void SetNextTimeStep(float seconds);
     /// Close the graphics window and set the exit flag. No-op on iOS/tvOS, as an iOS/tvOS application can not legally exit.
@@ -110,6 +113,10 @@ public:
     /// @property
     int GetTimeStepSmoothing() const { return timeStepSmoothing_; }
 
+    /// Return maximum time in microseconds to spend each frame on sending posted events.
+    /// @property
+    unsigned GetPostedEventTimeBudget() const { return postedEventTimeBudget_; }
+
     /// Return whether to pause update events and audio when minimized.
     /// @property
     bool GetPauseMinimized() const { return pauseMinimized_; }
@@ -185,6 +192,8 @@ private:
     bool headless_;
     /// Audio paused flag.
     bool audioPaused_;
+    /// Maximum time in microseconds to spend each frame on sending posted events.
+    unsigned postedEventTimeBudget_;
 };
 
 }
@@ -151,6 +151,15 @@ bool AnimatedModel::Load(Deserializer& source)
     return success;
 }
 
+bool AnimatedModel::LoadAttributeValues(const ea::vector<Variant>& values)
+{
+    loading_ = true;
+    bool success = Component::LoadAttributeValues(values);
+    loading_ = false;
+
+    return success;
+}
+
 bool AnimatedModel::LoadXML(const XMLElement& source)
 {
     loading_ = true;
@@ -75,14 +75,7 @@ void AnimationController::RegisterObject(Context* context)
 
 void AnimationController::OnSetEnabled()
 {
-    Scene* scene = GetScene();
-    if (scene)
-    {
-        if (IsEnabledEffective())
-            SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(AnimationController, HandleScenePostUpdate));
-        else
-            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-    }
+    UpdateEventSubscription(GetScene());
 }
 
 void AnimationController::Update(float timeStep)
@@ -838,10 +831,7 @@ VariantVector AnimationController::GetNodeAnimationStatesAttr() const
 
 void AnimationController::OnSceneSet(Scene* scene)
 {
-    if (scene && IsEnabledEffective())
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(AnimationController, HandleScenePostUpdate));
-    else if (!scene)
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+    UpdateEventSubscription(scene);
 }
 
 AnimationState* AnimationController::AddAnimationState(Animation* animation)
@@ -908,11 +898,22 @@ void AnimationController::FindAnimation(const ea::string& name, unsigned& index,
     }
 }
 
-void AnimationController::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void AnimationController::UpdateEventSubscription(Scene* scene)
 {
-    using namespace ScenePostUpdate;
+    Scene* newScene = scene && IsEnabledEffective() ? scene : nullptr;
+    if (newScene == subscribedScene_)
+        return;
 
-    Update(eventData[P_TIMESTEP].GetFloat());
+    if (subscribedScene_)
+        subscribedScene_->scenePostUpdateEvent_.Unsubscribe(this);
+    if (newScene)
+        newScene->scenePostUpdateEvent_.Subscribe(this, &AnimationController::HandleScenePostUpdate);
+    subscribedScene_ = newScene;
+}
+
+void AnimationController::HandleScenePostUpdate(SceneUpdateArgs& args)
+{
+    Update(args.timeStep_);
 }
 
 }
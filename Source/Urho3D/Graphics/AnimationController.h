@@ -32,6 +32,7 @@ namespace Urho3D
 class AnimatedModel;
 class Animation;
 struct Bone;
+struct SceneUpdateArgs;
 
 /// Control data for an animation.
 /// @fakeref
@@ -212,9 +213,13 @@ private:
     void RemoveAnimationState(AnimationState* state);
     /// Find the internal index and animation state of an animation.
     void FindAnimation(const ea::string& name, unsigned& index, AnimationState*& state) const;
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Subscribe to or unsubscribe from scene post-update depending on the scene and enabled state.
+    void UpdateEventSubscription(Scene* scene);
+    /// Handle scene post-update.
+    void HandleScenePostUpdate(SceneUpdateArgs& args);
 
+    /// Scene whose post-update is subscribed to.
+    WeakPtr<Scene> subscribedScene_;
     /// Animation control structures.
     ea::vector<AnimationControl> animations_;
     /// Node hierarchy mode animation states.
@@ -22,10 +22,10 @@
 
 #include "../Precompiled.h"
 
-#include <EASTL/sort.h>
-
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/BillboardSet.h"
 #include "../Graphics/Camera.h"
@@ -46,6 +46,9 @@ namespace Urho3D
 extern const char* GEOMETRY_CATEGORY;
 
 static const float INV_SQRT_TWO = 1.0f / sqrtf(2.0f);
+static const unsigned MIN_BILLBOARDS_PER_TASK = 2048;
+static const unsigned BILLBOARD_VERTEX_SIZE = 8;
+static const unsigned DIRECTIONAL_BILLBOARD_VERTEX_SIZE = 11;
 
 const char* faceCameraModeNames[] =
 {
@@ -71,9 +74,166 @@ static const StringVector billboardsStructureElementNames =
     "   Is Enabled"
 };
 
-inline bool CompareBillboards(Billboard* lhs, Billboard* rhs)
+/// Return approximate sort key of billboard. Billboards are sorted back to front using 16 upper bits of distance.
+inline unsigned GetBillboardSortKey(const Billboard* billboard)
+{
+    // Bit representation of non-negative floats has the same order as floats themselves
+    unsigned distanceBits;
+    memcpy(&distanceBits, &billboard->sortDistance_, sizeof(unsigned));
+    return ~(distanceBits >> 16u) & 0xffffu;
+}
+
+/// Sort billboards back to front using two passes of radix sort over approximate 16-bit keys.
+static void SortBillboards(ea::vector<Billboard*>& billboards, ea::vector<Billboard*>& buffer)
+{
+    buffer.resize(billboards.size());
+    for (unsigned shift = 0; shift < 16; shift += 8)
+    {
+        unsigned offsets[256]{};
+        for (const Billboard* billboard : billboards)
+            ++offsets[(GetBillboardSortKey(billboard) >> shift) & 0xffu];
+
+        unsigned offset = 0;
+        for (unsigned& bucketOffset : offsets)
+        {
+            const unsigned bucketSize = bucketOffset;
+            bucketOffset = offset;
+            offset += bucketSize;
+        }
+
+        for (Billboard* billboard : billboards)
+            buffer[offsets[(GetBillboardSortKey(billboard) >> shift) & 0xffu]++] = billboard;
+
+        billboards.swap(buffer);
+    }
+}
+
+/// Write vertices of camera facing billboards.
+static void WriteBillboardVertices(float* dest, Billboard* const* billboards, unsigned count,
+    const Vector3& billboardScale, bool fixedScreenSize)
 {
-    return lhs->sortDistance_ > rhs->sortDistance_;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Billboard& billboard = *billboards[i];
+
+        Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
+        unsigned color = billboard.color_.ToUInt();
+        if (fixedScreenSize)
+            size *= billboard.screenScaleFactor_;
+
+        float rotationMatrix[2][2];
+        SinCos(billboard.rotation_, rotationMatrix[0][1], rotationMatrix[0][0]);
+        rotationMatrix[1][0] = -rotationMatrix[0][1];
+        rotationMatrix[1][1] = rotationMatrix[0][0];
+
+        dest[0] = billboard.position_.x_;
+        dest[1] = billboard.position_.y_;
+        dest[2] = billboard.position_.z_;
+        ((unsigned&)dest[3]) = color;
+        dest[4] = billboard.uv_.min_.x_;
+        dest[5] = billboard.uv_.min_.y_;
+        dest[6] = -size.x_ * rotationMatrix[0][0] + size.y_ * rotationMatrix[0][1];
+        dest[7] = -size.x_ * rotationMatrix[1][0] + size.y_ * rotationMatrix[1][1];
+
+        dest[8] = billboard.position_.x_;
+        dest[9] = billboard.position_.y_;
+        dest[10] = billboard.position_.z_;
+        ((unsigned&)dest[11]) = color;
+        dest[12] = billboard.uv_.max_.x_;
+        dest[13] = billboard.uv_.min_.y_;
+        dest[14] = size.x_ * rotationMatrix[0][0] + size.y_ * rotationMatrix[0][1];
+        dest[15] = size.x_ * rotationMatrix[1][0] + size.y_ * rotationMatrix[1][1];
+
+        dest[16] = billboard.position_.x_;
+        dest[17] = billboard.position_.y_;
+        dest[18] = billboard.position_.z_;
+        ((unsigned&)dest[19]) = color;
+        dest[20] = billboard.uv_.max_.x_;
+        dest[21] = billboard.uv_.max_.y_;
+        dest[22] = size.x_ * rotationMatrix[0][0] - size.y_ * rotationMatrix[0][1];
+        dest[23] = size.x_ * rotationMatrix[1][0] - size.y_ * rotationMatrix[1][1];
+
+        dest[24] = billboard.position_.x_;
+        dest[25] = billboard.position_.y_;
+        dest[26] = billboard.position_.z_;
+        ((unsigned&)dest[27]) = color;
+        dest[28] = billboard.uv_.min_.x_;
+        dest[29] = billboard.uv_.max_.y_;
+        dest[30] = -size.x_ * rotationMatrix[0][0] - size.y_ * rotationMatrix[0][1];
+        dest[31] = -size.x_ * rotationMatrix[1][0] - size.y_ * rotationMatrix[1][1];
+
+        dest += 4 * BILLBOARD_VERTEX_SIZE;
+    }
+}
+
+/// Write vertices of direction based billboards.
+static void WriteDirectionalBillboardVertices(float* dest, Billboard* const* billboards, unsigned count,
+    const Vector3& billboardScale, bool fixedScreenSize)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Billboard& billboard = *billboards[i];
+
+        Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
+        unsigned color = billboard.color_.ToUInt();
+        if (fixedScreenSize)
+            size *= billboard.screenScaleFactor_;
+
+        float rot2D[2][2];
+        SinCos(billboard.rotation_, rot2D[0][1], rot2D[0][0]);
+        rot2D[1][0] = -rot2D[0][1];
+        rot2D[1][1] = rot2D[0][0];
+
+        dest[0] = billboard.position_.x_;
+        dest[1] = billboard.position_.y_;
+        dest[2] = billboard.position_.z_;
+        dest[3] = billboard.direction_.x_;
+        dest[4] = billboard.direction_.y_;
+        dest[5] = billboard.direction_.z_;
+        ((unsigned&)dest[6]) = color;
+        dest[7] = billboard.uv_.min_.x_;
+        dest[8] = billboard.uv_.min_.y_;
+        dest[9] = -size.x_ * rot2D[0][0] + size.y_ * rot2D[0][1];
+        dest[10] = -size.x_ * rot2D[1][0] + size.y_ * rot2D[1][1];
+
+        dest[11] = billboard.position_.x_;
+        dest[12] = billboard.position_.y_;
+        dest[13] = billboard.position_.z_;
+        dest[14] = billboard.direction_.x_;
+        dest[15] = billboard.direction_.y_;
+        dest[16] = billboard.direction_.z_;
+        ((unsigned&)dest[17]) = color;
+        dest[18] = billboard.uv_.max_.x_;
+        dest[19] = billboard.uv_.min_.y_;
+        dest[20] = size.x_ * rot2D[0][0] + size.y_ * rot2D[0][1];
+        dest[21] = size.x_ * rot2D[1][0] + size.y_ * rot2D[1][1];
+
+        dest[22] = billboard.position_.x_;
+        dest[23] = billboard.position_.y_;
+        dest[24] = billboard.position_.z_;
+        dest[25] = billboard.direction_.x_;
+        dest[26] = billboard.direction_.y_;
+        dest[27] = billboard.direction_.z_;
+        ((unsigned&)dest[28]) = color;
+        dest[29] = billboard.uv_.max_.x_;
+        dest[30] = billboard.uv_.max_.y_;
+        dest[31] = size.x_ * rot2D[0][0] - size.y_ * rot2D[0][1];
+        dest[32] = size.x_ * rot2D[1][0] - size.y_ * rot2D[1][1];
+
+        dest[33] = billboard.position_.x_;
+        dest[34] = billboard.position_.y_;
+        dest[35] = billboard.position_.z_;
+        dest[36] = billboard.direction_.x_;
+        dest[37] = billboard.direction_.y_;
+        dest[38] = billboard.direction_.z_;
+        ((unsigned&)dest[39]) = color;
+        dest[40] = billboard.uv_.min_.x_;
+        dest[41] = billboard.uv_.max_.y_;
+        dest[42] = -size.x_ * rot2D[0][0] - size.y_ * rot2D[0][1];
+        dest[43] = -size.x_ * rot2D[1][0] - size.y_ * rot2D[1][1];
+
+        dest += 4 * DIRECTIONAL_BILLBOARD_VERTEX_SIZE;
+    }
 }
 
 BillboardSet::BillboardSet(Context* context) :
@@ -629,7 +789,7 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
 
     if (sorted_)
     {
-        ea::quick_sort(sortedBillboards_.begin(), sortedBillboards_.end(), CompareBillboards);
+        SortBillboards(sortedBillboards_, sortBuffer_);
         Vector3 worldPos = node_->GetWorldPosition();
         // Store the "last sorted position" now
         previousOffset_ = (worldPos - frame.camera_->GetNode()->GetWorldPosition());
@@ -639,127 +799,30 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
     if (!dest)
         return;
 
-    if (faceCameraMode_ != FC_DIRECTION)
-    {
-        for (unsigned i = 0; i < enabledBillboards; ++i)
-        {
-            Billboard& billboard = *sortedBillboards_[i];
-
-            Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
-            unsigned color = billboard.color_.ToUInt();
-            if (fixedScreenSize_)
-                size *= billboard.screenScaleFactor_;
-
-            float rotationMatrix[2][2];
-            SinCos(billboard.rotation_, rotationMatrix[0][1], rotationMatrix[0][0]);
-            rotationMatrix[1][0] = -rotationMatrix[0][1];
-            rotationMatrix[1][1] = rotationMatrix[0][0];
-
-            dest[0] = billboard.position_.x_;
-            dest[1] = billboard.position_.y_;
-            dest[2] = billboard.position_.z_;
-            ((unsigned&)dest[3]) = color;
-            dest[4] = billboard.uv_.min_.x_;
-            dest[5] = billboard.uv_.min_.y_;
-            dest[6] = -size.x_ * rotationMatrix[0][0] + size.y_ * rotationMatrix[0][1];
-            dest[7] = -size.x_ * rotationMatrix[1][0] + size.y_ * rotationMatrix[1][1];
-
-            dest[8] = billboard.position_.x_;
-            dest[9] = billboard.position_.y_;
-            dest[10] = billboard.position_.z_;
-            ((unsigned&)dest[11]) = color;
-            dest[12] = billboard.uv_.max_.x_;
-            dest[13] = billboard.uv_.min_.y_;
-            dest[14] = size.x_ * rotationMatrix[0][0] + size.y_ * rotationMatrix[0][1];
-            dest[15] = size.x_ * rotationMatrix[1][0] + size.y_ * rotationMatrix[1][1];
-
-            dest[16] = billboard.position_.x_;
-            dest[17] = billboard.position_.y_;
-            dest[18] = billboard.position_.z_;
-            ((unsigned&)dest[19]) = color;
-            dest[20] = billboard.uv_.max_.x_;
-            dest[21] = billboard.uv_.max_.y_;
-            dest[22] = size.x_ * rotationMatrix[0][0] - size.y_ * rotationMatrix[0][1];
-            dest[23] = size.x_ * rotationMatrix[1][0] - size.y_ * rotationMatrix[1][1];
-
-            dest[24] = billboard.position_.x_;
-            dest[25] = billboard.position_.y_;
-            dest[26] = billboard.position_.z_;
-            ((unsigned&)dest[27]) = color;
-            dest[28] = billboard.uv_.min_.x_;
-            dest[29] = billboard.uv_.max_.y_;
-            dest[30] = -size.x_ * rotationMatrix[0][0] - size.y_ * rotationMatrix[0][1];
-            dest[31] = -size.x_ * rotationMatrix[1][0] - size.y_ * rotationMatrix[1][1];
-
-            dest += 32;
-        }
-    }
+    const bool directional = faceCameraMode_ == FC_DIRECTION;
+    const auto writeVertices = directional ? WriteDirectionalBillboardVertices : WriteBillboardVertices;
+    const unsigned billboardSize = 4 * (directional ? DIRECTIONAL_BILLBOARD_VERTEX_SIZE : BILLBOARD_VERTEX_SIZE);
+
+    // Split big sets into chunks processed by worker threads. Work queue may be used only from main thread.
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numTasks = queue && Thread::IsMainThread() && !queue->IsCompleting()
+        ? Min(queue->GetNumThreads() + 1, enabledBillboards / MIN_BILLBOARDS_PER_TASK) : 1;
+
+    if (numTasks <= 1)
+        writeVertices(dest, sortedBillboards_.data(), enabledBillboards, billboardScale, fixedScreenSize_);
     else
     {
-        for (unsigned i = 0; i < enabledBillboards; ++i)
+        const unsigned billboardsPerTask = (enabledBillboards + numTasks - 1) / numTasks;
+        for (unsigned begin = 0; begin < enabledBillboards; begin += billboardsPerTask)
         {
-            Billboard& billboard = *sortedBillboards_[i];
-
-            Vector2 size(billboard.size_.x_ * billboardScale.x_, billboard.size_.y_ * billboardScale.y_);
-            unsigned color = billboard.color_.ToUInt();
-            if (fixedScreenSize_)
-                size *= billboard.screenScaleFactor_;
-
-            float rot2D[2][2];
-            SinCos(billboard.rotation_, rot2D[0][1], rot2D[0][0]);
-            rot2D[1][0] = -rot2D[0][1];
-            rot2D[1][1] = rot2D[0][0];
-
-            dest[0] = billboard.position_.x_;
-            dest[1] = billboard.position_.y_;
-            dest[2] = billboard.position_.z_;
-            dest[3] = billboard.direction_.x_;
-            dest[4] = billboard.direction_.y_;
-            dest[5] = billboard.direction_.z_;
-            ((unsigned&)dest[6]) = color;
-            dest[7] = billboard.uv_.min_.x_;
-            dest[8] = billboard.uv_.min_.y_;
-            dest[9] = -size.x_ * rot2D[0][0] + size.y_ * rot2D[0][1];
-            dest[10] = -size.x_ * rot2D[1][0] + size.y_ * rot2D[1][1];
-
-            dest[11] = billboard.position_.x_;
-            dest[12] = billboard.position_.y_;
-            dest[13] = billboard.position_.z_;
-            dest[14] = billboard.direction_.x_;
-            dest[15] = billboard.direction_.y_;
-            dest[16] = billboard.direction_.z_;
-            ((unsigned&)dest[17]) = color;
-            dest[18] = billboard.uv_.max_.x_;
-            dest[19] = billboard.uv_.min_.y_;
-            dest[20] = size.x_ * rot2D[0][0] + size.y_ * rot2D[0][1];
-            dest[21] = size.x_ * rot2D[1][0] + size.y_ * rot2D[1][1];
-
-            dest[22] = billboard.position_.x_;
-            dest[23] = billboard.position_.y_;
-            dest[24] = billboard.position_.z_;
-            dest[25] = billboard.direction_.x_;
-            dest[26] = billboard.direction_.y_;
-            dest[27] = billboard.direction_.z_;
-            ((unsigned&)dest[28]) = color;
-            dest[29] = billboard.uv_.max_.x_;
-            dest[30] = billboard.uv_.max_.y_;
-            dest[31] = size.x_ * rot2D[0][0] - size.y_ * rot2D[0][1];
-            dest[32] = size.x_ * rot2D[1][0] - size.y_ * rot2D[1][1];
-
-            dest[33] = billboard.position_.x_;
-            dest[34] = billboard.position_.y_;
-            dest[35] = billboard.position_.z_;
-            dest[36] = billboard.direction_.x_;
-            dest[37] = billboard.direction_.y_;
-            dest[38] = billboard.direction_.z_;
-            ((unsigned&)dest[39]) = color;
-            dest[40] = billboard.uv_.min_.x_;
-            dest[41] = billboard.uv_.max_.y_;
-            dest[42] = -size.x_ * rot2D[0][0] - size.y_ * rot2D[0][1];
-            dest[43] = -size.x_ * rot2D[1][0] - size.y_ * rot2D[1][1];
-
-            dest += 44;
+            const unsigned count = Min(billboardsPerTask, enabledBillboards - begin);
+            queue->AddWorkItem([=]()
+            {
+                writeVertices(dest + begin * billboardSize, sortedBillboards_.data() + begin, count,
+                    billboardScale, fixedScreenSize_);
+            }, M_MAX_UNSIGNED);
         }
+        queue->Complete(M_MAX_UNSIGNED);
     }
 
     vertexBuffer_->Unlock();
@@ -237,6 +237,8 @@ private:
     Vector3 previousOffset_;
     /// Billboard pointers for sorting.
     ea::vector<Billboard*> sortedBillboards_;
+    /// Temporary buffer for sorting.
+    ea::vector<Billboard*> sortBuffer_;
     /// Attribute buffer for network replication.
     mutable VectorBuffer attrBuffer_;
 };
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
@@ -33,6 +34,7 @@
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Tangent.h"
+#include "../Graphics/TriangleBVH.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -128,6 +130,310 @@ static void ClipPolygon(ea::vector<DecalVertex>& dest, const ea::vector<DecalVer
         dest.push_back(ClipEdge(src[last], src[0], lastDistance, distance, skinned));
 }
 
+/// CPU-side vertex and index data of a decal target geometry.
+struct DecalTargetData
+{
+    const unsigned char* positionData_{};
+    const unsigned char* normalData_{};
+    const unsigned char* skinningData_{};
+    const unsigned char* indexData_{};
+    unsigned positionStride_{};
+    unsigned normalStride_{};
+    unsigned skinningStride_{};
+    unsigned indexStride_{};
+};
+
+/// Get CPU-side data of the target geometry. Return false if vertex positions are not available.
+static bool GetDecalTargetData(const Geometry* geometry, DecalTargetData& data)
+{
+    IndexBuffer* ib = geometry->GetIndexBuffer();
+    if (ib)
+    {
+        data.indexData_ = ib->GetShadowData();
+        data.indexStride_ = ib->GetIndexSize();
+    }
+
+    // For morphed models positions, normals and skinning may be in different buffers
+    for (unsigned i = 0; i < geometry->GetNumVertexBuffers(); ++i)
+    {
+        VertexBuffer* vb = geometry->GetVertexBuffer(i);
+        if (!vb)
+            continue;
+
+        unsigned elementMask = vb->GetElementMask();
+        unsigned char* vertexData = vb->GetShadowData();
+        if (!vertexData)
+            continue;
+
+        if (elementMask & MASK_POSITION)
+        {
+            data.positionData_ = vertexData;
+            data.positionStride_ = vb->GetVertexSize();
+        }
+        if (elementMask & MASK_NORMAL)
+        {
+            data.normalData_ = vertexData + vb->GetElementOffset(SEM_NORMAL);
+            data.normalStride_ = vb->GetVertexSize();
+        }
+        if (elementMask & MASK_BLENDWEIGHTS)
+        {
+            data.skinningData_ = vertexData + vb->GetElementOffset(SEM_BLENDWEIGHTS);
+            data.skinningStride_ = vb->GetVertexSize();
+        }
+    }
+
+    // Positions and indices are needed
+    if (!data.positionData_)
+    {
+        // As a fallback, try to get the geometry's raw vertex/index data
+        const ea::vector<VertexElement>* elements;
+        geometry->GetRawData(data.positionData_, data.positionStride_, data.indexData_, data.indexStride_, elements);
+    }
+
+    return data.positionData_ != nullptr;
+}
+
+/// Call a function with vertex indices of each target geometry triangle. When a BVH is given, visit only the triangles that may intersect the frustum.
+template <class T> static void ForEachDecalTriangle(const Geometry* geometry, const DecalTargetData& data, const TriangleBVH* bvh,
+    const Frustum& frustum, const T& callback)
+{
+    if (bvh)
+    {
+        ea::vector<unsigned> indices;
+        bvh->GetTriangles(indices, frustum);
+        for (unsigned i = 0; i + 2 < indices.size(); i += 3)
+            callback(indices[i], indices[i + 1], indices[i + 2]);
+    }
+    else if (data.indexData_)
+    {
+        unsigned indexStart = geometry->GetIndexStart();
+        unsigned indexCount = geometry->GetIndexCount();
+
+        // 16-bit indices
+        if (data.indexStride_ == sizeof(unsigned short))
+        {
+            const unsigned short* indices = ((const unsigned short*)data.indexData_) + indexStart;
+            const unsigned short* indicesEnd = indices + indexCount;
+
+            while (indices < indicesEnd)
+            {
+                callback(indices[0], indices[1], indices[2]);
+                indices += 3;
+            }
+        }
+        else
+        // 32-bit indices
+        {
+            const unsigned* indices = ((const unsigned*)data.indexData_) + indexStart;
+            const unsigned* indicesEnd = indices + indexCount;
+
+            while (indices < indicesEnd)
+            {
+                callback(indices[0], indices[1], indices[2]);
+                indices += 3;
+            }
+        }
+    }
+    else
+    {
+        // Non-indexed geometry
+        unsigned indices = geometry->GetVertexStart();
+        unsigned indicesEnd = indices + geometry->GetVertexCount();
+
+        while (indices + 2 < indicesEnd)
+        {
+            callback(indices, indices + 1, indices + 2);
+            indices += 3;
+        }
+    }
+}
+
+/// Fill an unskinned triangle face from the target geometry. Return false if the face is facing away from the decal or is outside the decal frustum.
+static bool GetStaticFace(ea::vector<DecalVertex>& face, unsigned i0, unsigned i1, unsigned i2, const unsigned char* positionData,
+    const unsigned char* normalData, unsigned positionStride, unsigned normalStride, const Frustum& frustum,
+    const Vector3& decalNormal, float normalCutoff)
+{
+    bool hasNormals = normalData != nullptr;
+
+    const Vector3& v0 = *((const Vector3*)(&positionData[i0 * positionStride]));
+    const Vector3& v1 = *((const Vector3*)(&positionData[i1 * positionStride]));
+    const Vector3& v2 = *((const Vector3*)(&positionData[i2 * positionStride]));
+
+    // Calculate unsmoothed face normals if no normal data
+    Vector3 faceNormal = Vector3::ZERO;
+    if (!hasNormals)
+    {
+        Vector3 dist1 = v1 - v0;
+        Vector3 dist2 = v2 - v0;
+        faceNormal = (dist1.CrossProduct(dist2)).Normalized();
+    }
+
+    const Vector3& n0 = hasNormals ? *((const Vector3*)(&normalData[i0 * normalStride])) : faceNormal;
+    const Vector3& n1 = hasNormals ? *((const Vector3*)(&normalData[i1 * normalStride])) : faceNormal;
+    const Vector3& n2 = hasNormals ? *((const Vector3*)(&normalData[i2 * normalStride])) : faceNormal;
+
+    // Check if face is too much away from the decal normal
+    if (decalNormal.DotProduct((n0 + n1 + n2) / 3.0f) < normalCutoff)
+        return false;
+
+    // Check if face is culled completely by any of the planes
+    for (unsigned i = PLANE_FAR; i < NUM_FRUSTUM_PLANES; --i)
+    {
+        const Plane& plane = frustum.planes_[i];
+        if (plane.Distance(v0) < 0.0f && plane.Distance(v1) < 0.0f && plane.Distance(v2) < 0.0f)
+            return false;
+    }
+
+    face.reserve(3);
+    face.push_back(DecalVertex(v0, n0));
+    face.push_back(DecalVertex(v1, n1));
+    face.push_back(DecalVertex(v2, n2));
+    return true;
+}
+
+/// Clip faces against the decal frustum and triangulate them into the decal.
+static void ClipFaces(Decal& decal, ea::vector<ea::vector<DecalVertex> >& faces, const Frustum& frustum, bool skinned)
+{
+    ea::vector<DecalVertex> tempFace;
+
+    // Clip the acquired faces against all frustum planes
+    for (const auto& plane : frustum.planes_)
+    {
+        for (unsigned j = 0; j < faces.size(); ++j)
+        {
+            ea::vector<DecalVertex>& face = faces[j];
+            if (face.empty())
+                continue;
+
+            ClipPolygon(tempFace, face, plane, skinned);
+            face = tempFace;
+        }
+    }
+
+    // Now triangulate the resulting faces into decal vertices
+    for (unsigned i = 0; i < faces.size(); ++i)
+    {
+        ea::vector<DecalVertex>& face = faces[i];
+        if (face.size() < 3)
+            continue;
+
+        for (unsigned j = 2; j < face.size(); ++j)
+        {
+            decal.AddVertex(face[0]);
+            decal.AddVertex(face[j - 1]);
+            decal.AddVertex(face[j]);
+        }
+    }
+}
+
+/// Calculate UV coordinates for the decal.
+static void CalculateUVs(Decal& decal, const Matrix3x4& view, const Matrix4& projection, const Vector2& topLeftUV,
+    const Vector2& bottomRightUV)
+{
+    Matrix4 viewProj = projection * view;
+
+    for (auto i = decal.vertices_.begin(); i != decal.vertices_.end(); ++i)
+    {
+        Vector3 projected = viewProj * i->position_;
+        i->texCoord_ = Vector2(
+            Lerp(topLeftUV.x_, bottomRightUV.x_, projected.x_ * 0.5f + 0.5f),
+            Lerp(bottomRightUV.y_, topLeftUV.y_, projected.y_ * 0.5f + 0.5f)
+        );
+    }
+}
+
+/// Transform decal's vertices from the target geometry to the decal set local space.
+static void TransformVertices(Decal& decal, const Matrix3x4& transform)
+{
+    for (auto i = decal.vertices_.begin(); i != decal.vertices_.end(); ++i)
+    {
+        i->position_ = transform * i->position_;
+        i->normal_ = (transform * Vector4(i->normal_, 0.0f)).Normalized();
+    }
+}
+
+/// Calculate UVs, tangents and bounding box of the clipped decal and transform it to the decal set local space.
+static void FinalizeDecal(Decal& decal, const Matrix3x4& frustumTransform, float size, float aspectRatio, float depth,
+    const Vector2& topLeftUV, const Vector2& bottomRightUV, const Matrix3x4& decalTransform)
+{
+    // Calculate UVs
+    Matrix4 projection(Matrix4::ZERO);
+    projection.m11_ = (1.0f / (size * 0.5f));
+    projection.m00_ = projection.m11_ / aspectRatio;
+    projection.m22_ = 1.0f / depth;
+    projection.m33_ = 1.0f;
+
+    CalculateUVs(decal, frustumTransform.Inverse(), projection, topLeftUV, bottomRightUV);
+
+    // Transform vertices to this node's local space and generate tangents
+    TransformVertices(decal, decalTransform);
+    GenerateTangents(&decal.vertices_[0], sizeof(DecalVertex), &decal.indices_[0], sizeof(unsigned short), 0,
+        decal.indices_.size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
+        tangent_));
+
+    decal.CalculateBoundingBox();
+}
+
+/// %Decal being clipped in a worker thread.
+struct DecalSet::PendingDecal : public RefCounted
+{
+    /// Clip the target geometries and calculate the decal vertices. Called from a worker thread.
+    void Process()
+    {
+        ea::vector<ea::vector<DecalVertex> > faces;
+
+        for (unsigned i = 0; i < geometries_.size(); ++i)
+        {
+            DecalTargetData data;
+            if (!GetDecalTargetData(geometries_[i], data))
+                continue;
+
+            ForEachDecalTriangle(geometries_[i], data, bvhs_[i], frustum_, [&](unsigned i0, unsigned i1, unsigned i2)
+            {
+                faces.resize(faces.size() + 1);
+                if (!GetStaticFace(faces.back(), i0, i1, i2, data.positionData_, data.normalData_, data.positionStride_,
+                    data.normalStride_, frustum_, decalNormal_, normalCutoff_))
+                    faces.pop_back();
+            });
+        }
+
+        ClipFaces(decal_, faces, frustum_, false);
+        if (!decal_.vertices_.empty())
+            FinalizeDecal(decal_, frustumTransform_, size_, aspectRatio_, depth_, topLeftUV_, bottomRightUV_, decalTransform_);
+
+        completed_.store(true, std::memory_order_release);
+    }
+
+    /// Target geometries.
+    ea::vector<SharedPtr<Geometry> > geometries_;
+    /// Triangle BVHs of the target geometries.
+    ea::vector<SharedPtr<TriangleBVH> > bvhs_;
+    /// %Decal frustum in target space.
+    Frustum frustum_;
+    /// Frustum transform in target space.
+    Matrix3x4 frustumTransform_;
+    /// Transform from target space to the decal set local space.
+    Matrix3x4 decalTransform_;
+    /// %Decal normal in target space.
+    Vector3 decalNormal_;
+    /// Normal cutoff.
+    float normalCutoff_{};
+    /// %Decal size.
+    float size_{};
+    /// %Decal aspect ratio.
+    float aspectRatio_{};
+    /// %Decal depth.
+    float depth_{};
+    /// Top left UV.
+    Vector2 topLeftUV_;
+    /// Bottom right UV.
+    Vector2 bottomRightUV_;
+    /// Resulting decal.
+    Decal decal_;
+    /// Completed flag.
+    std::atomic<bool> completed_{};
+};
+
 void Decal::AddVertex(const DecalVertex& vertex)
 {
     for (unsigned i = 0; i < vertices_.size(); ++i)
@@ -384,7 +690,6 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
     newDecal.timeToLive_ = timeToLive;
 
     ea::vector<ea::vector<DecalVertex> > faces;
-    ea::vector<DecalVertex> tempFace;
 
     unsigned numBatches = target->GetBatches().size();
 
@@ -397,34 +702,7 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
             GetFaces(faces, target, i, decalFrustum, decalNormal, normalCutoff);
     }
 
-    // Clip the acquired faces against all frustum planes
-    for (const auto& plane : decalFrustum.planes_)
-    {
-        for (unsigned j = 0; j < faces.size(); ++j)
-        {
-            ea::vector<DecalVertex>& face = faces[j];
-            if (face.empty())
-                continue;
-
-            ClipPolygon(tempFace, face, plane, skinned_);
-            face = tempFace;
-        }
-    }
-
-    // Now triangulate the resulting faces into decal vertices
-    for (unsigned i = 0; i < faces.size(); ++i)
-    {
-        ea::vector<DecalVertex>& face = faces[i];
-        if (face.size() < 3)
-            continue;
-
-        for (unsigned j = 2; j < face.size(); ++j)
-        {
-            newDecal.AddVertex(face[0]);
-            newDecal.AddVertex(face[j - 1]);
-            newDecal.AddVertex(face[j]);
-        }
-    }
+    ClipFaces(newDecal, faces, decalFrustum, skinned_);
 
     // Check if resulted in no triangles
     if (newDecal.vertices_.empty())
@@ -448,23 +726,10 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
         return false;
     }
 
-    // Calculate UVs
-    Matrix4 projection(Matrix4::ZERO);
-    projection.m11_ = (1.0f / (size * 0.5f));
-    projection.m00_ = projection.m11_ / aspectRatio;
-    projection.m22_ = 1.0f / depth;
-    projection.m33_ = 1.0f;
-
-    CalculateUVs(newDecal, frustumTransform.Inverse(), projection, topLeftUV, bottomRightUV);
-
-    // Transform vertices to this node's local space and generate tangents
     Matrix3x4 decalTransform = node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
-    TransformVertices(newDecal, skinned_ ? Matrix3x4::IDENTITY : decalTransform);
-    GenerateTangents(&newDecal.vertices_[0], sizeof(DecalVertex), &newDecal.indices_[0], sizeof(unsigned short), 0,
-        newDecal.indices_.size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
-        tangent_));
+    FinalizeDecal(newDecal, frustumTransform, size, aspectRatio, depth, topLeftUV, bottomRightUV,
+        skinned_ ? Matrix3x4::IDENTITY : decalTransform);
 
-    newDecal.CalculateBoundingBox();
     numVertices_ += newDecal.vertices_.size();
     numIndices_ += newDecal.indices_.size();
 
@@ -482,6 +747,80 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
     return true;
 }
 
+bool DecalSet::AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+    float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive, float normalCutoff,
+    unsigned subGeometry)
+{
+    // Skinned decals need bone lookups from the target, so add them immediately. Also let AddDecal handle invalid input
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !node_ || !GetSubsystem<Graphics>() || !target || !target->GetNode() || dynamic_cast<AnimatedModel*>(target))
+    {
+        return AddDecal(target, worldPosition, worldRotation, size, aspectRatio, depth, topLeftUV, bottomRightUV, timeToLive,
+            normalCutoff, subGeometry);
+    }
+
+    URHO3D_PROFILE("AddDecalAsync");
+
+    if (skinned_)
+    {
+        RemoveAllDecals();
+        skinned_ = false;
+        bufferDirty_ = true;
+    }
+
+    // Center the decal frustum on the world position
+    Vector3 adjustedWorldPosition = worldPosition - 0.5f * depth * (worldRotation * Vector3::FORWARD);
+    Matrix3x4 targetTransform = target->GetNode()->GetWorldTransform().Inverse();
+
+    auto pendingDecal = MakeShared<PendingDecal>();
+    pendingDecal->frustumTransform_ = targetTransform * Matrix3x4(adjustedWorldPosition, worldRotation, 1.0f);
+    pendingDecal->frustum_.DefineOrtho(size, aspectRatio, 1.0, 0.0f, depth, pendingDecal->frustumTransform_);
+    pendingDecal->decalNormal_ = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
+    pendingDecal->decalTransform_ = node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
+    pendingDecal->size_ = size;
+    pendingDecal->aspectRatio_ = aspectRatio;
+    pendingDecal->depth_ = depth;
+    pendingDecal->normalCutoff_ = normalCutoff;
+    pendingDecal->topLeftUV_ = topLeftUV;
+    pendingDecal->bottomRightUV_ = bottomRightUV;
+    pendingDecal->decal_.timeToLive_ = timeToLive;
+
+    // Collect the geometries and build their BVHs now, as they can not be built from worker threads
+    unsigned numBatches = target->GetBatches().size();
+    unsigned beginBatch = subGeometry < numBatches ? subGeometry : 0;
+    unsigned endBatch = subGeometry < numBatches ? subGeometry + 1 : numBatches;
+    for (unsigned i = beginBatch; i < endBatch; ++i)
+    {
+        Geometry* geometry = target->GetLodGeometry(i, 0);
+        if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
+            continue;
+
+        DecalTargetData data;
+        if (!GetDecalTargetData(geometry, data))
+        {
+            URHO3D_LOGWARNING("Can not add decal, target drawable has no CPU-side geometry data");
+            continue;
+        }
+
+        pendingDecal->geometries_.emplace_back(geometry);
+        pendingDecal->bvhs_.emplace_back(
+            geometry->GetTriangleBVH(data.positionData_, data.positionStride_, data.indexData_, data.indexStride_));
+    }
+
+    if (pendingDecal->geometries_.empty())
+        return true;
+
+    // The work item keeps the pending decal alive even if this component is destroyed meanwhile.
+    // Work items are released in the main thread, so the target geometries are never freed from a worker thread
+    pendingDecals_.push_back(pendingDecal);
+    queue->AddWorkItem([pendingDecal]() { pendingDecal->Process(); }, 0);
+
+    if (!subscribed_)
+        UpdateEventSubscription(false);
+
+    return true;
+}
+
 void DecalSet::RemoveDecals(unsigned num)
 {
     while (num-- && decals_.size())
@@ -490,6 +829,8 @@ void DecalSet::RemoveDecals(unsigned num)
 
 void DecalSet::RemoveAllDecals()
 {
+    pendingDecals_.clear();
+
     if (!decals_.empty())
     {
         decals_.clear();
@@ -702,109 +1043,21 @@ void DecalSet::GetFaces(ea::vector<ea::vector<DecalVertex> >& faces, Drawable* t
     if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
         return;
 
-    const unsigned char* positionData = nullptr;
-    const unsigned char* normalData = nullptr;
-    const unsigned char* skinningData = nullptr;
-    const unsigned char* indexData = nullptr;
-    unsigned positionStride = 0;
-    unsigned normalStride = 0;
-    unsigned skinningStride = 0;
-    unsigned indexStride = 0;
-
-    IndexBuffer* ib = geometry->GetIndexBuffer();
-    if (ib)
-    {
-        indexData = ib->GetShadowData();
-        indexStride = ib->GetIndexSize();
-    }
-
-    // For morphed models positions, normals and skinning may be in different buffers
-    for (unsigned i = 0; i < geometry->GetNumVertexBuffers(); ++i)
-    {
-        VertexBuffer* vb = geometry->GetVertexBuffer(i);
-        if (!vb)
-            continue;
-
-        unsigned elementMask = vb->GetElementMask();
-        unsigned char* data = vb->GetShadowData();
-        if (!data)
-            continue;
-
-        if (elementMask & MASK_POSITION)
-        {
-            positionData = data;
-            positionStride = vb->GetVertexSize();
-        }
-        if (elementMask & MASK_NORMAL)
-        {
-            normalData = data + vb->GetElementOffset(SEM_NORMAL);
-            normalStride = vb->GetVertexSize();
-        }
-        if (elementMask & MASK_BLENDWEIGHTS)
-        {
-            skinningData = data + vb->GetElementOffset(SEM_BLENDWEIGHTS);
-            skinningStride = vb->GetVertexSize();
-        }
-    }
-
-    // Positions and indices are needed
-    if (!positionData)
+    DecalTargetData data;
+    if (!GetDecalTargetData(geometry, data))
     {
-        // As a fallback, try to get the geometry's raw vertex/index data
-        const ea::vector<VertexElement>* elements;
-        geometry->GetRawData(positionData, positionStride, indexData, indexStride, elements);
-        if (!positionData)
-        {
-            URHO3D_LOGWARNING("Can not add decal, target drawable has no CPU-side geometry data");
-            return;
-        }
+        URHO3D_LOGWARNING("Can not add decal, target drawable has no CPU-side geometry data");
+        return;
     }
 
-    if (indexData)
+    // Vertex data of skinned targets may be changed by morphing, so do not use the cached BVH for them
+    const TriangleBVH* bvh = skinned_ ? nullptr :
+        geometry->GetTriangleBVH(data.positionData_, data.positionStride_, data.indexData_, data.indexStride_);
+    ForEachDecalTriangle(geometry, data, bvh, frustum, [&](unsigned i0, unsigned i1, unsigned i2)
     {
-        unsigned indexStart = geometry->GetIndexStart();
-        unsigned indexCount = geometry->GetIndexCount();
-
-        // 16-bit indices
-        if (indexStride == sizeof(unsigned short))
-        {
-            const unsigned short* indices = ((const unsigned short*)indexData) + indexStart;
-            const unsigned short* indicesEnd = indices + indexCount;
-
-            while (indices < indicesEnd)
-            {
-                GetFace(faces, target, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
-                    positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
-                indices += 3;
-            }
-        }
-        else
-        // 32-bit indices
-        {
-            const unsigned* indices = ((const unsigned*)indexData) + indexStart;
-            const unsigned* indicesEnd = indices + indexCount;
-
-            while (indices < indicesEnd)
-            {
-                GetFace(faces, target, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
-                    positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
-                indices += 3;
-            }
-        }
-    }
-    else
-    {
-        // Non-indexed geometry
-        unsigned indices = geometry->GetVertexStart();
-        unsigned indicesEnd = indices + geometry->GetVertexCount();
-
-        while (indices + 2 < indicesEnd)
-        {
-            GetFace(faces, target, batchIndex, indices, indices + 1, indices + 2, positionData, normalData, skinningData,
-                positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
-            indices += 3;
-        }
-    }
+        GetFace(faces, target, batchIndex, i0, i1, i2, data.positionData_, data.normalData_, data.skinningData_,
+            data.positionStride_, data.normalStride_, data.skinningStride_, frustum, decalNormal, normalCutoff);
+    });
 }
 
 void DecalSet::GetFace(ea::vector<ea::vector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1,
@@ -812,72 +1065,34 @@ void DecalSet::GetFace(ea::vector<ea::vector<DecalVertex> >& faces, Drawable* ta
     unsigned positionStride, unsigned normalStride, unsigned skinningStride, const Frustum& frustum, const Vector3& decalNormal,
     float normalCutoff)
 {
-    bool hasNormals = normalData != nullptr;
-    bool hasSkinning = skinned_ && skinningData != nullptr;
-
-    const Vector3& v0 = *((const Vector3*)(&positionData[i0 * positionStride]));
-    const Vector3& v1 = *((const Vector3*)(&positionData[i1 * positionStride]));
-    const Vector3& v2 = *((const Vector3*)(&positionData[i2 * positionStride]));
-
-    // Calculate unsmoothed face normals if no normal data
-    Vector3 faceNormal = Vector3::ZERO;
-    if (!hasNormals)
-    {
-        Vector3 dist1 = v1 - v0;
-        Vector3 dist2 = v2 - v0;
-        faceNormal = (dist1.CrossProduct(dist2)).Normalized();
-    }
-
-    const Vector3& n0 = hasNormals ? *((const Vector3*)(&normalData[i0 * normalStride])) : faceNormal;
-    const Vector3& n1 = hasNormals ? *((const Vector3*)(&normalData[i1 * normalStride])) : faceNormal;
-    const Vector3& n2 = hasNormals ? *((const Vector3*)(&normalData[i2 * normalStride])) : faceNormal;
-
-    const unsigned char* s0 = hasSkinning ? &skinningData[i0 * skinningStride] : nullptr;
-    const unsigned char* s1 = hasSkinning ? &skinningData[i1 * skinningStride] : nullptr;
-    const unsigned char* s2 = hasSkinning ? &skinningData[i2 * skinningStride] : nullptr;
-
-    // Check if face is too much away from the decal normal
-    if (decalNormal.DotProduct((n0 + n1 + n2) / 3.0f) < normalCutoff)
-        return;
-
-    // Check if face is culled completely by any of the planes
-    for (unsigned i = PLANE_FAR; i < NUM_FRUSTUM_PLANES; --i)
-    {
-        const Plane& plane = frustum.planes_[i];
-        if (plane.Distance(v0) < 0.0f && plane.Distance(v1) < 0.0f && plane.Distance(v2) < 0.0f)
-            return;
-    }
-
     faces.resize(faces.size() + 1);
     ea::vector<DecalVertex>& face = faces.back();
-    if (!hasSkinning)
+    if (!GetStaticFace(face, i0, i1, i2, positionData, normalData, positionStride, normalStride, frustum, decalNormal,
+        normalCutoff))
     {
-        face.reserve(3);
-        face.push_back(DecalVertex(v0, n0));
-        face.push_back(DecalVertex(v1, n1));
-        face.push_back(DecalVertex(v2, n2));
+        faces.pop_back();
+        return;
     }
-    else
+
+    if (skinned_ && skinningData)
     {
-        const auto* bw0 = (const float*)s0;
-        const auto* bw1 = (const float*)s1;
-        const auto* bw2 = (const float*)s2;
-        const unsigned char* bi0 = s0 + sizeof(float) * 4;
-        const unsigned char* bi1 = s1 + sizeof(float) * 4;
-        const unsigned char* bi2 = s2 + sizeof(float) * 4;
-        unsigned char nbi0[4];
-        unsigned char nbi1[4];
-        unsigned char nbi2[4];
-
-        // Make sure all bones are found and that there is room in the skinning matrices
-        if (!GetBones(target, batchIndex, bw0, bi0, nbi0) || !GetBones(target, batchIndex, bw1, bi1, nbi1) ||
-            !GetBones(target, batchIndex, bw2, bi2, nbi2))
-            return;
+        const unsigned vertexIndices[] = { i0, i1, i2 };
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            const unsigned char* s = &skinningData[vertexIndices[i] * skinningStride];
+            const auto* blendWeights = (const float*)s;
+            const unsigned char* blendIndices = s + sizeof(float) * 4;
+
+            // Make sure all bones are found and that there is room in the skinning matrices
+            if (!GetBones(target, batchIndex, blendWeights, blendIndices, face[i].blendIndices_))
+            {
+                face.clear();
+                return;
+            }
 
-        face.reserve(3);
-        face.push_back(DecalVertex(v0, n0, bw0, nbi0));
-        face.push_back(DecalVertex(v1, n1, bw1, nbi1));
-        face.push_back(DecalVertex(v2, n2, bw2, nbi2));
+            for (unsigned j = 0; j < 4; ++j)
+                face[i].blendWeights_[j] = blendWeights[j];
+        }
     }
 }
 
@@ -957,27 +1172,42 @@ bool DecalSet::GetBones(Drawable* target, unsigned batchIndex, const float* blen
     return true;
 }
 
-void DecalSet::CalculateUVs(Decal& decal, const Matrix3x4& view, const Matrix4& projection, const Vector2& topLeftUV,
-    const Vector2& bottomRightUV)
+void DecalSet::CommitPendingDecals()
 {
-    Matrix4 viewProj = projection * view;
-
-    for (auto i = decal.vertices_.begin(); i != decal.vertices_.end(); ++i)
+    for (auto i = pendingDecals_.begin(); i != pendingDecals_.end();)
     {
-        Vector3 projected = viewProj * i->position_;
-        i->texCoord_ = Vector2(
-            Lerp(topLeftUV.x_, bottomRightUV.x_, projected.x_ * 0.5f + 0.5f),
-            Lerp(bottomRightUV.y_, topLeftUV.y_, projected.y_ * 0.5f + 0.5f)
-        );
-    }
-}
+        PendingDecal* pendingDecal = *i;
+        if (!pendingDecal->completed_.load(std::memory_order_acquire))
+        {
+            ++i;
+            continue;
+        }
 
-void DecalSet::TransformVertices(Decal& decal, const Matrix3x4& transform)
-{
-    for (auto i = decal.vertices_.begin(); i != decal.vertices_.end(); ++i)
-    {
-        i->position_ = transform * i->position_;
-        i->normal_ = (transform * Vector4(i->normal_, 0.0f)).Normalized();
+        Decal& newDecal = pendingDecal->decal_;
+        if (newDecal.vertices_.size() > maxVertices_)
+        {
+            URHO3D_LOGWARNING("Can not add decal, vertex count " + ea::to_string(newDecal.vertices_.size()) + " exceeds maximum " +
+                ea::to_string(maxVertices_));
+        }
+        else if (newDecal.indices_.size() > maxIndices_)
+        {
+            URHO3D_LOGWARNING("Can not add decal, index count " + ea::to_string(newDecal.indices_.size()) + " exceeds maximum " +
+                ea::to_string(maxIndices_));
+        }
+        else if (!newDecal.vertices_.empty())
+        {
+            numVertices_ += newDecal.vertices_.size();
+            numIndices_ += newDecal.indices_.size();
+            decals_.push_back(ea::move(newDecal));
+
+            // Remove oldest decals if total vertices exceeded
+            while (decals_.size() && (numVertices_ > maxVertices_ || numIndices_ > maxIndices_))
+                RemoveDecals(1);
+
+            MarkDecalsDirty();
+        }
+
+        i = pendingDecals_.erase(i);
     }
 }
 
@@ -1140,8 +1370,8 @@ void DecalSet::UpdateEventSubscription(bool checkAllDecals)
             }
         }
 
-        // If no time limited decals, no need to subscribe to scene update
-        enabled = hasTimeLimitedDecals;
+        // If no time limited or pending decals, no need to subscribe to scene update
+        enabled = hasTimeLimitedDecals || !pendingDecals_.empty();
     }
 
     if (enabled && !subscribed_)
@@ -1172,6 +1402,9 @@ void DecalSet::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData
         else
             ++i;
     }
+
+    if (!pendingDecals_.empty())
+        CommitPendingDecals();
 }
 
 }
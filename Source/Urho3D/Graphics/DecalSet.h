@@ -154,6 +154,10 @@ public:
     bool AddDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size, float aspectRatio,
         float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f, float normalCutoff = 0.1f,
         unsigned subGeometry = M_MAX_UNSIGNED);
+    /// Add a decal like AddDecal, but clip the target geometry in a worker thread. The decal appears after clipping has finished, at the earliest during the next scene post-update. Skinned targets are processed immediately. The target geometry data should not be modified while the decal is pending. Return true if the decal was queued or added.
+    bool AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size, float aspectRatio,
+        float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f, float normalCutoff = 0.1f,
+        unsigned subGeometry = M_MAX_UNSIGNED);
     /// Remove n oldest decals.
     void RemoveDecals(unsigned num);
     /// Remove all decals.
@@ -167,6 +171,9 @@ public:
     /// @property
     unsigned GetNumDecals() const { return decals_.size(); }
 
+    /// Return number of decals queued with AddDecalAsync that are not added yet.
+    unsigned GetNumPendingDecals() const { return pendingDecals_.size(); }
+
     /// Retur number of vertices in the decals.
     /// @property
     unsigned GetNumVertices() const { return numVertices_; }
@@ -203,6 +210,8 @@ protected:
     void OnMarkedDirty(Node* node) override;
 
 private:
+    struct PendingDecal;
+
     /// Get triangle faces from the target geometry.
     void GetFaces(ea::vector<ea::vector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
         const Vector3& decalNormal, float normalCutoff);
@@ -215,11 +224,8 @@ private:
     /// Get bones referenced by skinning data and remap the skinning indices. Return true if successful.
     bool GetBones(Drawable* target, unsigned batchIndex, const float* blendWeights, const unsigned char* blendIndices,
         unsigned char* newBlendIndices);
-    /// Calculate UV coordinates for the decal.
-    void CalculateUVs
-        (Decal& decal, const Matrix3x4& view, const Matrix4& projection, const Vector2& topLeftUV, const Vector2& bottomRightUV);
-    /// Transform decal's vertices from the target geometry to the decal set local space.
-    void TransformVertices(Decal& decal, const Matrix3x4& transform);
+    /// Add decals whose asynchronous clipping has finished.
+    void CommitPendingDecals();
     /// Remove a decal by iterator and return iterator to the next decal.
     ea::list<Decal>::iterator RemoveDecal(ea::list<Decal>::iterator i);
     /// Mark decals and the bounding box dirty.
@@ -247,6 +253,8 @@ private:
     SharedPtr<IndexBuffer> indexBuffer_;
     /// Decals.
     ea::list<Decal> decals_;
+    /// Decals being clipped in worker threads, oldest first.
+    ea::vector<SharedPtr<PendingDecal> > pendingDecals_;
     /// Bones used for skinned decals.
     ea::vector<Bone> bones_;
     /// Skinning matrices.
@@ -69,6 +69,7 @@ bool IndexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.get())
         memcpy(shadowData_.get(), data, indexCount_ * indexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -128,6 +129,7 @@ bool IndexBuffer::SetDataRange(const void* data, unsigned start, unsigned count,
 
     if (shadowData_ && shadowData_.get() + start * indexSize_ != data)
         memcpy(shadowData_.get() + start * indexSize_, data, count * indexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -85,6 +85,7 @@ bool VertexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.get())
         memcpy(shadowData_.get(), data, vertexCount_ * vertexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
@@ -137,6 +138,7 @@ bool VertexBuffer::SetDataRange(const void* data, unsigned start, unsigned count
 
     if (shadowData_ && shadowData_.get() + start * vertexSize_ != data)
         memcpy(shadowData_.get() + start * vertexSize_, data, count * vertexSize_);
+    ++dataRevision_;
 
     if (object_.ptr_)
     {
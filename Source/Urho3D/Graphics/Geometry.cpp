@@ -26,6 +26,7 @@
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/IndexBuffer.h"
+#include "../Graphics/TriangleBVH.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../Math/Ray.h"
@@ -48,7 +49,10 @@ Geometry::Geometry(Context* context) :
     vertexCount_(0),
     rawVertexSize_(0),
     rawIndexSize_(0),
-    lodDistance_(0.0f)
+    lodDistance_(0.0f),
+    triangleBVHVertexData_(nullptr),
+    triangleBVHIndexData_(nullptr),
+    triangleBVHDataRevision_(0)
 {
     SetNumVertexBuffers(1);
 }
@@ -83,17 +87,20 @@ bool Geometry::SetVertexBuffer(unsigned index, VertexBuffer* buffer)
     }
 
     vertexBuffers_[index] = buffer;
+    ResetTriangleBVH();
     return true;
 }
 
 void Geometry::SetVertexBuffers(const ea::vector<SharedPtr<VertexBuffer>>& vertexBuffers)
 {
     vertexBuffers_ = vertexBuffers;
+    ResetTriangleBVH();
 }
 
 void Geometry::SetIndexBuffer(IndexBuffer* buffer)
 {
     indexBuffer_ = buffer;
+    ResetTriangleBVH();
 }
 
 bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned indexCount, bool getUsedVertexRange)
@@ -129,6 +136,7 @@ bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned in
         vertexCount_ = 0;
     }
 
+    ResetTriangleBVH();
     return true;
 }
 
@@ -157,6 +165,7 @@ bool Geometry::SetDrawRange(PrimitiveType type, unsigned indexStart, unsigned in
     vertexStart_ = vertexStart;
     vertexCount_ = vertexCount;
 
+    ResetTriangleBVH();
     return true;
 }
 
@@ -173,6 +182,7 @@ void Geometry::SetRawVertexData(const ea::shared_array<unsigned char>& data, con
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elements);
     rawElements_ = elements;
+    ResetTriangleBVH();
 }
 
 void Geometry::SetRawVertexData(const ea::shared_array<unsigned char>& data, unsigned elementMask)
@@ -180,12 +190,14 @@ void Geometry::SetRawVertexData(const ea::shared_array<unsigned char>& data, uns
     rawVertexData_ = data;
     rawVertexSize_ = VertexBuffer::GetVertexSize(elementMask);
     rawElements_ = VertexBuffer::GetElements(elementMask);
+    ResetTriangleBVH();
 }
 
 void Geometry::SetRawIndexData(const ea::shared_array<unsigned char>& data, unsigned indexSize)
 {
     rawIndexData_ = data;
     rawIndexSize_ = indexSize;
+    ResetTriangleBVH();
 }
 
 void Geometry::Draw(Graphics* graphics)
@@ -224,6 +236,11 @@ unsigned short Geometry::GetBufferHash() const
     return hash;
 }
 
+void Geometry::ResetTriangleBVH()
+{
+    triangleBVH_.Reset();
+}
+
 void Geometry::GetRawData(const unsigned char*& vertexData, unsigned& vertexSize, const unsigned char*& indexData,
     unsigned& indexSize, const ea::vector<VertexElement>*& elements) const
 {
@@ -355,4 +372,35 @@ bool Geometry::IsInside(const Ray& ray) const
                          ray.InsideGeometry(vertexData, vertexSize, vertexStart_, vertexCount_)) : false;
 }
 
+TriangleBVH* Geometry::GetTriangleBVH(const unsigned char* vertexData, unsigned vertexSize, const unsigned char* indexData,
+    unsigned indexSize)
+{
+    if (primitiveType_ != TRIANGLE_LIST || !vertexData)
+        return nullptr;
+
+    // The revisions of the buffers only grow, so their sum changes whenever the contents of any buffer change
+    unsigned dataRevision = indexBuffer_ ? indexBuffer_->GetDataRevision() : 0;
+    for (const SharedPtr<VertexBuffer>& vertexBuffer : vertexBuffers_)
+    {
+        if (vertexBuffer)
+            dataRevision += vertexBuffer->GetDataRevision();
+    }
+
+    if (triangleBVH_ && triangleBVHVertexData_ == vertexData && triangleBVHIndexData_ == indexData &&
+        triangleBVHDataRevision_ == dataRevision)
+        return triangleBVH_;
+
+    // Create a new BVH instead of rebuilding the old one, as pending queries may still refer to it
+    triangleBVH_ = MakeShared<TriangleBVH>();
+    if (indexData)
+        triangleBVH_->Build(vertexData, vertexSize, indexData, indexSize, indexStart_, indexCount_);
+    else
+        triangleBVH_->Build(vertexData, vertexSize, nullptr, 0, vertexStart_, vertexCount_);
+
+    triangleBVHVertexData_ = vertexData;
+    triangleBVHIndexData_ = indexData;
+    triangleBVHDataRevision_ = dataRevision;
+    return triangleBVH_;
+}
+
 }
@@ -33,6 +33,7 @@ namespace Urho3D
 class IndexBuffer;
 class Ray;
 class Graphics;
+class TriangleBVH;
 class VertexBuffer;
 
 /// Defines one or more vertex buffers, an index buffer and a draw range.
@@ -75,6 +76,8 @@ public:
     void SetRawIndexData(const ea::shared_array<unsigned char>& data, unsigned indexSize);
     /// Draw.
     void Draw(Graphics* graphics);
+    /// Discard cached triangle BVH. Changes in vertex and index buffer contents are detected automatically, but this should be called after modifying raw data overrides in place.
+    void ResetTriangleBVH();
 
     /// Return all vertex buffers.
     const ea::vector<SharedPtr<VertexBuffer> >& GetVertexBuffers() const { return vertexBuffers_; }
@@ -126,6 +129,8 @@ public:
     float GetHitDistance(const Ray& ray, Vector3* outNormal = nullptr, Vector2* outUV = nullptr) const;
     /// Return whether or not the ray is inside geometry.
     bool IsInside(const Ray& ray) const;
+    /// Return triangle BVH over the draw range for CPU-side queries, built from the given vertex positions and optional indices. The BVH is cached and rebuilt when the source data, the draw range or the vertex and index buffer contents change. Raw data overrides modified in place must be set again. Return null if not a triangle list or no vertex data. Not thread-safe.
+    TriangleBVH* GetTriangleBVH(const unsigned char* vertexData, unsigned vertexSize, const unsigned char* indexData, unsigned indexSize);
 
     /// Return whether has empty draw range.
     /// @property
@@ -158,6 +163,14 @@ private:
     unsigned rawVertexSize_;
     /// Raw index data override size.
     unsigned rawIndexSize_;
+    /// Cached triangle BVH.
+    SharedPtr<TriangleBVH> triangleBVH_;
+    /// Vertex data the triangle BVH was built from.
+    const unsigned char* triangleBVHVertexData_;
+    /// Index data the triangle BVH was built from.
+    const unsigned char* triangleBVHIndexData_;
+    /// Combined data revision of the buffers when the triangle BVH was built.
+    unsigned triangleBVHDataRevision_;
 };
 
 }
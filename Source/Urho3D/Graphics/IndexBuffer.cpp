@@ -45,7 +45,8 @@ IndexBuffer::IndexBuffer(Context* context, bool forceHeadless) :
     lockScratchData_(nullptr),
     shadowed_(false),
     dynamic_(false),
-    discardLock_(false)
+    discardLock_(false),
+    dataRevision_(0)
 {
     // Force shadowing mode if graphics subsystem does not exist
     if (!graphics_)
@@ -78,6 +79,7 @@ void IndexBuffer::SetShadowed(bool enable)
             shadowData_.reset();
 
         shadowed_ = enable;
+        ++dataRevision_;
     }
 }
 
@@ -93,6 +95,7 @@ bool IndexBuffer::SetSize(unsigned indexCount, bool largeIndices, bool dynamic)
         shadowData_ = new unsigned char[indexCount_ * indexSize_];
     else
         shadowData_.reset();
+    ++dataRevision_;
 
     return Create();
 }
@@ -96,6 +96,9 @@ public:
     /// Return shared array pointer to the CPU memory shadow data.
     ea::shared_array<unsigned char> GetShadowDataShared() const { return shadowData_; }
 
+    /// Return data revision. Incremented whenever the buffer data, size or shadowing changes.
+    unsigned GetDataRevision() const { return dataRevision_; }
+
     /// Return unpacked buffer data as plain array of indices.
     ea::vector<unsigned> GetUnpackedData(unsigned start = 0, unsigned count = M_MAX_UNSIGNED) const;
 
@@ -138,6 +141,8 @@ private:
     bool shadowed_;
     /// Discard lock flag. Used by OpenGL only.
     bool discardLock_;
+    /// Data revision.
+    unsigned dataRevision_;
 };
 
 }
@@ -510,6 +510,17 @@ void Octree::Update(const FrameInfo& frame)
         scene->EndThreadedUpdate();
     }
 
+    // Perform the updates postponed to the main thread. These drawables are already queued for reinsertion
+    if (!postponedDrawableUpdates_.empty())
+    {
+        URHO3D_PROFILE("UpdateDrawablesPostponed");
+
+        for (auto i = postponedDrawableUpdates_.begin(); i != postponedDrawableUpdates_.end(); ++i)
+            (*i)->Update(frame);
+
+        postponedDrawableUpdates_.clear();
+    }
+
     // If any drawables were inserted during threaded update, update them now from the main thread
     if (!threadedDrawableUpdates_.empty())
     {
@@ -688,6 +699,12 @@ void Octree::CancelUpdate(Drawable* drawable)
     drawable->updateQueued_ = false;
 }
 
+void Octree::PostponeUpdate(Drawable* drawable)
+{
+    MutexLock lock(octreeMutex_);
+    postponedDrawableUpdates_.push_back(drawable);
+}
+
 void Octree::DrawDebugGeometry(bool depthTest)
 {
     auto* debug = GetComponent<DebugRenderer>();
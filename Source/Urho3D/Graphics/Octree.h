@@ -207,6 +207,8 @@ public:
     void QueueUpdate(Drawable* drawable);
     /// Cancel drawable object's update.
     void CancelUpdate(Drawable* drawable);
+    /// Postpone the update of a drawable from a worker thread to the main thread, after the threaded update has finished. The drawable stays queued for reinsertion. Should only be called from Drawable::Update().
+    void PostponeUpdate(Drawable* drawable);
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
@@ -220,6 +222,8 @@ private:
     ea::vector<Drawable*> drawableUpdates_;
     /// Drawable objects that were inserted during threaded update phase.
     ea::vector<Drawable*> threadedDrawableUpdates_;
+    /// Drawable objects whose update was postponed from worker threads to the main thread.
+    ea::vector<Drawable*> postponedDrawableUpdates_;
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
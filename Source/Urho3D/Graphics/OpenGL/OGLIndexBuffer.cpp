@@ -91,6 +91,7 @@ bool IndexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.get())
         memcpy(shadowData_.get(), data, indexCount_ * (size_t)indexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
@@ -138,6 +139,7 @@ bool IndexBuffer::SetDataRange(const void* data, unsigned start, unsigned count,
 
     if (shadowData_ && shadowData_.get() + start * indexSize_ != data)
         memcpy(shadowData_.get() + start * indexSize_, data, count * (size_t)indexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
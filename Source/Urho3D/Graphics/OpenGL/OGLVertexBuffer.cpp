@@ -94,6 +94,7 @@ bool VertexBuffer::SetData(const void* data)
 
     if (shadowData_ && data != shadowData_.get())
         memcpy(shadowData_.get(), data, vertexCount_ * (size_t)vertexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
@@ -141,6 +142,7 @@ bool VertexBuffer::SetDataRange(const void* data, unsigned start, unsigned count
 
     if (shadowData_ && shadowData_.get() + start * vertexSize_ != data)
         memcpy(shadowData_.get() + start * vertexSize_, data, count * (size_t)vertexSize_);
+    ++dataRevision_;
 
     if (object_.name_)
     {
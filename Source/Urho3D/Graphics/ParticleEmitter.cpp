@@ -24,8 +24,11 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DrawableEvents.h"
 #include "../Graphics/ParticleEffect.h"
+#include "../Graphics/Octree.h"
 #include "../Graphics/ParticleEmitter.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
@@ -40,9 +43,190 @@ namespace Urho3D
 extern const char* GEOMETRY_CATEGORY;
 extern const char* faceCameraModeNames[];
 static const unsigned MAX_PARTICLES_IN_FRAME = 100;
+static const unsigned MIN_PARTICLES_PER_TASK = 4096;
 
 extern const char* autoRemoveModeNames[];
 
+namespace
+{
+
+/// Parameters of particle update shared by all particles of the emitter.
+struct ParticleUpdateParams
+{
+    /// Time step.
+    float timeStep_{};
+    /// Constant force in particle space.
+    Vector3 constantForce_;
+    /// Velocity damping force.
+    float dampingForce_{};
+    /// Scale applied to position update.
+    Vector3 scaleVector_;
+    /// Size addition per second.
+    float sizeAdd_{};
+    /// Size multiplier per second.
+    float sizeMul_{};
+    /// Color animation frames.
+    const ea::vector<ColorFrame>* colorFrames_{};
+    /// Texture animation frames.
+    const ea::vector<TextureFrame>* textureFrames_{};
+};
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 is expected to be tightly packed");
+
+/// Apply constant and damping forces to velocities. Inactive particles are processed too, because it's cheaper than branching.
+void IntegrateVelocities(Vector3* velocities, unsigned count, const Vector3& force, float dampingForce, float timeStep)
+{
+    // Same as applying constant force and then damping force to updated velocity
+    const Vector3 offset = timeStep * force;
+    const float damping = 1.0f - timeStep * dampingForce;
+
+    float* data = &velocities->x_;
+    const unsigned numFloats = count * 3;
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    // Process 4 vectors per iteration, so the offset pattern repeats every 3 registers
+    const __m128 dampingVec = _mm_set1_ps(damping);
+    const __m128 offset0 = _mm_setr_ps(offset.x_, offset.y_, offset.z_, offset.x_);
+    const __m128 offset1 = _mm_setr_ps(offset.y_, offset.z_, offset.x_, offset.y_);
+    const __m128 offset2 = _mm_setr_ps(offset.z_, offset.x_, offset.y_, offset.z_);
+    for (; i + 12 <= numFloats; i += 12)
+    {
+        _mm_storeu_ps(data + i, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data + i), offset0), dampingVec));
+        _mm_storeu_ps(data + i + 4, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data + i + 4), offset1), dampingVec));
+        _mm_storeu_ps(data + i + 8, _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(data + i + 8), offset2), dampingVec));
+    }
+#endif
+
+    for (; i < numFloats; i += 3)
+    {
+        data[i] = (data[i] + offset.x_) * damping;
+        data[i + 1] = (data[i + 1] + offset.y_) * damping;
+        data[i + 2] = (data[i + 2] + offset.z_) * damping;
+    }
+}
+
+/// Update size scaling values. Inactive particles are processed too.
+void UpdateScales(float* scales, unsigned count, float sizeAdd, float sizeMul, float timeStep)
+{
+    const float add = timeStep * sizeAdd;
+    const float mul = timeStep * (sizeMul - 1.0f) + 1.0f;
+    unsigned i = 0;
+
+#ifdef URHO3D_SSE
+    const __m128 addVec = _mm_set1_ps(add);
+    const __m128 mulVec = _mm_set1_ps(mul);
+    const __m128 zeroVec = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 scale = _mm_max_ps(_mm_add_ps(_mm_loadu_ps(scales + i), addVec), zeroVec);
+        _mm_storeu_ps(scales + i, _mm_mul_ps(scale, mulVec));
+    }
+#endif
+
+    for (; i < count; ++i)
+        scales[i] = Max(scales[i] + add, 0.0f) * mul;
+}
+
+/// Update range of particles. Return whether there were any active particles.
+bool UpdateParticleRange(ParticleData& particles, Billboard* billboards, const ParticleUpdateParams& params,
+    unsigned begin, unsigned end)
+{
+    const float timeStep = params.timeStep_;
+    bool hasActiveParticles = false;
+
+    // Time to live
+    for (unsigned i = begin; i < end; ++i)
+    {
+        Billboard& billboard = billboards[i];
+        if (!billboard.enabled_)
+            continue;
+
+        hasActiveParticles = true;
+        if (particles.timer_[i] >= particles.timeToLive_[i])
+            billboard.enabled_ = false;
+        else
+            particles.timer_[i] += timeStep;
+    }
+
+    if (!hasActiveParticles)
+        return false;
+
+    // Velocity
+    if (params.constantForce_ != Vector3::ZERO || params.dampingForce_ != 0.0f)
+    {
+        IntegrateVelocities(&particles.velocity_[begin], end - begin,
+            params.constantForce_, params.dampingForce_, timeStep);
+    }
+
+    // Scaling
+    const bool updateSize = params.sizeAdd_ != 0.0f || params.sizeMul_ != 1.0f;
+    if (updateSize)
+        UpdateScales(&particles.scale_[begin], end - begin, params.sizeAdd_, params.sizeMul_, timeStep);
+
+    // Billboards
+    const ea::vector<ColorFrame>& colorFrames = *params.colorFrames_;
+    const ea::vector<TextureFrame>& textureFrames = *params.textureFrames_;
+    for (unsigned i = begin; i < end; ++i)
+    {
+        Billboard& billboard = billboards[i];
+        if (!billboard.enabled_)
+            continue;
+
+        const Vector3& velocity = particles.velocity_[i];
+        const float timer = particles.timer_[i];
+
+        billboard.position_ += timeStep * velocity * params.scaleVector_;
+        billboard.direction_ = velocity.Normalized();
+        billboard.rotation_ += timeStep * particles.rotationSpeed_[i];
+
+        if (updateSize)
+            billboard.size_ = particles.size_[i] * particles.scale_[i];
+
+        // Color interpolation
+        unsigned& index = particles.colorIndex_[i];
+        if (index < colorFrames.size())
+        {
+            if (index < colorFrames.size() - 1)
+            {
+                if (timer >= colorFrames[index + 1].time_)
+                    ++index;
+            }
+            if (index < colorFrames.size() - 1)
+                billboard.color_ = colorFrames[index].Interpolate(colorFrames[index + 1], timer);
+            else
+                billboard.color_ = colorFrames[index].color_;
+        }
+
+        // Texture animation
+        unsigned& texIndex = particles.texIndex_[i];
+        if (textureFrames.size() && texIndex < textureFrames.size() - 1)
+        {
+            if (timer >= textureFrames[texIndex + 1].time_)
+            {
+                billboard.uv_ = textureFrames[texIndex + 1].uv_;
+                ++texIndex;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
+
+void ParticleData::Resize(unsigned size)
+{
+    velocity_.resize(size);
+    size_.resize(size);
+    timer_.resize(size);
+    timeToLive_.resize(size);
+    scale_.resize(size);
+    rotationSpeed_.resize(size);
+    colorIndex_.resize(size);
+    texIndex_.resize(size);
+}
+
 ParticleEmitter::ParticleEmitter(Context* context) :
     BillboardSet(context),
     periodTimer_(0.0f),
@@ -88,14 +272,7 @@ void ParticleEmitter::OnSetEnabled()
 {
     BillboardSet::OnSetEnabled();
 
-    Scene* scene = GetScene();
-    if (scene)
-    {
-        if (IsEnabledEffective())
-            SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ParticleEmitter, HandleScenePostUpdate));
-        else
-            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-    }
+    UpdateEventSubscription(GetScene());
 }
 
 void ParticleEmitter::Update(const FrameInfo& frame)
@@ -107,9 +284,21 @@ void ParticleEmitter::Update(const FrameInfo& frame)
     if (!needUpdate_)
         return;
 
+    // Postpone update of big emitters until the end of threaded update, so particles can be processed in parallel
+    if (!Thread::IsMainThread() && particles_.Size() >= 2 * MIN_PARTICLES_PER_TASK)
+    {
+        Scene* scene = GetScene();
+        auto* queue = GetSubsystem<WorkQueue>();
+        if (octant_ && scene && scene->IsThreadedUpdate() && queue && queue->GetNumThreads())
+        {
+            octant_->GetRoot()->PostponeUpdate(this);
+            return;
+        }
+    }
+
     // If there is an amount mismatch between particles and billboards, correct it
-    if (particles_.size() != billboards_.size())
-        SetNumBillboards(particles_.size());
+    if (particles_.Size() != billboards_.size())
+        SetNumBillboards(particles_.Size());
 
     bool needCommit = false;
 
@@ -150,110 +339,28 @@ void ParticleEmitter::Update(const FrameInfo& frame)
         if (emissionTimer_ < -intervalMax)
             emissionTimer_ = -intervalMax;
 
-        unsigned counter = MAX_PARTICLES_IN_FRAME;
+        // Don't limit emission rate of big emitters too much
+        unsigned counter = Max(MAX_PARTICLES_IN_FRAME,
+            static_cast<unsigned>(CeilToInt(effect_->GetMaxEmissionRate() * lastTimeStep_)));
+        unsigned freeIndex = 0;
 
         while (emissionTimer_ > 0.0f && counter)
         {
             emissionTimer_ -= Lerp(intervalMin, intervalMax, Random(1.0f));
-            if (EmitNewParticle())
-            {
-                --counter;
-                needCommit = true;
-            }
-            else
+            freeIndex = GetFreeParticle(freeIndex);
+            if (freeIndex == M_MAX_UNSIGNED)
                 break;
-        }
-    }
-
-    // Update existing particles
-    Vector3 relativeConstantForce = node_->GetWorldRotation().Inverse() * effect_->GetConstantForce();
-    // If billboards are not relative, apply scaling to the position update
-    Vector3 scaleVector = Vector3::ONE;
-    if (scaled_ && !relative_)
-        scaleVector = node_->GetWorldScale();
 
-    for (unsigned i = 0; i < particles_.size(); ++i)
-    {
-        Particle& particle = particles_[i];
-        Billboard& billboard = billboards_[i];
-
-        if (billboard.enabled_)
-        {
+            EmitNewParticle(freeIndex);
+            --counter;
             needCommit = true;
-
-            // Time to live
-            if (particle.timer_ >= particle.timeToLive_)
-            {
-                billboard.enabled_ = false;
-                continue;
-            }
-            particle.timer_ += lastTimeStep_;
-
-            // Velocity & position
-            const Vector3& constantForce = effect_->GetConstantForce();
-            if (constantForce != Vector3::ZERO)
-            {
-                if (relative_)
-                    particle.velocity_ += lastTimeStep_ * relativeConstantForce;
-                else
-                    particle.velocity_ += lastTimeStep_ * constantForce;
-            }
-
-            float dampingForce = effect_->GetDampingForce();
-            if (dampingForce != 0.0f)
-            {
-                Vector3 force = -dampingForce * particle.velocity_;
-                particle.velocity_ += lastTimeStep_ * force;
-            }
-            billboard.position_ += lastTimeStep_ * particle.velocity_ * scaleVector;
-            billboard.direction_ = particle.velocity_.Normalized();
-
-            // Rotation
-            billboard.rotation_ += lastTimeStep_ * particle.rotationSpeed_;
-
-            // Scaling
-            float sizeAdd = effect_->GetSizeAdd();
-            float sizeMul = effect_->GetSizeMul();
-            if (sizeAdd != 0.0f || sizeMul != 1.0f)
-            {
-                particle.scale_ += lastTimeStep_ * sizeAdd;
-                if (particle.scale_ < 0.0f)
-                    particle.scale_ = 0.0f;
-                if (sizeMul != 1.0f)
-                    particle.scale_ *= (lastTimeStep_ * (sizeMul - 1.0f)) + 1.0f;
-                billboard.size_ = particle.size_ * particle.scale_;
-            }
-
-            // Color interpolation
-            unsigned& index = particle.colorIndex_;
-            const ea::vector<ColorFrame>& colorFrames_ = effect_->GetColorFrames();
-            if (index < colorFrames_.size())
-            {
-                if (index < colorFrames_.size() - 1)
-                {
-                    if (particle.timer_ >= colorFrames_[index + 1].time_)
-                        ++index;
-                }
-                if (index < colorFrames_.size() - 1)
-                    billboard.color_ = colorFrames_[index].Interpolate(colorFrames_[index + 1], particle.timer_);
-                else
-                    billboard.color_ = colorFrames_[index].color_;
-            }
-
-            // Texture animation
-            unsigned& texIndex = particle.texIndex_;
-            const ea::vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
-            if (textureFrames_.size() && texIndex < textureFrames_.size() - 1)
-            {
-                if (particle.timer_ >= textureFrames_[texIndex + 1].time_)
-                {
-                    billboard.uv_ = textureFrames_[texIndex + 1].uv_;
-                    ++texIndex;
-                }
-            }
         }
     }
 
+    // Update existing particles
+    if (UpdateParticles())
+        needCommit = true;
+
     if (needCommit)
         Commit();
 
@@ -286,7 +393,7 @@ void ParticleEmitter::SetNumParticles(unsigned num)
     if (num > M_MAX_INT)
         num = 0;
 
-    particles_.resize(num);
+    particles_.Resize(num);
     SetNumBillboards(num);
 }
 
@@ -371,16 +478,16 @@ void ParticleEmitter::SetParticlesAttr(const VariantVector& value)
     unsigned index = 0;
     SetNumParticles(index < value.size() ? value[index++].GetUInt() : 0);
 
-    for (auto i = particles_.begin(); i != particles_.end() && index < value.size(); ++i)
+    for (unsigned i = 0; i < particles_.Size() && index < value.size(); ++i)
     {
-        i->velocity_ = value[index++].GetVector3();
-        i->size_ = value[index++].GetVector2();
-        i->timer_ = value[index++].GetFloat();
-        i->timeToLive_ = value[index++].GetFloat();
-        i->scale_ = value[index++].GetFloat();
-        i->rotationSpeed_ = value[index++].GetFloat();
-        i->colorIndex_ = (unsigned)value[index++].GetInt();
-        i->texIndex_ = (unsigned)value[index++].GetInt();
+        particles_.velocity_[i] = value[index++].GetVector3();
+        particles_.size_[i] = value[index++].GetVector2();
+        particles_.timer_[i] = value[index++].GetFloat();
+        particles_.timeToLive_[i] = value[index++].GetFloat();
+        particles_.scale_[i] = value[index++].GetFloat();
+        particles_.rotationSpeed_[i] = value[index++].GetFloat();
+        particles_.colorIndex_[i] = (unsigned)value[index++].GetInt();
+        particles_.texIndex_[i] = (unsigned)value[index++].GetInt();
     }
 }
 
@@ -389,22 +496,22 @@ VariantVector ParticleEmitter::GetParticlesAttr() const
     VariantVector ret;
     if (!serializeParticles_)
     {
-        ret.push_back((int)particles_.size());
+        ret.push_back((int)particles_.Size());
         return ret;
     }
 
-    ret.reserve(particles_.size() * 8 + 1);
-    ret.push_back((int)particles_.size());
-    for (auto i = particles_.begin(); i != particles_.end(); ++i)
+    ret.reserve(particles_.Size() * 8 + 1);
+    ret.push_back((int)particles_.Size());
+    for (unsigned i = 0; i < particles_.Size(); ++i)
     {
-        ret.push_back(i->velocity_);
-        ret.push_back(i->size_);
-        ret.push_back(i->timer_);
-        ret.push_back(i->timeToLive_);
-        ret.push_back(i->scale_);
-        ret.push_back(i->rotationSpeed_);
-        ret.push_back(i->colorIndex_);
-        ret.push_back(i->texIndex_);
+        ret.push_back(particles_.velocity_[i]);
+        ret.push_back(particles_.size_[i]);
+        ret.push_back(particles_.timer_[i]);
+        ret.push_back(particles_.timeToLive_[i]);
+        ret.push_back(particles_.scale_[i]);
+        ret.push_back(particles_.rotationSpeed_[i]);
+        ret.push_back(particles_.colorIndex_[i]);
+        ret.push_back(particles_.texIndex_[i]);
     }
     return ret;
 }
@@ -439,10 +546,7 @@ void ParticleEmitter::OnSceneSet(Scene* scene)
 {
     BillboardSet::OnSceneSet(scene);
 
-    if (scene && IsEnabledEffective())
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(ParticleEmitter, HandleScenePostUpdate));
-    else if (!scene)
-         UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+    UpdateEventSubscription(scene);
 }
 
 bool ParticleEmitter::EmitNewParticle()
@@ -450,8 +554,14 @@ bool ParticleEmitter::EmitNewParticle()
     unsigned index = GetFreeParticle();
     if (index == M_MAX_UNSIGNED)
         return false;
-    assert(index < particles_.size());
-    Particle& particle = particles_[index];
+
+    EmitNewParticle(index);
+    return true;
+}
+
+void ParticleEmitter::EmitNewParticle(unsigned index)
+{
+    assert(index < particles_.Size());
     Billboard& billboard = billboards_[index];
 
     Vector3 startDir;
@@ -513,17 +623,18 @@ bool ParticleEmitter::EmitNewParticle()
         break;
     }
 
-    particle.size_ = effect_->GetRandomSize();
-    particle.timer_ = 0.0f;
-    particle.timeToLive_ = effect_->GetRandomTimeToLive();
-    particle.scale_ = 1.0f;
-    particle.rotationSpeed_ = effect_->GetRandomRotationSpeed();
-    particle.colorIndex_ = 0;
-    particle.texIndex_ = 0;
+    const Vector2 size = effect_->GetRandomSize();
+    particles_.size_[index] = size;
+    particles_.timer_[index] = 0.0f;
+    particles_.timeToLive_[index] = effect_->GetRandomTimeToLive();
+    particles_.scale_[index] = 1.0f;
+    particles_.rotationSpeed_[index] = effect_->GetRandomRotationSpeed();
+    particles_.colorIndex_[index] = 0;
+    particles_.texIndex_[index] = 0;
 
     if (faceCameraMode_ == FC_DIRECTION)
     {
-        startPos += startDir * particle.size_.y_;
+        startPos += startDir * size.y_;
     }
 
     if (!relative_)
@@ -532,10 +643,10 @@ bool ParticleEmitter::EmitNewParticle()
         startDir = node_->GetWorldRotation() * startDir;
     };
 
-    particle.velocity_ = effect_->GetRandomVelocity() * startDir;
+    particles_.velocity_[index] = effect_->GetRandomVelocity() * startDir;
 
     billboard.position_ = startPos;
-    billboard.size_ = particles_[index].size_;
+    billboard.size_ = size;
     const ea::vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
     billboard.uv_ = textureFrames_.size() ? textureFrames_[0].uv_ : Rect::POSITIVE;
     billboard.rotation_ = effect_->GetRandomRotation();
@@ -543,13 +654,11 @@ bool ParticleEmitter::EmitNewParticle()
     billboard.color_ = colorFrames_.size() ? colorFrames_[0].color_ : Color();
     billboard.enabled_ = true;
     billboard.direction_ = startDir;
-
-    return true;
 }
 
-unsigned ParticleEmitter::GetFreeParticle() const
+unsigned ParticleEmitter::GetFreeParticle(unsigned startIndex) const
 {
-    for (unsigned i = 0; i < billboards_.size(); ++i)
+    for (unsigned i = startIndex; i < billboards_.size(); ++i)
     {
         if (!billboards_[i].enabled_)
             return i;
@@ -572,12 +681,65 @@ bool ParticleEmitter::CheckActiveParticles() const
     return false;
 }
 
-void ParticleEmitter::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+bool ParticleEmitter::UpdateParticles()
 {
-    // Store scene's timestep and use it instead of global timestep, as time scale may be other than 1
-    using namespace ScenePostUpdate;
+    ParticleUpdateParams params;
+    params.timeStep_ = lastTimeStep_;
+    params.constantForce_ = effect_->GetConstantForce();
+    if (relative_)
+        params.constantForce_ = node_->GetWorldRotation().Inverse() * params.constantForce_;
+    params.dampingForce_ = effect_->GetDampingForce();
+    // If billboards are not relative, apply scaling to the position update
+    params.scaleVector_ = scaled_ && !relative_ ? node_->GetWorldScale() : Vector3::ONE;
+    params.sizeAdd_ = effect_->GetSizeAdd();
+    params.sizeMul_ = effect_->GetSizeMul();
+    params.colorFrames_ = &effect_->GetColorFrames();
+    params.textureFrames_ = &effect_->GetTextureFrames();
+
+    // Split big emitters between worker threads. Work queue may be used only from main thread.
+    const unsigned numParticles = particles_.Size();
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numTasks = queue && Thread::IsMainThread() && !queue->IsCompleting()
+        ? Min(queue->GetNumThreads() + 1, numParticles / MIN_PARTICLES_PER_TASK) : 1;
+
+    if (numTasks <= 1)
+        return UpdateParticleRange(particles_, billboards_.data(), params, 0, numParticles);
+
+    URHO3D_PROFILE("UpdateParticlesThreaded");
+
+    std::atomic<bool> hasActiveParticles{};
+    const unsigned particlesPerTask = (numParticles + numTasks - 1) / numTasks;
+    for (unsigned begin = 0; begin < numParticles; begin += particlesPerTask)
+    {
+        const unsigned end = Min(begin + particlesPerTask, numParticles);
+        queue->AddWorkItem([=, &params, &hasActiveParticles]()
+        {
+            if (UpdateParticleRange(particles_, billboards_.data(), params, begin, end))
+                hasActiveParticles = true;
+        }, M_MAX_UNSIGNED);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+
+    return hasActiveParticles;
+}
 
-    lastTimeStep_ = eventData[P_TIMESTEP].GetFloat();
+void ParticleEmitter::UpdateEventSubscription(Scene* scene)
+{
+    Scene* newScene = scene && IsEnabledEffective() ? scene : nullptr;
+    if (newScene == subscribedScene_)
+        return;
+
+    if (subscribedScene_)
+        subscribedScene_->scenePostUpdateEvent_.Unsubscribe(this);
+    if (newScene)
+        newScene->scenePostUpdateEvent_.Subscribe(this, &ParticleEmitter::HandleScenePostUpdate);
+    subscribedScene_ = newScene;
+}
+
+void ParticleEmitter::HandleScenePostUpdate(SceneUpdateArgs& args)
+{
+    // Store scene's timestep and use it instead of global timestep, as time scale may be other than 1
+    lastTimeStep_ = args.timeStep_;
 
     // If no invisible update, check that the billboardset is in view (framenumber has changed)
     if ((effect_ && effect_->GetUpdateInvisible()) || viewFrameNumber_ != lastUpdateFrameNumber_)
@@ -28,8 +28,9 @@ namespace Urho3D
 {
 
 class ParticleEffect;
+struct SceneUpdateArgs;
 
-/// One particle in the particle system.
+/// One particle in the particle system. The emitter stores its particles in ParticleData instead.
 struct Particle
 {
     /// Velocity.
@@ -50,6 +51,32 @@ struct Particle
     unsigned texIndex_;
 };
 
+/// Particles of the particle system stored as structure of arrays.
+struct URHO3D_API ParticleData
+{
+    /// Resize all arrays.
+    void Resize(unsigned size);
+    /// Return number of particles.
+    unsigned Size() const { return timer_.size(); }
+
+    /// Velocities.
+    ea::vector<Vector3> velocity_;
+    /// Original billboard sizes.
+    ea::vector<Vector2> size_;
+    /// Times elapsed from creation.
+    ea::vector<float> timer_;
+    /// Lifetimes.
+    ea::vector<float> timeToLive_;
+    /// Size scaling values.
+    ea::vector<float> scale_;
+    /// Rotation speeds.
+    ea::vector<float> rotationSpeed_;
+    /// Current color animation indices.
+    ea::vector<unsigned> colorIndex_;
+    /// Current texture animation indices.
+    ea::vector<unsigned> texIndex_;
+};
+
 /// %Particle emitter component.
 class URHO3D_API ParticleEmitter : public BillboardSet
 {
@@ -98,7 +125,7 @@ public:
 
     /// Return maximum number of particles.
     /// @property
-    unsigned GetNumParticles() const { return particles_.size(); }
+    unsigned GetNumParticles() const { return particles_.Size(); }
 
     /// Return whether is currently emitting.
     /// @property
@@ -129,21 +156,29 @@ protected:
 
     /// Create a new particle. Return true if there was room.
     bool EmitNewParticle();
-    /// Return a free particle index.
-    unsigned GetFreeParticle() const;
+    /// Create a new particle at given free index.
+    void EmitNewParticle(unsigned index);
+    /// Return a free particle index starting from given index.
+    unsigned GetFreeParticle(unsigned startIndex = 0) const;
     /// Return whether has active particles.
     bool CheckActiveParticles() const;
 
 private:
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Update existing particles, split between worker threads if called from main thread. Return whether any particle is active.
+    bool UpdateParticles();
+    /// Subscribe to or unsubscribe from scene post-update depending on the scene and enabled state.
+    void UpdateEventSubscription(Scene* scene);
+    /// Handle scene post-update.
+    void HandleScenePostUpdate(SceneUpdateArgs& args);
     /// Handle live reload of the particle effect.
     void HandleEffectReloadFinished(StringHash eventType, VariantMap& eventData);
 
+    /// Scene whose post-update is subscribed to.
+    WeakPtr<Scene> subscribedScene_;
     /// Particle effect.
     SharedPtr<ParticleEffect> effect_;
     /// Particles.
-    ea::vector<Particle> particles_;
+    ParticleData particles_;
     /// Active/inactive period timer.
     float periodTimer_;
     /// New particle emission timer.
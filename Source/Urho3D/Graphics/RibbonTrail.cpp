@@ -42,6 +42,7 @@ namespace Urho3D
 
 extern const char* GEOMETRY_CATEGORY;
 static const unsigned MAX_TAIL_COLUMN = 16;
+static const unsigned MIN_BUFFER_CAPACITY = 16;
 
 const char* trailTypeNames[] =
 {
@@ -55,6 +56,31 @@ inline bool CompareTails(const TrailPoint* lhs, const TrailPoint* rhs)
     return lhs->sortDistance_ > rhs->sortDistance_;
 }
 
+/// Write indices for given number of trail segments.
+template <class T>
+void WriteTrailIndices(T* dest, unsigned numSegments, unsigned tailColumn)
+{
+    unsigned vertexIndex = 0;
+    while (numSegments--)
+    {
+        for (unsigned i = 0; i < tailColumn; ++i)
+        {
+            dest[0] = static_cast<T>(vertexIndex);
+            dest[1] = static_cast<T>(vertexIndex + 2);
+            dest[2] = static_cast<T>(vertexIndex + 1);
+
+            dest[3] = static_cast<T>(vertexIndex + 1);
+            dest[4] = static_cast<T>(vertexIndex + 2);
+            dest[5] = static_cast<T>(vertexIndex + 3);
+
+            dest += 6;
+            vertexIndex += 2;
+        }
+
+        vertexIndex += 2;
+    }
+}
+
 TrailPoint::TrailPoint(const Vector3& position, const Vector3& forward) :
     position_{position},
     forward_{forward}
@@ -73,6 +99,7 @@ RibbonTrail::RibbonTrail(Context* context) :
     bufferDirty_(true),
     previousPosition_(Vector3::ZERO),
     numPoints_(0),
+    bufferCapacity_(0),
     lifetime_(1.0f),
     vertexDistance_(0.1f),
     width_(0.2f),
@@ -141,7 +168,7 @@ void RibbonTrail::ProcessRayQuery(const RayOctreeQuery& query, ea::vector<RayQue
         return;
 
     // Approximate the tails as spheres for raycasting
-    for (unsigned i = 0; i < points_.size() - 1; ++i)
+    for (unsigned i = 0; i + 1 < points_.size(); ++i)
     {
         Vector3 center = (points_[i].position_ + points_[i+1].position_) * 0.5f;
         Vector3 scale = width_ * Vector3::ONE;
@@ -191,7 +218,7 @@ void RibbonTrail::HandleScenePostUpdate(StringHash eventType, VariantMap& eventD
         if (points_.size() < 3 && viewFrameNumber_ - lastUpdateFrameNumber_ > 1)
         {
             previousPosition_ = node_->GetWorldPosition();
-            points_.erase_at(0, points_.size());
+            points_.clear();
         }
 
         lastUpdateFrameNumber_ = viewFrameNumber_;
@@ -243,7 +270,8 @@ void RibbonTrail::UpdateTail(float timeStep)
     // Delete expired points
     if (expiredIndex != -1)
     {
-        points_.erase(points_.begin(), points_.begin() + (unsigned) (expiredIndex + 1));
+        for (int i = 0; i <= expiredIndex; ++i)
+            points_.pop_front();
 
         // Update endTail pointer
         if (points_.size() > 1)
@@ -286,8 +314,8 @@ void RibbonTrail::UpdateTail(float timeStep)
             nextPoint.parentPos_ = node_->GetParent()->GetWorldPosition();
         }
 
-        points_.push_back(startPoint);
-        points_.push_back(nextPoint);
+        AddPoint(startPoint);
+        AddPoint(nextPoint);
 
         // Update endTail
         endTail_.position_ = startPoint.position_;
@@ -306,7 +334,7 @@ void RibbonTrail::UpdateTail(float timeStep)
             if (node_->GetParent() != nullptr)
                 newPoint.parentPos_ = node_->GetParent()->GetWorldPosition();
 
-            points_.push_back(newPoint);
+            AddPoint(newPoint);
 
             previousPosition_ = worldPosition;
         }
@@ -324,6 +352,15 @@ void RibbonTrail::UpdateTail(float timeStep)
         bufferSizeDirty_ = true;
 }
 
+void RibbonTrail::AddPoint(const TrailPoint& point)
+{
+    // Ring buffer overwrites the oldest point when full, grow it instead
+    if (points_.full())
+        points_.set_capacity(Max(points_.capacity() * 2, MIN_BUFFER_CAPACITY));
+
+    points_.push_back(point);
+}
+
 void RibbonTrail::SetEndScale(float endScale)
 {
     endScale_ = endScale;
@@ -467,56 +504,30 @@ void RibbonTrail::UpdateBufferSize()
     bufferDirty_ = true;
     forceUpdate_ = true;
 
-    if (numPoints_ < 2)
-    {
-        indexBuffer_->SetSize(0, false);
-        vertexBuffer_->SetSize(0, mask, true);
-        return;
-    }
-    else
-    {
-        indexBuffer_->SetSize(((numPoints_ - 1) * indexPerSegment), false);
-        vertexBuffer_->SetSize(numPoints_ * vertexPerSegment, mask, true);
-    }
+    // Grow buffers geometrically and shrink them only when the trail becomes much shorter,
+    // so buffers are not reallocated each time a point is added or retired
+    if (numPoints_ > bufferCapacity_ || numPoints_ * 4 < bufferCapacity_)
+        bufferCapacity_ = Max(NextPowerOfTwo(numPoints_), MIN_BUFFER_CAPACITY);
 
-    // Indices do not change for a given tail generator capacity
-    auto* dest = (unsigned short*)indexBuffer_->Lock(0, ((numPoints_ - 1) * indexPerSegment), true);
-    if (!dest)
+    const unsigned vertexCount = bufferCapacity_ * vertexPerSegment;
+    const unsigned indexCount = (bufferCapacity_ - 1) * indexPerSegment;
+    const bool largeIndices = vertexCount >= 65536;
+    if (vertexBuffer_->GetVertexCount() == vertexCount && vertexBuffer_->GetElementMask() == mask
+        && indexBuffer_->GetIndexCount() == indexCount && !indexBuffer_->IsDataLost())
         return;
 
-    unsigned vertexIndex = 0;
-    unsigned stripsLen = numPoints_ - 1;
-
-    while (stripsLen--)
-    {
-        dest[0] = (unsigned short)vertexIndex;
-        dest[1] = (unsigned short)(vertexIndex + 2);
-        dest[2] = (unsigned short)(vertexIndex + 1);
-
-        dest[3] = (unsigned short)(vertexIndex + 1);
-        dest[4] = (unsigned short)(vertexIndex + 2);
-        dest[5] = (unsigned short)(vertexIndex + 3);
-
-        dest += 6;
-        vertexIndex += 2;
-
-        for (unsigned i = 0; i < (tailColumn_ - 1); ++i)
-        {
-            dest[0] = (unsigned short)vertexIndex;
-            dest[1] = (unsigned short)(vertexIndex + 2);
-            dest[2] = (unsigned short)(vertexIndex + 1);
-
-            dest[3] = (unsigned short)(vertexIndex + 1);
-            dest[4] = (unsigned short)(vertexIndex + 2);
-            dest[5] = (unsigned short)(vertexIndex + 3);
+    vertexBuffer_->SetSize(vertexCount, mask, true);
+    indexBuffer_->SetSize(indexCount, largeIndices);
 
-            dest += 6;
-            vertexIndex += 2;
-        }
-
-       vertexIndex += 2;
+    // Indices do not change for a given tail generator capacity
+    void* destPtr = indexBuffer_->Lock(0, indexCount, true);
+    if (!destPtr)
+        return;
 
-    }
+    if (largeIndices)
+        WriteTrailIndices(static_cast<unsigned*>(destPtr), bufferCapacity_ - 1, tailColumn_);
+    else
+        WriteTrailIndices(static_cast<unsigned short*>(destPtr), bufferCapacity_ - 1, tailColumn_);
 
     indexBuffer_->Unlock();
     indexBuffer_->ClearDataLost();
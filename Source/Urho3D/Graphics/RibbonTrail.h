@@ -26,6 +26,8 @@
 
 #include "../Graphics/Drawable.h"
 
+#include <EASTL/bonus/ring_buffer.h>
+
 namespace Urho3D
 {
 
@@ -206,8 +208,8 @@ protected:
     void OnWorldBoundingBoxUpdate() override;
     /// Mark vertex buffer to need an update.
     void MarkPositionsDirty();
-    /// Tails.
-    ea::vector<TrailPoint> points_;
+    /// Tails. New points are pushed to the back and expired points are popped from the front.
+    ea::ring_buffer<TrailPoint> points_;
     /// Tails sorted flag.
     bool sorted_;
     /// Animation LOD bias.
@@ -229,6 +231,8 @@ private:
     void UpdateVertexBuffer(const FrameInfo& frame);
     /// Update/Rebuild tail mesh only if position changed (called by UpdateBatches()).
     void UpdateTail(float timeStep);
+    /// Append point to the trail, growing point storage if needed.
+    void AddPoint(const TrailPoint& point);
     /// Geometry.
     SharedPtr<Geometry> geometry_;
     /// Vertex buffer.
@@ -249,6 +253,8 @@ private:
     float width_;
     /// Number of points.
     unsigned numPoints_;
+    /// Number of points vertex and index buffers are allocated for.
+    unsigned bufferCapacity_;
     /// Color for start of trails.
     Color startColor_;
     /// Color for end of trails.
@@ -23,6 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/IndexBuffer.h"
@@ -39,6 +41,67 @@ namespace Urho3D
 namespace
 {
 
+/// Min number of vertices processed by single skinning task.
+const unsigned MinVerticesPerSkinningTask = 2048;
+
+/// Input and output of skinning kernel for vertex range.
+struct SkinningTaskData
+{
+    /// Vertex buffer data.
+    unsigned char* vertexData_{};
+    /// Vertex size.
+    unsigned vertexSize_{};
+    /// Normal offset within vertex.
+    unsigned normalOffset_{};
+    /// Tangent offset within vertex.
+    unsigned tangentOffset_{};
+    /// Blend indices.
+    const unsigned char* blendIndices_{};
+    /// Blend weights.
+    const float* blendWeights_{};
+    /// Bone transforms.
+    const Matrix3x4* worldTransforms_{};
+};
+
+/// Skinning kernel function.
+using SkinningKernel = void(*)(const SkinningTaskData& data, unsigned beginVertex, unsigned endVertex);
+
+#ifdef URHO3D_SSE
+/// Blend bone matrices into three rows of skinning matrix.
+template <unsigned NumBones>
+inline void BlendSkinMatrix(__m128 rows[3], const Matrix3x4* worldTransforms,
+    const unsigned char* indices, const float* weights)
+{
+    const Matrix3x4& firstMatrix = worldTransforms[indices[0]];
+    const __m128 firstWeight = _mm_set1_ps(weights[0]);
+    rows[0] = _mm_mul_ps(_mm_loadu_ps(&firstMatrix.m00_), firstWeight);
+    rows[1] = _mm_mul_ps(_mm_loadu_ps(&firstMatrix.m10_), firstWeight);
+    rows[2] = _mm_mul_ps(_mm_loadu_ps(&firstMatrix.m20_), firstWeight);
+
+    for (unsigned boneIndex = 1; boneIndex < NumBones; ++boneIndex)
+    {
+        const Matrix3x4& matrix = worldTransforms[indices[boneIndex]];
+        const __m128 weight = _mm_set1_ps(weights[boneIndex]);
+        rows[0] = _mm_add_ps(rows[0], _mm_mul_ps(_mm_loadu_ps(&matrix.m00_), weight));
+        rows[1] = _mm_add_ps(rows[1], _mm_mul_ps(_mm_loadu_ps(&matrix.m10_), weight));
+        rows[2] = _mm_add_ps(rows[2], _mm_mul_ps(_mm_loadu_ps(&matrix.m20_), weight));
+    }
+}
+
+/// Transform Vector3 in-place. W is 1 for positions and 0 for directions.
+inline void TransformVector3(const __m128 rows[3], float* data, float w)
+{
+    const __m128 vec = _mm_set_ps(w, data[2], data[1], data[0]);
+    __m128 x = _mm_mul_ps(rows[0], vec);
+    __m128 y = _mm_mul_ps(rows[1], vec);
+    __m128 z = _mm_mul_ps(rows[2], vec);
+    __m128 unused = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, unused);
+    const __m128 result = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, unused));
+    _mm_storel_pi(reinterpret_cast<__m64*>(data), result);
+    _mm_store_ss(data + 2, _mm_movehl_ps(result, result));
+}
+#else
 Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
 {
     return {
@@ -47,6 +110,87 @@ Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
         m.m20_ * v.x_ + m.m21_ * v.y_ + m.m22_ * v.z_
     };
 }
+#endif
+
+/// Apply skinning to vertex range.
+template <bool SkinNormals, bool SkinTangents, unsigned NumBones>
+void SkinVertices(const SkinningTaskData& data, unsigned beginVertex, unsigned endVertex)
+{
+    const unsigned vertexSize = data.vertexSize_;
+    unsigned char* positionsData = data.vertexData_ + beginVertex * vertexSize;
+    unsigned char* normalsData = positionsData + data.normalOffset_;
+    unsigned char* tangentsData = positionsData + data.tangentOffset_;
+
+    const unsigned char* indicesData = data.blendIndices_ + beginVertex * NumBones;
+    const float* weightsData = data.blendWeights_ + beginVertex * NumBones;
+
+    for (unsigned vertexIndex = beginVertex; vertexIndex < endVertex; ++vertexIndex)
+    {
+#ifdef URHO3D_SSE
+        __m128 rows[3];
+        BlendSkinMatrix<NumBones>(rows, data.worldTransforms_, indicesData, weightsData);
+
+        TransformVector3(rows, reinterpret_cast<float*>(positionsData), 1.0f);
+        if (SkinNormals)
+            TransformVector3(rows, reinterpret_cast<float*>(normalsData), 0.0f);
+        if (SkinTangents)
+            TransformVector3(rows, reinterpret_cast<float*>(tangentsData), 0.0f);
+#else
+        Matrix3x4 matrix = data.worldTransforms_[indicesData[0]] * weightsData[0];
+        for (unsigned boneIndex = 1; boneIndex < NumBones; ++boneIndex)
+            matrix = matrix + data.worldTransforms_[indicesData[boneIndex]] * weightsData[boneIndex];
+
+        Vector3& position = *reinterpret_cast<Vector3*>(positionsData);
+        position = matrix * position;
+
+        if (SkinNormals)
+        {
+            Vector3& normal = *reinterpret_cast<Vector3*>(normalsData);
+            normal = TransformNormal(matrix, normal);
+        }
+
+        if (SkinTangents)
+        {
+            Vector3& tangent = *reinterpret_cast<Vector3*>(tangentsData);
+            tangent = TransformNormal(matrix, tangent);
+        }
+#endif
+
+        // Advance
+        indicesData += NumBones;
+        weightsData += NumBones;
+
+        positionsData += vertexSize;
+        normalsData += vertexSize;
+        tangentsData += vertexSize;
+    }
+}
+
+/// Return skinning kernel for given number of bones.
+template <bool SkinNormals, bool SkinTangents>
+SkinningKernel GetSkinningKernel(unsigned numBones)
+{
+    switch (numBones)
+    {
+    case 1: return SkinVertices<SkinNormals, SkinTangents, 1>;
+    case 2: return SkinVertices<SkinNormals, SkinTangents, 2>;
+    case 3: return SkinVertices<SkinNormals, SkinTangents, 3>;
+    default: return SkinVertices<SkinNormals, SkinTangents, 4>;
+    }
+}
+
+/// Return skinning kernel for given vertex layout and number of bones.
+SkinningKernel GetSkinningKernel(bool skinNormals, bool skinTangents, unsigned numBones)
+{
+    if (!skinNormals && !skinTangents)
+        return GetSkinningKernel<false, false>(numBones);
+    else if (skinNormals && !skinTangents)
+        return GetSkinningKernel<true, false>(numBones);
+    else if (skinNormals && skinTangents)
+        return GetSkinningKernel<true, true>(numBones);
+    else
+        return GetSkinningKernel<false, true>(numBones); // this is really weird case
+}
 
 }
 
@@ -63,7 +207,7 @@ void SoftwareModelAnimator::Initialize(Model* model, bool skinned, unsigned numB
 {
     originalModel_ = model;
     skinned_ = skinned;
-    numBones_ = numBones;
+    numBones_ = Clamp(numBones, 1u, MaxBones);
     CloneModelGeometries();
     InitializeAnimationData();
 }
@@ -117,68 +261,43 @@ void SoftwareModelAnimator::ApplySkinning(ea::span<const Matrix3x4> worldTransfo
         if (!clonedBuffer || !animationData.hasSkeletalAnimation_)
             continue;
 
-        if (!animationData.skinNormals_ && !animationData.skinTangents_)
-            ApplyVertexBufferSkinning<false, false>(clonedBuffer, animationData, worldTransforms);
-        else if (animationData.skinNormals_ && !animationData.skinTangents_)
-            ApplyVertexBufferSkinning<true, false>(clonedBuffer, animationData, worldTransforms);
-        else if (animationData.skinNormals_ && animationData.skinTangents_)
-            ApplyVertexBufferSkinning<true, true>(clonedBuffer, animationData, worldTransforms);
-        else
-            ApplyVertexBufferSkinning<false, true>(clonedBuffer, animationData, worldTransforms); // this is really weird case
+        ApplyVertexBufferSkinning(clonedBuffer, animationData, worldTransforms);
     }
 }
 
-template <bool SkinNormals, bool SkinTangents>
-void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer, const VertexBufferAnimationData& animationData,
-    ea::span<const Matrix3x4> worldTransforms) const
+void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer,
+    const VertexBufferAnimationData& animationData, ea::span<const Matrix3x4> worldTransforms) const
 {
-    const unsigned clonedVertexSize = clonedBuffer->GetVertexSize();
-    const unsigned normalOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR3, SEM_NORMAL);
-    const unsigned tangentOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR4, SEM_TANGENT);
-
-    unsigned char* clonedBufferData = clonedBuffer->GetShadowData();
-
-    unsigned char* positionsData = clonedBufferData;
-    unsigned char* normalsData = SkinNormals ? clonedBufferData + normalOffset : nullptr;
-    unsigned char* tangentsData = SkinTangents ? clonedBufferData + tangentOffset : nullptr;
-
-    const unsigned char* indicesData = animationData.blendIndices_.data();
-    const float* weightsData = animationData.blendWeights_.data();
-
+    SkinningTaskData data;
+    data.vertexData_ = clonedBuffer->GetShadowData();
+    data.vertexSize_ = clonedBuffer->GetVertexSize();
+    data.normalOffset_ = animationData.skinNormals_ ? clonedBuffer->GetElementOffset(TYPE_VECTOR3, SEM_NORMAL) : 0;
+    data.tangentOffset_ = animationData.skinTangents_ ? clonedBuffer->GetElementOffset(TYPE_VECTOR4, SEM_TANGENT) : 0;
+    data.blendIndices_ = animationData.blendIndices_.data();
+    data.blendWeights_ = animationData.blendWeights_.data();
+    data.worldTransforms_ = worldTransforms.data();
+
+    const SkinningKernel kernel = GetSkinningKernel(animationData.skinNormals_, animationData.skinTangents_, numBones_);
     const unsigned numVertices = clonedBuffer->GetVertexCount();
-    Matrix3x4 matrix;
-    for (unsigned vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
-    {
-        matrix = worldTransforms[indicesData[0]] * weightsData[0];
-        for (unsigned boneIndex = 1; boneIndex < numBones_; ++boneIndex)
-            matrix = matrix + worldTransforms[indicesData[boneIndex]] * weightsData[boneIndex];
 
-        Vector3& position = *reinterpret_cast<Vector3*>(positionsData);
-        position = matrix * position;
+    // Split big buffers between worker threads. Work queue may be used only from main thread.
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numTasks = queue && Thread::IsMainThread() && !queue->IsCompleting()
+        ? Min(queue->GetNumThreads() + 1, numVertices / MinVerticesPerSkinningTask) : 1;
 
-        if (SkinNormals)
-        {
-            Vector3& normal = *reinterpret_cast<Vector3*>(normalsData);
-            normal = TransformNormal(matrix, normal);
-        }
-
-        if (SkinTangents)
-        {
-            Vector3& tangent = *reinterpret_cast<Vector3*>(tangentsData);
-            tangent = TransformNormal(matrix, tangent);
-        }
-
-        // Advance
-        indicesData += numBones_;
-        weightsData += numBones_;
-
-        positionsData += clonedVertexSize;
-        if (SkinNormals)
-            normalsData += clonedVertexSize;
-        if (SkinTangents)
-            tangentsData += clonedVertexSize;
+    if (numTasks <= 1)
+    {
+        kernel(data, 0, numVertices);
+        return;
     }
 
+    const unsigned verticesPerTask = (numVertices + numTasks - 1) / numTasks;
+    for (unsigned beginVertex = 0; beginVertex < numVertices; beginVertex += verticesPerTask)
+    {
+        const unsigned endVertex = Min(beginVertex + verticesPerTask, numVertices);
+        queue->AddWorkItem([=, &data]() { kernel(data, beginVertex, endVertex); }, M_MAX_UNSIGNED);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
 }
 
 void SoftwareModelAnimator::Commit()
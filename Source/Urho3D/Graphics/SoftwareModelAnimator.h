@@ -91,8 +91,7 @@ private:
         VertexBuffer* destBuffer, VertexBuffer* srcBuffer) const;
     /// Apply a vertex buffer morph.
     void ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight);
-    /// Apply skinning for given vertex buffer.
-    template <bool SkinNormals, bool SkinTangents>
+    /// Apply skinning for given vertex buffer. Big buffers are processed in worker threads if called from main thread.
     void ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer, const VertexBufferAnimationData& animationData,
         ea::span<const Matrix3x4> worldTransforms) const;
 
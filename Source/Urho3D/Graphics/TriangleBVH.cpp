@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Graphics/TriangleBVH.h"
+#include "../Math/Frustum.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned MAX_TRIANGLES_PER_LEAF = 8;
+
+void TriangleBVH::Build(const unsigned char* vertexData, unsigned vertexSize, const unsigned char* indexData, unsigned indexSize,
+    unsigned start, unsigned count)
+{
+    nodes_.clear();
+    indices_.clear();
+
+    const unsigned numTriangles = count / 3;
+    if (!vertexData || !numTriangles)
+        return;
+
+    // Gather vertex indices of the triangles
+    ea::vector<unsigned> triangleIndices(numTriangles * 3);
+    for (unsigned i = 0; i < numTriangles * 3; ++i)
+    {
+        if (!indexData)
+            triangleIndices[i] = start + i;
+        else if (indexSize == sizeof(unsigned short))
+            triangleIndices[i] = reinterpret_cast<const unsigned short*>(indexData)[start + i];
+        else
+            triangleIndices[i] = reinterpret_cast<const unsigned*>(indexData)[start + i];
+    }
+
+    // Calculate triangle bounds and centers used for splitting
+    ea::vector<BoundingBox> boxes(numTriangles);
+    ea::vector<Vector3> centers(numTriangles);
+    ea::vector<unsigned> order(numTriangles);
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        BoundingBox& box = boxes[i];
+        for (unsigned j = 0; j < 3; ++j)
+            box.Merge(*reinterpret_cast<const Vector3*>(&vertexData[triangleIndices[i * 3 + j] * vertexSize]));
+        centers[i] = box.Center();
+        order[i] = i;
+    }
+
+    nodes_.reserve(2 * numTriangles / MAX_TRIANGLES_PER_LEAF + 1);
+    BuildNode(order, boxes, centers, 0, numTriangles);
+
+    // Store triangles in node order so that each node refers to a contiguous range
+    indices_.resize(numTriangles * 3);
+    for (unsigned i = 0; i < numTriangles; ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+            indices_[i * 3 + j] = triangleIndices[order[i] * 3 + j];
+    }
+}
+
+void TriangleBVH::GetTriangles(ea::vector<unsigned>& result, const Frustum& frustum) const
+{
+    if (nodes_.empty())
+        return;
+
+    unsigned stack[64];
+    unsigned stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize)
+    {
+        const Node& node = nodes_[stack[--stackSize]];
+
+        const Intersection intersection = frustum.IsInside(node.boundingBox_);
+        if (intersection == OUTSIDE)
+            continue;
+
+        // Fully inside or intersecting leaf: take the whole range without descending further
+        if (intersection == INSIDE || !node.right_)
+        {
+            const unsigned* begin = &indices_[node.first_ * 3];
+            result.insert(result.end(), begin, begin + node.count_ * 3);
+            continue;
+        }
+
+        const unsigned nodeIndex = static_cast<unsigned>(&node - nodes_.data());
+        stack[stackSize++] = node.right_;
+        stack[stackSize++] = nodeIndex + 1;
+    }
+}
+
+unsigned TriangleBVH::BuildNode(ea::vector<unsigned>& order, const ea::vector<BoundingBox>& boxes,
+    const ea::vector<Vector3>& centers, unsigned first, unsigned count)
+{
+    const unsigned nodeIndex = nodes_.size();
+    nodes_.emplace_back();
+
+    BoundingBox boundingBox;
+    BoundingBox centerBox;
+    for (unsigned i = first; i < first + count; ++i)
+    {
+        boundingBox.Merge(boxes[order[i]]);
+        centerBox.Merge(centers[order[i]]);
+    }
+
+    nodes_[nodeIndex].boundingBox_ = boundingBox;
+    nodes_[nodeIndex].first_ = first;
+    nodes_[nodeIndex].count_ = count;
+
+    // Split at the median along the longest axis of triangle centers, unless the centers coincide
+    const Vector3 extent = centerBox.Size();
+    const unsigned axis = extent.x_ >= extent.y_ && extent.x_ >= extent.z_ ? 0 : (extent.y_ >= extent.z_ ? 1 : 2);
+    if (count <= MAX_TRIANGLES_PER_LEAF || extent.Data()[axis] <= M_EPSILON)
+        return nodeIndex;
+
+    const unsigned half = count / 2;
+    unsigned* begin = order.data() + first;
+    ea::nth_element(begin, begin + half, begin + count,
+        [&](unsigned lhs, unsigned rhs) { return centers[lhs].Data()[axis] < centers[rhs].Data()[axis]; });
+
+    BuildNode(order, boxes, centers, first, half);
+    const unsigned right = BuildNode(order, boxes, centers, first + half, count - half);
+    nodes_[nodeIndex].right_ = right;
+    return nodeIndex;
+}
+
+}
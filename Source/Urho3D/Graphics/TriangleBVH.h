@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Math/BoundingBox.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Frustum;
+
+/// Bounding volume hierarchy over the triangles of a triangle list, used to accelerate CPU-side geometry queries.
+class URHO3D_API TriangleBVH : public RefCounted
+{
+public:
+    /// Construct empty.
+    TriangleBVH() = default;
+
+    /// Build from vertex positions stored at the start of each vertex and optional 16- or 32-bit indices. Null index data means non-indexed geometry, in which case start and count refer to vertices instead of indices.
+    void Build(const unsigned char* vertexData, unsigned vertexSize, const unsigned char* indexData, unsigned indexSize,
+        unsigned start, unsigned count);
+    /// Append vertex indices (three per triangle) of the triangles that may intersect the frustum.
+    void GetTriangles(ea::vector<unsigned>& result, const Frustum& frustum) const;
+
+    /// Return number of triangles.
+    unsigned GetNumTriangles() const { return indices_.size() / 3; }
+    /// Return bounding box of all triangles.
+    BoundingBox GetBoundingBox() const { return nodes_.empty() ? BoundingBox() : nodes_[0].boundingBox_; }
+
+private:
+    /// Hierarchy node. Each node covers a contiguous range of triangles. The left child immediately follows its parent.
+    struct Node
+    {
+        /// Bounding box of the triangles.
+        BoundingBox boundingBox_;
+        /// First triangle.
+        unsigned first_{};
+        /// Number of triangles.
+        unsigned count_{};
+        /// Index of the right child, or 0 for leaf nodes.
+        unsigned right_{};
+    };
+
+    /// Build node for a range of triangles and its children recursively. Return node index.
+    unsigned BuildNode(ea::vector<unsigned>& order, const ea::vector<BoundingBox>& boxes, const ea::vector<Vector3>& centers,
+        unsigned first, unsigned count);
+
+    /// Nodes, root first.
+    ea::vector<Node> nodes_;
+    /// Vertex indices of the triangles, ordered by node.
+    ea::vector<unsigned> indices_;
+};
+
+}
@@ -143,6 +143,7 @@ void VertexBuffer::SetShadowed(bool enable)
             shadowData_.reset();
 
         shadowed_ = enable;
+        ++dataRevision_;
     }
 }
 
@@ -165,6 +166,7 @@ bool VertexBuffer::SetSize(unsigned vertexCount, const ea::vector<VertexElement>
         shadowData_ = new unsigned char[vertexCount_ * vertexSize_];
     else
         shadowData_.reset();
+    ++dataRevision_;
 
     return Create();
 }
@@ -122,6 +122,9 @@ public:
     /// Return shared array pointer to the CPU memory shadow data.
     ea::shared_array<unsigned char> GetShadowDataShared() const { return shadowData_; }
 
+    /// Return data revision. Incremented whenever the buffer data, size or shadowing changes.
+    unsigned GetDataRevision() const { return dataRevision_; }
+
     /// Return buffer hash for building vertex declarations. Used internally.
     unsigned long long GetBufferHash(unsigned streamIndex) { return elementHash_ << (streamIndex * 16); }
 
@@ -199,6 +202,8 @@ private:
     bool shadowed_{};
     /// Discard lock flag. Used by OpenGL only.
     bool discardLock_{};
+    /// Data revision.
+    unsigned dataRevision_{};
 };
 
 }
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Largest absolute value of the three smallest components of a unit quaternion.
+const float QUATERNION_COMPONENT_RANGE = 0.70710678f;
+
+unsigned GetMaxQuantizedValue(unsigned numBits)
+{
+    return numBits >= 32 ? M_MAX_UNSIGNED : (1u << numBits) - 1;
+}
+
+}
+
+void BitStreamWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    assert(numBits <= 32);
+    if (numBits < 32)
+        value &= (1u << numBits) - 1;
+
+    pending_ |= static_cast<unsigned long long>(value) << numPending_;
+    numPending_ += numBits;
+
+    while (numPending_ >= 8)
+    {
+        dest_.WriteUByte(static_cast<unsigned char>(pending_ & 0xffu));
+        pending_ >>= 8u;
+        numPending_ -= 8;
+    }
+}
+
+void BitStreamWriter::WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits)
+{
+    const unsigned maxQuantized = GetMaxQuantizedValue(numBits);
+    const float range = maxValue - minValue;
+    const float normalized = range > 0.0f ? Clamp((value - minValue) / range, 0.0f, 1.0f) : 0.0f;
+    WriteBits(static_cast<unsigned>(Round(normalized * static_cast<double>(maxQuantized))), numBits);
+}
+
+void BitStreamWriter::WriteQuaternion(const Quaternion& value, unsigned numBitsPerComponent)
+{
+    const Quaternion norm = value.Normalized();
+    const float components[4] = { norm.w_, norm.x_, norm.y_, norm.z_ };
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+
+    // q and -q are the same rotation: flip the sign so that the omitted component is positive
+    const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+    WriteBits(largest, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+            WriteQuantizedFloat(components[i] * sign, -QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, numBitsPerComponent);
+    }
+}
+
+void BitStreamWriter::Flush()
+{
+    if (numPending_)
+    {
+        dest_.WriteUByte(static_cast<unsigned char>(pending_ & 0xffu));
+        pending_ = 0;
+        numPending_ = 0;
+    }
+}
+
+unsigned BitStreamReader::ReadBits(unsigned numBits)
+{
+    assert(numBits <= 32);
+    while (numPending_ < numBits)
+    {
+        pending_ |= static_cast<unsigned long long>(source_.ReadUByte()) << numPending_;
+        numPending_ += 8;
+    }
+
+    const unsigned value = static_cast<unsigned>(pending_ & GetMaxQuantizedValue(numBits));
+    pending_ >>= numBits;
+    numPending_ -= numBits;
+    return value;
+}
+
+float BitStreamReader::ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits)
+{
+    const unsigned maxQuantized = GetMaxQuantizedValue(numBits);
+    const double normalized = maxQuantized ? static_cast<double>(ReadBits(numBits)) / maxQuantized : 0.0;
+    return static_cast<float>(minValue + (maxValue - minValue) * normalized);
+}
+
+Quaternion BitStreamReader::ReadQuaternion(unsigned numBitsPerComponent)
+{
+    const unsigned largest = ReadBits(2);
+
+    float components[4];
+    float sumSquares = 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        components[i] = ReadQuantizedFloat(-QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, numBitsPerComponent);
+        sumSquares += components[i] * components[i];
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    return Quaternion(components[0], components[1], components[2], components[3]).Normalized();
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Math/Quaternion.h"
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Writes values of arbitrary bit width to a serializer. Bits are packed least significant first; Flush() pads the last byte.
+class URHO3D_API BitStreamWriter
+{
+public:
+    /// Construct.
+    explicit BitStreamWriter(Serializer& dest) : dest_(dest) { }
+    /// Destruct. Flushes pending bits.
+    ~BitStreamWriter() { Flush(); }
+
+    /// Write the lowest bits of value. At most 32 bits at a time.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write float quantized to the given range with given number of bits. Values outside the range are clamped.
+    void WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits);
+    /// Write rotation in smallest-three form: index of the largest component and the other three quantized with given number of bits each.
+    void WriteQuaternion(const Quaternion& value, unsigned numBitsPerComponent);
+    /// Write pending bits to the serializer, padding to a whole byte.
+    void Flush();
+
+private:
+    /// Destination.
+    Serializer& dest_;
+    /// Pending bits.
+    unsigned long long pending_{};
+    /// Number of pending bits.
+    unsigned numPending_{};
+};
+
+/// Reads values written by BitStreamWriter from a deserializer. Bytes are consumed on demand, so the reader may be discarded after the last value.
+class URHO3D_API BitStreamReader
+{
+public:
+    /// Construct.
+    explicit BitStreamReader(Deserializer& source) : source_(source) { }
+
+    /// Read value of given bit width. At most 32 bits at a time.
+    unsigned ReadBits(unsigned numBits);
+    /// Read float quantized to the given range with given number of bits.
+    float ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits);
+    /// Read rotation written in smallest-three form.
+    Quaternion ReadQuaternion(unsigned numBitsPerComponent);
+
+private:
+    /// Source.
+    Deserializer& source_;
+    /// Pending bits.
+    unsigned long long pending_{};
+    /// Number of pending bits.
+    unsigned numPending_{};
+};
+
+}
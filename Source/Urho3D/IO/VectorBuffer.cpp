@@ -131,6 +131,13 @@ void VectorBuffer::Clear()
     size_ = 0;
 }
 
+void VectorBuffer::Swap(VectorBuffer& other)
+{
+    buffer_.swap(other.buffer_);
+    ea::swap(position_, other.position_);
+    ea::swap(size_, other.size_);
+}
+
 void VectorBuffer::Resize(unsigned size)
 {
     buffer_.resize(size);
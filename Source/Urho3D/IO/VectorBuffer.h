@@ -60,6 +60,8 @@ public:
     void Clear();
     /// Set size.
     void Resize(unsigned size);
+    /// Swap contents with another buffer without copying.
+    void Swap(VectorBuffer& other);
 
     /// Return data.
     const unsigned char* GetData() const { return size_ ? &buffer_[0] : nullptr; }
@@ -640,7 +640,13 @@ void CrowdManager::RemoveAgent(CrowdAgent* agent)
 
 void CrowdManager::OnSceneSet(Scene* scene)
 {
-    // Subscribe to the scene subsystem update, which will trigger the crowd update step, and grab a reference
+    if (subscribedScene_)
+    {
+        subscribedScene_->GetUpdateScheduler().RemoveTasks(this);
+        subscribedScene_ = nullptr;
+    }
+
+    // Add the scene subsystem update task, which will trigger the crowd update step, and grab a reference
     // to the scene's NavigationMesh
     if (scene)
     {
@@ -650,7 +656,15 @@ void CrowdManager::OnSceneSet(Scene* scene)
             return;
         }
 
-        SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(CrowdManager, HandleSceneSubsystemUpdate));
+        // Agent reposition events may run arbitrary user code, so the update is executed on the main thread in order
+        SceneUpdateTaskDesc task;
+        task.name_ = "CrowdManager";
+        task.phase_ = SUP_SUBSYSTEM;
+        task.reads_ = SUR_ALL;
+        task.writes_ = SUR_CROWD | SUR_NODE_TRANSFORMS | SUR_USER_LOGIC;
+        task.function_ = [this](float timeStep) { HandleSceneSubsystemUpdate(timeStep); };
+        scene->GetUpdateScheduler().AddTask(this, task);
+        subscribedScene_ = scene;
 
         // Attempt to auto discover a NavigationMesh component (or its derivative) under the scene node
         if (navigationMeshId_ == 0)
@@ -667,7 +681,6 @@ void CrowdManager::OnSceneSet(Scene* scene)
     }
     else
     {
-        UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
         UnsubscribeFromEvent(E_NAVIGATION_MESH_REBUILT);
         UnsubscribeFromEvent(E_COMPONENTADDED);
         UnsubscribeFromEvent(E_COMPONENTREMOVED);
@@ -693,15 +706,13 @@ const dtQueryFilter* CrowdManager::GetDetourQueryFilter(unsigned queryFilterType
     return crowd_ ? crowd_->getFilter(queryFilterType) : nullptr;
 }
 
-void CrowdManager::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
+void CrowdManager::HandleSceneSubsystemUpdate(float timeStep)
 {
     // Perform update tick as long as the crowd is initialized and the associated navmesh has not been removed
     if (crowd_ && navigationMesh_)
     {
-        using namespace SceneSubsystemUpdate;
-
         if (IsEnabledEffective())
-            Update(eventData[P_TIMESTEP].GetFloat());
+            Update(timeStep);
     }
 }
 
@@ -190,13 +190,15 @@ protected:
     dtCrowd* GetCrowd() const { return crowd_; }
 
 private:
-    /// Handle the scene subsystem update event.
-    void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the scene subsystem update task.
+    void HandleSceneSubsystemUpdate(float timeStep);
     /// Handle navigation mesh changed event. It can be navmesh being rebuilt or being removed from its node.
     void HandleNavMeshChanged(StringHash eventType, VariantMap& eventData);
     /// Handle component added in the scene to check for late addition of the navmesh.
     void HandleComponentAdded(StringHash eventType, VariantMap& eventData);
 
+    /// Scene the subsystem update task is added to.
+    WeakPtr<Scene> subscribedScene_;
     /// Internal Detour crowd object.
     dtCrowd* crowd_{};
     /// Velocity shader.
@@ -1070,11 +1070,24 @@ void DynamicNavigationMesh::ReleaseTileCache()
 
 void DynamicNavigationMesh::OnSceneSet(Scene* scene)
 {
-    // Subscribe to the scene subsystem update, which will trigger the tile cache to update the nav mesh
+    if (subscribedScene_)
+        subscribedScene_->GetUpdateScheduler().RemoveTasks(this);
+
+    // Add the scene subsystem update task, which will trigger the tile cache to update the nav mesh
+    subscribedScene_ = scene;
     if (scene)
-        SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(DynamicNavigationMesh, HandleSceneSubsystemUpdate));
-    else
-        UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+    {
+        // Obstacle changes are queued on the main thread, so updating the tile cache only writes the nav mesh itself.
+        // Rebuilding tiles reads node world transforms of the geometry and off-mesh connections
+        SceneUpdateTaskDesc task;
+        task.name_ = "DynamicNavigationMesh";
+        task.phase_ = SUP_SUBSYSTEM;
+        task.reads_ = SUR_NAVIGATION | SUR_NODE_TRANSFORMS;
+        task.writes_ = SUR_NAVIGATION;
+        task.threadSafe_ = true;
+        task.function_ = [this](float timeStep) { HandleSceneSubsystemUpdate(timeStep); };
+        scene->GetUpdateScheduler().AddTask(this, task);
+    }
 }
 
 void DynamicNavigationMesh::AddObstacle(Obstacle* obstacle, bool silent)
@@ -1152,12 +1165,10 @@ void DynamicNavigationMesh::RemoveObstacle(Obstacle* obstacle, bool silent)
     }
 }
 
-void DynamicNavigationMesh::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
+void DynamicNavigationMesh::HandleSceneSubsystemUpdate(float timeStep)
 {
-    using namespace SceneSubsystemUpdate;
-
     if (tileCache_ && navMesh_ && IsEnabledEffective())
-        tileCache_->update(eventData[P_TIMESTEP].GetFloat(), navMesh_);
+        tileCache_->update(timeStep, navMesh_);
 }
 
 }
@@ -112,7 +112,7 @@ protected:
     /// Subscribe to events when assigned to a scene.
     void OnSceneSet(Scene* scene) override;
     /// Trigger the tile cache to make updates to the nav mesh if necessary.
-    void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneSubsystemUpdate(float timeStep);
 
     /// Used by Obstacle class to add itself to the tile cache, if 'silent' an event will not be raised.
     void AddObstacle(Obstacle* obstacle, bool silent = false);
@@ -154,6 +154,8 @@ private:
     bool drawObstacles_{};
     /// Queue of tiles to be built.
     ea::vector<IntVector2> tileQueue_;
+    /// Scene the subsystem update task is added to.
+    WeakPtr<Scene> subscribedScene_;
 };
 
 }
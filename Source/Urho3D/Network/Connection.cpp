@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
@@ -43,6 +44,8 @@
 #include <slikenet/peerinterface.h>
 #include <slikenet/statistics.h>
 
+#include <LZ4/lz4.h>
+
 #ifdef SendMessage
 #undef SendMessage
 #endif
@@ -57,10 +60,68 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+/// Number of recent server updates from which the least delayed one gives the clock offset.
+static const unsigned CLOCK_SYNC_WINDOW = 32;
+/// Clock offset change in milliseconds above which the clock is reset instead of adjusted gradually.
+static const double CLOCK_RESET_THRESHOLD = 250.0;
+/// Fraction of the clock offset and interpolation delay error corrected per server update.
+static const float CLOCK_ADJUST_RATE = 0.1f;
+/// Number of jitter deviations to add to the interpolation delay.
+static const float INTERPOLATION_JITTER_FACTOR = 3.0f;
+/// Margin in milliseconds kept before the first server time, so that synchronized times are always positive.
+static const unsigned SERVER_TIME_BASE_MARGIN = 1000;
+
+/// Time in seconds of package data that may be sent in a burst after the send rate limit has been idle.
+static const float PACKAGE_SEND_BURST = 0.25f;
+
+/// Guards replication state objects shared by all connections while server updates are built in parallel.
+static Mutex replicationStateMutex;
+
+/// Return checksum of an uncompressed package fragment.
+static unsigned GetFragmentChecksum(const unsigned char* data, unsigned size)
+{
+    unsigned checksum = 0;
+    for (unsigned i = 0; i < size; ++i)
+        checksum = SDBMHash(checksum, data[i]);
+    return checksum;
+}
+
+/// Return file name of a package in the download cache. The checksum is prepended to allow multiple versions.
+static ea::string GetCachedPackageName(const ea::string& packageCacheDir, const PackageDownload& download)
+{
+    return packageCacheDir + ToStringHex(download.checksum_) + "_" + download.name_;
+}
+
+/// Store latest data of a node or component not created yet, prefixed with the server time stamp of the update.
+static void CacheLatestData(ea::vector<unsigned char>& data, MemoryBuffer& msg, unsigned serverTime)
+{
+    const unsigned dataSize = msg.GetSize() - msg.GetPosition();
+    data.resize(sizeof(unsigned) + dataSize);
+    memcpy(data.data(), &serverTime, sizeof(unsigned));
+    if (dataSize)
+        memcpy(data.data() + sizeof(unsigned), msg.GetData() + msg.GetPosition(), dataSize);
+}
+
+static PacketReliability GetPacketReliability(PacketType type)
+{
+    switch (type)
+    {
+    case PT_UNRELIABLE_ORDERED:
+        return PacketReliability::UNRELIABLE_SEQUENCED;
+    case PT_RELIABLE_ORDERED:
+        return PacketReliability::RELIABLE_ORDERED;
+    case PT_RELIABLE_UNORDERED:
+        return PacketReliability::RELIABLE;
+    default:
+        return PacketReliability::UNRELIABLE;
+    }
+}
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
+    fileSize_(0),
     checksum_(0),
+    nextFragment_(0),
     initiated_(false)
 {
 }
@@ -154,6 +215,21 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
     buffer.Write(data, numBytes);
 }
 
+void Connection::SendMessage(const OutgoingMessage& message)
+{
+    SendMessage(message.msgID_, message.reliable_, message.inOrder_, message.data_.GetData(), message.data_.GetSize(),
+        message.contentID_);
+}
+
+void Connection::SendRemoteEvent(OutgoingMessage* message)
+{
+    RemoteEvent queuedEvent;
+    queuedEvent.senderID_ = 0;
+    queuedEvent.inOrder_ = message->inOrder_;
+    queuedEvent.message_ = message;
+    remoteEvents_.push_back(queuedEvent);
+}
+
 void Connection::SendRemoteEvent(StringHash eventType, bool inOrder, const VariantMap& eventData)
 {
     RemoteEvent queuedEvent;
@@ -200,6 +276,9 @@ void Connection::SetScene(Scene* newScene)
 
     scene_ = newScene;
     sceneLoaded_ = false;
+    ResetSnapshots();
+    relevantNodes_.clear();
+    interestManaged_ = false;
     UnsubscribeFromEvent(E_ASYNCLOADFINISHED);
 
     if (!scene_)
@@ -272,10 +351,36 @@ void Connection::Disconnect(int waitMSec)
 }
 
 void Connection::SendServerUpdate()
+{
+    BuildServerUpdate();
+    SendDeferredBuffers();
+}
+
+void Connection::BuildServerUpdate()
 {
     if (!scene_ || !sceneLoaded_)
         return;
 
+    deferSends_ = true;
+
+    // Time-stamp the update for clock synchronization. Latest data and snapshots carry the time themselves, as they may be
+    // received in a different order
+    msg_.Clear();
+    msg_.WriteUInt(scene_->GetNetworkTime());
+    SendMessage(MSG_SERVERTIME, true, false, msg_);
+
+    // With interest management, only nodes near the observer are replicated
+    const bool interestManaged = interestRadius_ > 0.0f && scene_->GetInterestGrid().IsEnabled();
+    if (interestManaged)
+        UpdateInterest();
+    else if (interestManaged_)
+    {
+        // Interest management was turned off: send the nodes that were left out
+        relevantNodes_.clear();
+        MarkInterestDirty(scene_);
+    }
+    interestManaged_ = interestManaged;
+
     // Always check the root node (scene) first so that the scene-wide components get sent first,
     // and all other replicated nodes get added to the dirty set for sending the initial state
     unsigned sceneID = scene_->GetID();
@@ -291,6 +396,29 @@ void Connection::SendServerUpdate()
         unsigned nodeID = *nodesToProcess_.begin();
         ProcessNode(nodeID);
     }
+
+    // Also flushes objects left pending if snapshot replication was just disabled
+    SendSnapshot();
+
+    deferSends_ = false;
+}
+
+void Connection::SendDeferredBuffers()
+{
+    for (unsigned i = 0; i < numDeferredPackets_; ++i)
+    {
+        auto& packet = deferredPackets_[i];
+        if (peer_)
+        {
+            peer_->Send((const char*)packet.second.GetData(), (int)packet.second.GetSize(), HIGH_PRIORITY,
+                GetPacketReliability(packet.first), (char)0, *address_, false);
+            tempPacketCounter_.y_++;
+        }
+        // Keep the buffer and its capacity for the next deferred packet
+        packet.second.Clear();
+    }
+
+    numDeferredPackets_ = 0;
 }
 
 void Connection::SendClientUpdate()
@@ -310,6 +438,14 @@ void Connection::SendClientUpdate()
         msg_.WritePackedQuaternion(rotation_);
     SendMessage(MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
 
+    // Keep acknowledging the latest complete snapshot, as acknowledgements are unreliable
+    if (completeSnapshotFrame_)
+    {
+        msg_.Clear();
+        msg_.WriteUInt(completeSnapshotFrame_);
+        SendMessage(MSG_SNAPSHOTACK, false, false, msg_);
+    }
+
     ++timeStamp_;
 }
 
@@ -344,6 +480,12 @@ void Connection::SendRemoteEvents()
 
     for (auto i = remoteEvents_.begin(); i != remoteEvents_.end(); ++i)
     {
+        if (i->message_)
+        {
+            SendMessage(*i->message_);
+            continue;
+        }
+
         msg_.Clear();
         if (!i->senderID_)
         {
@@ -365,10 +507,19 @@ void Connection::SendRemoteEvents()
 
 void Connection::SendPackages()
 {
-    while (!uploads_.empty())
+    // Refill the send budget for the elapsed time. Capped, so that an idle period does not allow a large burst
+    const float elapsed = packageSendTimer_.GetMSec(true) * 0.001f;
+    if (packageSendRate_)
     {
-        unsigned char buffer[PACKAGE_FRAGMENT_SIZE];
+        const float maxBudget = Max(packageSendRate_ * PACKAGE_SEND_BURST, (float)PACKAGE_FRAGMENT_SIZE);
+        packageSendBudget_ = Min(packageSendBudget_ + packageSendRate_ * elapsed, maxBudget);
+    }
+
+    unsigned char buffer[PACKAGE_FRAGMENT_SIZE];
+    char compressed[LZ4_COMPRESSBOUND(PACKAGE_FRAGMENT_SIZE)];
 
+    while (!uploads_.empty() && (!packageSendRate_ || packageSendBudget_ > 0.0f))
+    {
         for (auto i = uploads_.begin(); i != uploads_.end();)
         {
             auto current = i++;
@@ -377,15 +528,33 @@ void Connection::SendPackages()
                 (unsigned)Min((int)(upload.file_->GetSize() - upload.file_->GetPosition()), (int)PACKAGE_FRAGMENT_SIZE);
             upload.file_->Read(buffer, fragmentSize);
 
+            // Compress the fragment unless it does not get smaller. The checksum of the original data lets the client
+            // detect a corrupt fragment and request the rest of the package again
+            const int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(buffer), compressed,
+                fragmentSize, sizeof compressed);
+            const bool isCompressed = compressedSize > 0 && (unsigned)compressedSize < fragmentSize;
+
             msg_.Clear();
             msg_.WriteStringHash(current->first);
             msg_.WriteUInt(upload.fragment_++);
-            msg_.Write(buffer, fragmentSize);
+            msg_.WriteUInt(GetFragmentChecksum(buffer, fragmentSize));
+            msg_.WriteBool(isCompressed);
+            if (isCompressed)
+                msg_.Write(compressed, (unsigned)compressedSize);
+            else
+                msg_.Write(buffer, fragmentSize);
             SendMessage(MSG_PACKAGEDATA, true, false, msg_);
 
             // Check if upload finished
             if (upload.fragment_ == upload.totalFragments_)
                 uploads_.erase(current);
+
+            if (packageSendRate_)
+            {
+                packageSendBudget_ -= msg_.GetSize();
+                if (packageSendBudget_ <= 0.0f)
+                    break;
+            }
         }
     }
 }
@@ -396,18 +565,23 @@ void Connection::SendBuffer(PacketType type)
     if (buffer.GetSize() == 0)
         return;
 
-    PacketReliability reliability = PacketReliability::UNRELIABLE;
-    if (type == PT_UNRELIABLE_ORDERED)
-        reliability = PacketReliability::UNRELIABLE_SEQUENCED;
-
-    if (type == PT_RELIABLE_ORDERED)
-        reliability = PacketReliability::RELIABLE_ORDERED;
+    if (deferSends_)
+    {
+        // Keep the packet until SendDeferredBuffers(), so that no peer access happens on worker threads.
+        // Swap in an emptied earlier buffer instead of copying
+        if (numDeferredPackets_ == deferredPackets_.size())
+            deferredPackets_.emplace_back();
+        auto& packet = deferredPackets_[numDeferredPackets_++];
+        packet.first = type;
+        packet.second.Swap(buffer);
+        return;
+    }
 
-    if (type == PT_RELIABLE_UNORDERED)
-        reliability = PacketReliability::RELIABLE;
+    // Packets deferred earlier must go out first to preserve ordering
+    SendDeferredBuffers();
 
     if (peer_) {
-        peer_->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, reliability, (char) 0,
+        peer_->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, GetPacketReliability(type), (char) 0,
                     *address_, false);
         tempPacketCounter_.y_++;
     }
@@ -436,10 +610,11 @@ void Connection::ProcessPendingLatestData()
         if (node)
         {
             MemoryBuffer msg(current->second);
-            msg.ReadNetID(); // Skip the node ID
+            scene_->SetReceivedNetworkTime(ConvertServerTime(msg.ReadUInt()) / 1000.0);
             node->ReadLatestDataUpdate(msg);
             // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
             // Furthermore it would propagate to components and child nodes, which is not desired in this case
+            scene_->SetReceivedNetworkTime(0.0);
             nodeLatestData_.erase(current);
         }
     }
@@ -452,9 +627,10 @@ void Connection::ProcessPendingLatestData()
         if (component)
         {
             MemoryBuffer msg(current->second);
-            msg.ReadNetID(); // Skip the component ID
+            scene_->SetReceivedNetworkTime(ConvertServerTime(msg.ReadUInt()) / 1000.0);
             if (component->ReadLatestDataUpdate(msg))
                 component->ApplyAttributes();
+            scene_->SetReceivedNetworkTime(0.0);
             componentLatestData_.erase(current);
         }
     }
@@ -524,6 +700,18 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
             case MSG_PACKAGEINFO:
                 ProcessPackageInfo(msgID, msg);
                 break;
+
+            case MSG_SNAPSHOT:
+                ProcessSnapshot(msgID, msg);
+                break;
+
+            case MSG_SNAPSHOTACK:
+                ProcessSnapshotAck(msgID, msg);
+                break;
+
+            case MSG_SERVERTIME:
+                ProcessServerTime(msgID, msg);
+                break;
             default:
                 ProcessUnknownMessage(msgID, msg);
                 break;
@@ -561,6 +749,7 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
     nodeLatestData_.clear();
     componentLatestData_.clear();
     downloads_.clear();
+    ResetSnapshots();
 
     // In case we have joined other scenes in this session, remove first all downloaded package files from the resource system
     // to prevent resource conflicts
@@ -583,9 +772,8 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
         return;
     }
 
-    // If no downloads were queued, can load the scene directly
-    if (downloads_.empty())
-        OnPackagesReady();
+    // Start the downloads. If none were queued, or all are already complete in the cache, the scene is loaded directly
+    ContinuePackageDownloads();
 }
 
 void Connection::ProcessSceneChecksumError(int msgID, MemoryBuffer& msg)
@@ -699,21 +887,8 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
 
     case MSG_NODELATESTDATA:
         {
-            unsigned nodeID = msg.ReadNetID();
-            Node* node = scene_->GetNode(nodeID);
-            if (node)
-            {
-                node->ReadLatestDataUpdate(msg);
-                // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
-                // Furthermore it would propagate to components and child nodes, which is not desired in this case
-            }
-            else
-            {
-                // Latest data messages may be received out-of-order relative to node creation, so cache if necessary
-                ea::vector<unsigned char>& data = nodeLatestData_[nodeID];
-                data.resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
-            }
+            unsigned serverTime = msg.ReadUInt();
+            ProcessNodeLatestData(msg, serverTime);
         }
         break;
 
@@ -777,20 +952,8 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
 
     case MSG_COMPONENTLATESTDATA:
         {
-            unsigned componentID = msg.ReadNetID();
-            Component* component = scene_->GetComponent(componentID);
-            if (component)
-            {
-                if (component->ReadLatestDataUpdate(msg))
-                    component->ApplyAttributes();
-            }
-            else
-            {
-                // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
-                ea::vector<unsigned char>& data = componentLatestData_[componentID];
-                data.resize(msg.GetSize());
-                memcpy(&data[0], msg.GetData(), msg.GetSize());
-            }
+            unsigned serverTime = msg.ReadUInt();
+            ProcessComponentLatestData(msg, serverTime);
         }
         break;
 
@@ -821,6 +984,8 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
         else
         {
             ea::string name = msg.ReadString();
+            // The client may already have part of the package from an interrupted download
+            unsigned startFragment = msg.ReadUInt();
 
             if (!scene_)
             {
@@ -838,10 +1003,16 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
                 {
                     StringHash nameHash(name);
 
-                    // Do not restart upload if already exists
-                    if (uploads_.contains(nameHash))
+                    // If already in transfer, the client lost a fragment: continue from the requested one
+                    auto upload = uploads_.find(nameHash);
+                    if (upload != uploads_.end())
                     {
-                        URHO3D_LOGWARNING("Received a request for package " + name + " already in transfer");
+                        if (startFragment < upload->second.totalFragments_)
+                        {
+                            URHO3D_LOGWARNING("Resending package " + name + " from fragment " + ea::to_string(startFragment));
+                            upload->second.fragment_ = startFragment;
+                            upload->second.file_->Seek(startFragment * PACKAGE_FRAGMENT_SIZE);
+                        }
                         return;
                     }
 
@@ -854,11 +1025,26 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
                         return;
                     }
 
-                    URHO3D_LOGINFO("Transmitting package file " + name + " to client " + ToString());
+                    unsigned totalFragments = (file->GetSize() + PACKAGE_FRAGMENT_SIZE - 1) / PACKAGE_FRAGMENT_SIZE;
+                    if (startFragment >= totalFragments)
+                    {
+                        URHO3D_LOGERROR("Client requested package file " + name + " from a fragment past its end");
+                        SendPackageError(name);
+                        return;
+                    }
 
+                    if (startFragment)
+                    {
+                        URHO3D_LOGINFO("Resuming transmission of package file " + name + " to client " + ToString() +
+                            " from fragment " + ea::to_string(startFragment));
+                    }
+                    else
+                        URHO3D_LOGINFO("Transmitting package file " + name + " to client " + ToString());
+
+                    file->Seek(startFragment * PACKAGE_FRAGMENT_SIZE);
                     uploads_[nameHash].file_ = file;
-                    uploads_[nameHash].fragment_ = 0;
-                    uploads_[nameHash].totalFragments_ = (file->GetSize() + PACKAGE_FRAGMENT_SIZE - 1) / PACKAGE_FRAGMENT_SIZE;
+                    uploads_[nameHash].fragment_ = startFragment;
+                    uploads_[nameHash].totalFragments_ = totalFragments;
                     return;
                 }
             }
@@ -895,53 +1081,58 @@ void Connection::ProcessPackageDownload(int msgID, MemoryBuffer& msg)
                 return;
             }
 
-            // If file has not yet been opened, try to open now. Prepend the checksum to the filename to allow multiple versions
             if (!download.file_)
-            {
-                download.file_ = new File(context_,
-                    GetSubsystem<Network>()->GetPackageCacheDir() + ToStringHex(download.checksum_) + "_" + download.name_,
-                    FILE_WRITE);
-                if (!download.file_->IsOpen())
-                {
-                    OnPackageDownloadFailed(download.name_);
-                    return;
-                }
-            }
+                return;
 
-            // Write the fragment data to the proper index
-            unsigned char buffer[PACKAGE_FRAGMENT_SIZE];
+            // Disregard fragments already received, which are resent when a corrupt fragment was requested again
             unsigned index = msg.ReadUInt();
-            unsigned fragmentSize = msg.GetSize() - msg.GetPosition();
+            if (index < download.nextFragment_ || index >= download.totalFragments_ ||
+                download.pendingFragments_.contains(index))
+                return;
 
-            msg.Read(buffer, fragmentSize);
-            download.file_->Seek(index * PACKAGE_FRAGMENT_SIZE);
-            download.file_->Write(buffer, fragmentSize);
-            download.receivedFragments_.insert(index);
+            unsigned checksum = msg.ReadUInt();
+            bool isCompressed = msg.ReadBool();
+            auto dataSize = (int)(msg.GetSize() - msg.GetPosition());
+            auto data = reinterpret_cast<const char*>(msg.GetData() + msg.GetPosition());
+            unsigned fragmentSize = Min(download.fileSize_ - index * PACKAGE_FRAGMENT_SIZE, PACKAGE_FRAGMENT_SIZE);
 
-            // Check if all fragments received
-            if (download.receivedFragments_.size() == download.totalFragments_)
+            ea::vector<unsigned char> fragment(fragmentSize);
+            bool valid;
+            if (isCompressed)
             {
-                URHO3D_LOGINFO("Package " + download.name_ + " downloaded successfully");
-
-                // Instantiate the package and add to the resource system, as we will need it to load the scene
-                download.file_->Close();
-                GetSubsystem<ResourceCache>()->AddPackageFile(download.file_->GetName(), 0);
+                valid = LZ4_decompress_safe(data, reinterpret_cast<char*>(fragment.data()), dataSize, fragmentSize) ==
+                    (int)fragmentSize;
+            }
+            else
+            {
+                valid = (unsigned)dataSize == fragmentSize;
+                if (valid)
+                    memcpy(fragment.data(), data, fragmentSize);
+            }
 
-                // Then start the next download if there are more
-                downloads_.erase(i);
-                if (downloads_.empty())
-                    OnPackagesReady();
-                else
-                {
-                    PackageDownload& nextDownload = downloads_.begin()->second;
+            if (!valid || GetFragmentChecksum(fragment.data(), fragmentSize) != checksum)
+            {
+                URHO3D_LOGWARNING("Received corrupt fragment " + ea::to_string(index) + " of package " + download.name_);
+                download.pendingFragments_.clear();
+                RequestPackageData(download);
+                return;
+            }
 
-                    URHO3D_LOGINFO("Requesting package " + nextDownload.name_ + " from server");
-                    msg_.Clear();
-                    msg_.WriteString(nextDownload.name_);
-                    SendMessage(MSG_REQUESTPACKAGE, true, true, msg_);
-                    nextDownload.initiated_ = true;
-                }
+            // Write fragments to the file in order, so that its size tells how much of the package can be resumed. Their
+            // checksums are stored alongside, to verify the fragments when resuming
+            download.pendingFragments_[index] = ea::move(fragment);
+            for (auto j = download.pendingFragments_.find(download.nextFragment_); j != download.pendingFragments_.end();
+                j = download.pendingFragments_.find(download.nextFragment_))
+            {
+                download.file_->Write(j->second.data(), j->second.size());
+                download.checksumFile_->WriteUInt(GetFragmentChecksum(j->second.data(), j->second.size()));
+                download.pendingFragments_.erase(j);
+                ++download.nextFragment_;
             }
+
+            // Check if all fragments received
+            if (download.nextFragment_ == download.totalFragments_)
+                ContinuePackageDownloads();
         }
         break;
 
@@ -1030,6 +1221,188 @@ void Connection::ProcessSceneLoaded(int msgID, MemoryBuffer& msg)
     }
 }
 
+void Connection::ProcessSnapshot(int msgID, MemoryBuffer& msg)
+{
+    if (IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected Snapshot message from client " + ToString());
+        return;
+    }
+
+    if (!scene_)
+        return;
+
+    unsigned frame = msg.ReadUInt();
+    unsigned serverTime = msg.ReadUInt();
+    unsigned partIndex = msg.ReadVLE();
+    unsigned numParts = msg.ReadVLE();
+
+    // Parts of older snapshots are superseded, as the server resends everything not yet acknowledged
+    if (frame < snapshotFrame_ || !numParts || partIndex >= numParts)
+        return;
+    if (frame > snapshotFrame_ || snapshotPartsReceived_.size() != numParts)
+    {
+        snapshotFrame_ = frame;
+        snapshotPartsReceived_.clear();
+        snapshotPartsReceived_.resize(numParts, false);
+        numSnapshotPartsReceived_ = 0;
+    }
+    if (snapshotPartsReceived_[partIndex])
+        return;
+
+    while (!msg.IsEof())
+    {
+        unsigned char type = msg.ReadUByte();
+        unsigned size = msg.ReadVLE();
+        if (msg.GetPosition() + size > msg.GetSize())
+        {
+            URHO3D_LOGWARNING("Received a malformed Snapshot message from server " + ToString());
+            return;
+        }
+
+        MemoryBuffer record(msg.GetData() + msg.GetPosition(), size);
+        msg.Seek(msg.GetPosition() + size);
+        if (type == 0)
+            ProcessNodeLatestData(record, serverTime);
+        else
+            ProcessComponentLatestData(record, serverTime);
+    }
+
+    snapshotPartsReceived_[partIndex] = true;
+    if (++numSnapshotPartsReceived_ == numParts)
+        completeSnapshotFrame_ = frame;
+}
+
+void Connection::ProcessSnapshotAck(int msgID, MemoryBuffer& msg)
+{
+    if (!IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected SnapshotAck message from server");
+        return;
+    }
+
+    if (!scene_)
+        return;
+
+    // Acknowledgements may arrive out of order; never go back, and never accept frames the server has not produced
+    unsigned frame = msg.ReadUInt();
+    if (frame <= scene_->GetNetworkFrame())
+        ackedSnapshotFrame_ = Max(ackedSnapshotFrame_, frame);
+}
+
+void Connection::ProcessServerTime(int msgID, MemoryBuffer& msg)
+{
+    if (IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected ServerTime message from client " + ToString());
+        return;
+    }
+
+    const double time = ConvertServerTime(msg.ReadUInt());
+    const double localTime = clockTimer_.GetUSec(false) / 1000.0;
+
+    // Network delay only makes updates late, so the least delayed update of the recent window gives the most
+    // accurate clock offset. Small corrections are applied gradually to keep the synchronized time smooth
+    const double offset = time + GetRoundTripTime() * 0.5 - localTime;
+    if (clockOffsetSamples_.size() < CLOCK_SYNC_WINDOW)
+        clockOffsetSamples_.push_back(offset);
+    else
+        clockOffsetSamples_[clockOffsetIndex_] = offset;
+    clockOffsetIndex_ = (clockOffsetIndex_ + 1) % CLOCK_SYNC_WINDOW;
+
+    double targetOffset = offset;
+    for (double sample : clockOffsetSamples_)
+        targetOffset = Max(targetOffset, sample);
+
+    if (!clockSynchronized_ || Abs(targetOffset - clockOffset_) > CLOCK_RESET_THRESHOLD)
+        clockOffset_ = targetOffset;
+    else
+        clockOffset_ += (targetOffset - clockOffset_) * CLOCK_ADJUST_RATE;
+
+    // Measure jitter as the smoothed deviation of arrival intervals from send intervals (as in RTP), ignoring
+    // updates received out of order
+    if (clockSynchronized_ && time > lastServerTime_)
+    {
+        const auto sendInterval = (float)(time - lastServerTime_);
+        const auto arrivalInterval = (float)(localTime - lastArrivalTime_);
+        updateInterval_ = updateInterval_ > 0.0f ? updateInterval_ + (sendInterval - updateInterval_) / 16.0f : sendInterval;
+        jitter_ += (Abs(arrivalInterval - sendInterval) - jitter_) / 16.0f;
+    }
+    if (!clockSynchronized_ || time > lastServerTime_)
+    {
+        lastServerTime_ = time;
+        lastArrivalTime_ = localTime;
+    }
+
+    // Show transforms late enough that the update covering the interpolation time has most likely arrived
+    const float targetDelay = GetRoundTripTime() * 0.5f + updateInterval_ + jitter_ * INTERPOLATION_JITTER_FACTOR;
+    if (!clockSynchronized_)
+        interpolationDelay_ = targetDelay;
+    else
+        interpolationDelay_ += (targetDelay - interpolationDelay_) * CLOCK_ADJUST_RATE;
+
+    clockSynchronized_ = true;
+}
+
+double Connection::ConvertServerTime(unsigned serverTime)
+{
+    if (!serverTimeReceived_)
+    {
+        serverTimeBase_ = serverTime - SERVER_TIME_BASE_MARGIN;
+        serverTimeReceived_ = true;
+    }
+
+    // Unsigned difference is correct across wraparound of the server system time
+    return (double)(serverTime - serverTimeBase_);
+}
+
+double Connection::GetServerTime() const
+{
+    return clockSynchronized_ ? const_cast<HiresTimer&>(clockTimer_).GetUSec(false) / 1000.0 + clockOffset_ : 0.0;
+}
+
+double Connection::GetInterpolationTime() const
+{
+    return clockSynchronized_ ? Max(GetServerTime() - interpolationDelay_, 0.0) / 1000.0 : 0.0;
+}
+
+void Connection::ProcessNodeLatestData(MemoryBuffer& msg, unsigned serverTime)
+{
+    unsigned nodeID = msg.ReadNetID();
+    Node* node = scene_->GetNode(nodeID);
+    if (node)
+    {
+        scene_->SetReceivedNetworkTime(ConvertServerTime(serverTime) / 1000.0);
+        node->ReadLatestDataUpdate(msg);
+        // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
+        // Furthermore it would propagate to components and child nodes, which is not desired in this case
+        scene_->SetReceivedNetworkTime(0.0);
+    }
+    else
+    {
+        // Latest data messages may be received out-of-order relative to node creation, so cache if necessary
+        CacheLatestData(nodeLatestData_[nodeID], msg, serverTime);
+    }
+}
+
+void Connection::ProcessComponentLatestData(MemoryBuffer& msg, unsigned serverTime)
+{
+    unsigned componentID = msg.ReadNetID();
+    Component* component = scene_->GetComponent(componentID);
+    if (component)
+    {
+        scene_->SetReceivedNetworkTime(ConvertServerTime(serverTime) / 1000.0);
+        if (component->ReadLatestDataUpdate(msg))
+            component->ApplyAttributes();
+        scene_->SetReceivedNetworkTime(0.0);
+    }
+    else
+    {
+        // Latest data messages may be received out-of-order relative to component creation, so cache if necessary
+        CacheLatestData(componentLatestData_[componentID], msg, serverTime);
+    }
+}
+
 void Connection::ProcessRemoteEvent(int msgID, MemoryBuffer& msg)
 {
     using namespace RemoteEventData;
@@ -1160,7 +1533,7 @@ float Connection::GetDownloadProgress() const
         downloads_.end(); ++i)
     {
         if (i->second.initiated_)
-            return (float)i->second.receivedFragments_.size() / (float)i->second.totalFragments_;
+            return (float)(i->second.nextFragment_ + i->second.pendingFragments_.size()) / (float)i->second.totalFragments_;
     }
     return 1.0f;
 }
@@ -1234,8 +1607,12 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+            MutexLock lock(replicationStateMutex);
             sceneState_.nodeStates_.erase(nodeID);
         }
+        else if (interestManaged_ && !IsNodeRelevant(node))
+            RemoveIrrelevantNode(node);
         else
             ProcessExistingNode(node, i->second);
     }
@@ -1243,7 +1620,12 @@ void Connection::ProcessNode(unsigned nodeID)
     {
         // Replication state not found: this is a new node
         Node* node = scene_->GetNode(nodeID);
-        if (node)
+        if (node && interestManaged_ && !IsNodeRelevant(node))
+        {
+            // Outside the interest area: will be marked dirty again when it enters
+            sceneState_.dirtyNodes_.erase(nodeID);
+        }
+        else if (node)
             ProcessNewNode(node);
         else
         {
@@ -1253,6 +1635,126 @@ void Connection::ProcessNode(unsigned nodeID)
     }
 }
 
+void Connection::UpdateInterest()
+{
+    const InterestGrid& grid = scene_->GetInterestGrid();
+
+    // Nodes enter within the radius, but leave only when one cell further away, so that nodes moving along
+    // a cell border are not repeatedly removed and recreated on the client
+    newRelevantNodes_.clear();
+    interestQuery_.clear();
+    grid.Query(interestQuery_, position_, interestRadius_);
+    newRelevantNodes_.insert(interestQuery_.begin(), interestQuery_.end());
+
+    interestQuery_.clear();
+    grid.Query(interestQuery_, position_, interestRadius_ + grid.GetCellSize());
+    for (unsigned nodeID : interestQuery_)
+    {
+        if (relevantNodes_.contains(nodeID))
+            newRelevantNodes_.insert(nodeID);
+    }
+
+    for (unsigned nodeID : newRelevantNodes_)
+    {
+        if (relevantNodes_.contains(nodeID))
+            continue;
+        if (Node* node = scene_->GetNode(nodeID))
+            MarkInterestDirty(node);
+    }
+
+    for (unsigned nodeID : relevantNodes_)
+    {
+        if (newRelevantNodes_.contains(nodeID))
+            continue;
+        // Removed nodes are handled by the dirty set as usual, and owned nodes are always relevant
+        Node* node = scene_->GetNode(nodeID);
+        if (node && node->GetOwner() != this)
+            RemoveIrrelevantNode(node);
+    }
+
+    ea::swap(relevantNodes_, newRelevantNodes_);
+}
+
+bool Connection::IsNodeRelevant(Node* node) const
+{
+    // The interest grid tracks top-level nodes; their descendants follow them
+    Node* topLevelNode = node;
+    while (topLevelNode->GetParent() && topLevelNode->GetParent() != scene_)
+        topLevelNode = topLevelNode->GetParent();
+
+    if (topLevelNode == scene_ || !topLevelNode->IsReplicated())
+        return true;
+    return relevantNodes_.contains(topLevelNode->GetID()) || topLevelNode->GetOwner() == this;
+}
+
+void Connection::MarkInterestDirty(Node* node)
+{
+    if (node->IsReplicated())
+        sceneState_.dirtyNodes_.insert(node->GetID());
+
+    for (const SharedPtr<Node>& child : node->GetChildren())
+        MarkInterestDirty(child);
+}
+
+void Connection::RemoveIrrelevantNode(Node* node)
+{
+    // Removing the node on the client removes its descendants as well
+    if (sceneState_.nodeStates_.contains(node->GetID()))
+    {
+        msg_.Clear();
+        msg_.WriteNetID(node->GetID());
+        SendMessage(MSG_REMOVENODE, true, true, msg_);
+    }
+
+    RemoveNodeReplicationState(node);
+}
+
+void Connection::RemoveNodeReplicationState(Node* node)
+{
+    const unsigned nodeID = node->GetID();
+    auto i = sceneState_.nodeStates_.find(nodeID);
+    if (i != sceneState_.nodeStates_.end())
+    {
+        NodeReplicationState& nodeState = i->second;
+        for (auto j = nodeState.componentStates_.begin(); j != nodeState.componentStates_.end(); ++j)
+            snapshotComponents_.erase(j->first);
+
+        MutexLock lock(replicationStateMutex);
+        for (auto j = nodeState.componentStates_.begin(); j != nodeState.componentStates_.end(); ++j)
+        {
+            if (Component* component = j->second.component_.Get())
+                component->RemoveReplicationState(&j->second);
+        }
+        node->RemoveReplicationState(&nodeState);
+        sceneState_.nodeStates_.erase(i);
+    }
+
+    sceneState_.dirtyNodes_.erase(nodeID);
+    snapshotNodes_.erase(nodeID);
+
+    for (const SharedPtr<Node>& child : node->GetChildren())
+        RemoveNodeReplicationState(child);
+}
+
+void Connection::AddNodeReplicationState(Node* node, NodeReplicationState& nodeState)
+{
+    MutexLock lock(replicationStateMutex);
+    nodeState.connection_ = this;
+    nodeState.sceneState_ = &sceneState_;
+    nodeState.node_ = node;
+    node->AddReplicationState(&nodeState);
+}
+
+void Connection::AddComponentReplicationState(Component* component, NodeReplicationState& nodeState,
+    ComponentReplicationState& componentState)
+{
+    MutexLock lock(replicationStateMutex);
+    componentState.connection_ = this;
+    componentState.nodeState_ = &nodeState;
+    componentState.component_ = component;
+    component->AddReplicationState(&componentState);
+}
+
 void Connection::ProcessNewNode(Node* node)
 {
     // Process depended upon nodes first, if they are dirty
@@ -1268,10 +1770,7 @@ void Connection::ProcessNewNode(Node* node)
     msg_.WriteNetID(node->GetID());
 
     NodeReplicationState& nodeState = sceneState_.nodeStates_[node->GetID()];
-    nodeState.connection_ = this;
-    nodeState.sceneState_ = &sceneState_;
-    nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    AddNodeReplicationState(node, nodeState);
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
@@ -1296,10 +1795,7 @@ void Connection::ProcessNewNode(Node* node)
             continue;
 
         ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
-        componentState.connection_ = this;
-        componentState.nodeState_ = &nodeState;
-        componentState.component_ = component;
-        component->AddReplicationState(&componentState);
+        AddComponentReplicationState(component, nodeState, componentState);
 
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
@@ -1349,10 +1845,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             }
         }
 
-        // Send latestdata message if necessary
-        if (hasLatestData)
+        // Send latestdata message if necessary. In snapshot mode the node is included in snapshots until acknowledged
+        if (hasLatestData && snapshotReplication_)
+            snapshotNodes_[node->GetID()] = scene_->GetNetworkFrame();
+        else if (hasLatestData)
         {
             msg_.Clear();
+            msg_.WriteUInt(scene_->GetNetworkTime());
             msg_.WriteNetID(node->GetID());
             node->WriteLatestDataUpdate(msg_, timeStamp_);
 
@@ -1407,6 +1906,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.WriteNetID(current->first);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
+
+            MutexLock lock(replicationStateMutex);
             nodeState.componentStates_.erase(current);
         }
         else
@@ -1428,9 +1929,12 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 }
 
                 // Send latestdata message if necessary
-                if (hasLatestData)
+                if (hasLatestData && snapshotReplication_)
+                    snapshotComponents_[component->GetID()] = scene_->GetNetworkFrame();
+                else if (hasLatestData)
                 {
                     msg_.Clear();
+                    msg_.WriteUInt(scene_->GetNetworkTime());
                     msg_.WriteNetID(component->GetID());
                     component->WriteLatestDataUpdate(msg_, timeStamp_);
 
@@ -1469,10 +1973,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             {
                 // New component
                 ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
-                componentState.connection_ = this;
-                componentState.nodeState_ = &nodeState;
-                componentState.component_ = component;
-                component->AddReplicationState(&componentState);
+                AddComponentReplicationState(component, nodeState, componentState);
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
@@ -1569,17 +2070,140 @@ void Connection::RequestPackage(const ea::string& name, unsigned fileSize, unsig
     PackageDownload& download = downloads_[nameHash];
     download.name_ = name;
     download.totalFragments_ = (fileSize + PACKAGE_FRAGMENT_SIZE - 1) / PACKAGE_FRAGMENT_SIZE;
+    download.fileSize_ = fileSize;
     download.checksum_ = checksum;
+}
 
-    // Start download now only if no existing downloads, else wait for the existing ones to finish
-    if (downloads_.size() == 1)
+void Connection::RequestPackageData(PackageDownload& download)
+{
+    // Open the partial file left by an earlier download if any, and resume after the fragments in it
+    if (!download.file_)
     {
-        URHO3D_LOGINFO("Requesting package " + name + " from server");
-        msg_.Clear();
-        msg_.WriteString(name);
-        SendMessage(MSG_REQUESTPACKAGE, true, true, msg_);
-        download.initiated_ = true;
+        const ea::string partialName = GetCachedPackageName(GetSubsystem<Network>()->GetPackageCacheDir(), download) + ".part";
+        const ea::string checksumName = partialName + ".sum";
+        download.file_ = new File(context_, partialName, FILE_READWRITE);
+        download.checksumFile_ = new File(context_, checksumName, FILE_READWRITE);
+        // A partial file larger than the package can not be resumed, start over
+        if (download.file_->IsOpen() && download.file_->GetSize() > download.fileSize_)
+        {
+            download.file_ = new File(context_, partialName, FILE_WRITE);
+            download.checksumFile_ = new File(context_, checksumName, FILE_WRITE);
+        }
+        if (!download.file_->IsOpen() || !download.checksumFile_->IsOpen())
+        {
+            OnPackageDownloadFailed(download.name_);
+            return;
+        }
+
+        // Resume after the fragments that still match the checksums they were received with. Fragments after a
+        // missing or mismatching checksum are downloaded again
+        const unsigned partialSize = download.file_->GetSize();
+        const unsigned numWritten = partialSize == download.fileSize_ ? download.totalFragments_ : partialSize / PACKAGE_FRAGMENT_SIZE;
+        const unsigned numChecksums = download.checksumFile_->GetSize() / sizeof(unsigned);
+        ea::vector<unsigned char> fragment(PACKAGE_FRAGMENT_SIZE);
+        download.nextFragment_ = 0;
+        while (download.nextFragment_ < Min(numWritten, numChecksums))
+        {
+            const unsigned fragmentSize = Min(download.fileSize_ - download.nextFragment_ * PACKAGE_FRAGMENT_SIZE,
+                PACKAGE_FRAGMENT_SIZE);
+            if (download.file_->Read(fragment.data(), fragmentSize) != fragmentSize ||
+                GetFragmentChecksum(fragment.data(), fragmentSize) != download.checksumFile_->ReadUInt())
+                break;
+            ++download.nextFragment_;
+        }
+        download.file_->Seek(download.nextFragment_ * PACKAGE_FRAGMENT_SIZE);
+        download.checksumFile_->Seek(download.nextFragment_ * sizeof(unsigned));
+
+        if (download.nextFragment_)
+        {
+            URHO3D_LOGINFO("Resuming download of package " + download.name_ + " from fragment " +
+                ea::to_string(download.nextFragment_));
+        }
+    }
+
+    // The partial file may already hold the whole package. Finishing is left to the caller
+    download.initiated_ = true;
+    if (download.nextFragment_ == download.totalFragments_)
+        return;
+
+    URHO3D_LOGINFO("Requesting package " + download.name_ + " from server");
+    msg_.Clear();
+    msg_.WriteString(download.name_);
+    msg_.WriteUInt(download.nextFragment_);
+    SendMessage(MSG_REQUESTPACKAGE, true, true, msg_);
+}
+
+void Connection::ContinuePackageDownloads()
+{
+    while (!downloads_.empty())
+    {
+        // Downloads are done one at a time. Continue the initiated one, or else start any
+        auto i = downloads_.begin();
+        for (auto j = downloads_.begin(); j != downloads_.end(); ++j)
+        {
+            if (j->second.initiated_)
+            {
+                i = j;
+                break;
+            }
+        }
+
+        PackageDownload& download = i->second;
+        if (!download.initiated_)
+        {
+            RequestPackageData(download);
+            // If the partial file could not be opened, the downloads were cleared
+            if (downloads_.empty())
+                return;
+        }
+
+        // Wait for the remaining fragments
+        if (download.nextFragment_ < download.totalFragments_)
+            return;
+
+        if (!OnPackageDownloadFinished(i->first))
+            return;
+    }
+
+    OnPackagesReady();
+}
+
+bool Connection::OnPackageDownloadFinished(StringHash nameHash)
+{
+    auto i = downloads_.find(nameHash);
+    if (i == downloads_.end())
+        return false;
+
+    PackageDownload& download = i->second;
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    const ea::string partialName = download.file_->GetName();
+    const ea::string fileName = GetCachedPackageName(GetSubsystem<Network>()->GetPackageCacheDir(), download);
+    download.file_->Close();
+    download.checksumFile_->Close();
+    fileSystem->Delete(download.checksumFile_->GetName());
+
+    // All fragments have been verified against their checksums, either when received or when resumed. Check also that
+    // the assembled package matches the expected size and header checksum
+    if (fileSystem->FileExists(fileName))
+        fileSystem->Delete(fileName);
+    SharedPtr<PackageFile> package;
+    if (fileSystem->Rename(partialName, fileName))
+        package = new PackageFile(context_, fileName);
+    if (!package || package->GetTotalSize() != download.fileSize_ || package->GetChecksum() != download.checksum_)
+    {
+        package.Reset();
+        fileSystem->Delete(fileSystem->FileExists(fileName) ? fileName : partialName);
+        OnPackageDownloadFailed(download.name_);
+        return false;
     }
+
+    URHO3D_LOGINFO("Package " + download.name_ + " downloaded successfully");
+
+    // Add the package to the resource system, as we will need it to load the scene
+    GetSubsystem<ResourceCache>()->AddPackageFile(package, 0);
+
+    downloads_.erase(i);
+    return true;
 }
 
 void Connection::SendPackageError(const ea::string& name)
@@ -1645,6 +2269,86 @@ void Connection::OnPackagesReady()
     }
 }
 
+void Connection::SendSnapshot()
+{
+    if (snapshotNodes_.empty() && snapshotComponents_.empty())
+        return;
+
+    const unsigned frame = scene_->GetNetworkFrame();
+    unsigned numParts = 0;
+
+    auto writeRecord = [&](unsigned char type)
+    {
+        if (!numParts || snapshotParts_[numParts - 1].GetSize() + msg_.GetSize() + 6 > (unsigned)packedMessageLimit_)
+        {
+            if (snapshotParts_.size() <= numParts)
+                snapshotParts_.emplace_back();
+            snapshotParts_[numParts++].Clear();
+        }
+
+        VectorBuffer& part = snapshotParts_[numParts - 1];
+        part.WriteUByte(type);
+        part.WriteVLE(msg_.GetSize());
+        part.Write(msg_.GetData(), msg_.GetSize());
+    };
+
+    // Objects stay in the snapshot with their full latest data until a snapshot newer than their last change is
+    // acknowledged, so a lost snapshot is repaired by the next one without retransmitting stale data
+    for (auto i = snapshotNodes_.begin(); i != snapshotNodes_.end();)
+    {
+        Node* node = scene_->GetNode(i->first);
+        if (!node || i->second <= ackedSnapshotFrame_)
+        {
+            i = snapshotNodes_.erase(i);
+            continue;
+        }
+
+        msg_.Clear();
+        msg_.WriteNetID(node->GetID());
+        node->WriteLatestDataUpdate(msg_, timeStamp_);
+        writeRecord(0);
+        ++i;
+    }
+
+    for (auto i = snapshotComponents_.begin(); i != snapshotComponents_.end();)
+    {
+        Component* component = scene_->GetComponent(i->first);
+        if (!component || i->second <= ackedSnapshotFrame_)
+        {
+            i = snapshotComponents_.erase(i);
+            continue;
+        }
+
+        msg_.Clear();
+        msg_.WriteNetID(component->GetID());
+        component->WriteLatestDataUpdate(msg_, timeStamp_);
+        writeRecord(1);
+        ++i;
+    }
+
+    for (unsigned i = 0; i < numParts; ++i)
+    {
+        msg_.Clear();
+        msg_.WriteUInt(frame);
+        msg_.WriteUInt(scene_->GetNetworkTime());
+        msg_.WriteVLE(i);
+        msg_.WriteVLE(numParts);
+        msg_.Write(snapshotParts_[i].GetData(), snapshotParts_[i].GetSize());
+        SendMessage(MSG_SNAPSHOT, false, false, msg_);
+    }
+}
+
+void Connection::ResetSnapshots()
+{
+    snapshotNodes_.clear();
+    snapshotComponents_.clear();
+    ackedSnapshotFrame_ = 0;
+    snapshotFrame_ = 0;
+    snapshotPartsReceived_.clear();
+    numSnapshotPartsReceived_ = 0;
+    completeSnapshotFrame_ = 0;
+}
+
 void Connection::ProcessPackageInfo(int msgID, MemoryBuffer& msg)
 {
     if (!scene_)
@@ -1657,6 +2361,8 @@ void Connection::ProcessPackageInfo(int msgID, MemoryBuffer& msg)
     }
 
     RequestNeededPackages(1, msg);
+    if (!downloads_.empty())
+        ContinuePackageDownloads();
 }
 
 void Connection::ProcessUnknownMessage(int msgID, MemoryBuffer& msg)
@@ -30,6 +30,7 @@
 #include "../Core/Timer.h"
 #include "../Input/Controls.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/OutgoingMessage.h"
 #include "../Scene/ReplicationState.h"
 
 namespace SLNet
@@ -63,6 +64,8 @@ struct RemoteEvent
     VariantMap eventData_;
     /// In order flag.
     bool inOrder_;
+    /// Already serialized message, shared with other connections. Event type and data are unused if set.
+    SharedPtr<OutgoingMessage> message_;
 };
 
 /// Package file receive transfer.
@@ -71,16 +74,22 @@ struct PackageDownload
     /// Construct with defaults.
     PackageDownload();
 
-    /// Destination file.
+    /// Partial destination file in the package cache. Contains the fragments received in order so far, so that an interrupted download can be resumed.
     SharedPtr<File> file_;
-    /// Already received fragments.
-    ea::hash_set<unsigned> receivedFragments_;
+    /// Checksums of the fragments written to the partial file, used to verify them when resuming.
+    SharedPtr<File> checksumFile_;
+    /// Fragments received out of order, waiting for the preceding fragments.
+    ea::unordered_map<unsigned, ea::vector<unsigned char> > pendingFragments_;
     /// Package name.
     ea::string name_;
     /// Total number of fragments.
     unsigned totalFragments_;
+    /// Package file size.
+    unsigned fileSize_;
     /// Checksum.
     unsigned checksum_;
+    /// Number of fragments written to the file.
+    unsigned nextFragment_;
     /// Download initiated flag.
     bool initiated_;
 };
@@ -137,6 +146,10 @@ public:
     void SendMessage(int msgID, bool reliable, bool inOrder, const VectorBuffer& msg, unsigned contentID = 0);
     /// Send a message.
     void SendMessage(int msgID, bool reliable, bool inOrder, const unsigned char* data, unsigned numBytes, unsigned contentID = 0);
+    /// Send a pooled message that may also be sent to other connections.
+    void SendMessage(const OutgoingMessage& message);
+    /// Queue a remote event already serialized into a pooled message, to be sent in order with other remote events.
+    void SendRemoteEvent(OutgoingMessage* message);
     /// Send a remote event.
     void SendRemoteEvent(StringHash eventType, bool inOrder, const VariantMap& eventData = Variant::emptyVariantMap);
     /// Send a remote event with the specified node as sender.
@@ -154,6 +167,9 @@ public:
     /// Set the observer rotation for interest management, to be sent to the server. Note: not used by the NetworkPriority component.
     /// @property
     void SetRotation(const Quaternion& rotation);
+    /// Set radius around the observer position within which top-level nodes are replicated to this client, when the scene has an interest grid. Nodes leaving the area are removed from the client. Zero (default) replicates all nodes.
+    /// @property
+    void SetInterestRadius(float radius) { interestRadius_ = Max(radius, 0.0f); }
     /// Set the connection pending status. Called by Network.
     void SetConnectPending(bool connectPending);
     /// Set whether to log data in/out statistics.
@@ -163,6 +179,10 @@ public:
     void Disconnect(int waitMSec = 0);
     /// Send scene update messages. Called by Network.
     void SendServerUpdate();
+    /// Build scene update messages without sending packets to the peer. May be called for different connections in parallel from worker threads; SendDeferredBuffers() must be called afterward from the main thread. Called by Network.
+    void BuildServerUpdate();
+    /// Send packets completed during BuildServerUpdate(), in order. Called by Network.
+    void SendDeferredBuffers();
     /// Send latest controls from the client. Called by Network.
     void SendClientUpdate();
     /// Send queued remote events. Called by Network.
@@ -204,6 +224,22 @@ public:
     /// @property
     const Quaternion& GetRotation() const { return rotation_; }
 
+    /// Return interest radius.
+    /// @property
+    float GetInterestRadius() const { return interestRadius_; }
+    /// Return whether the client clock has been synchronized with the server.
+    bool IsClockSynchronized() const { return clockSynchronized_; }
+    /// Return estimated current server time in milliseconds, relative to the first received server update. Used on the client.
+    double GetServerTime() const;
+    /// Return server time in seconds at which to show interpolated transforms, or zero if not synchronized. Used on the client.
+    double GetInterpolationTime() const;
+    /// Return adaptive interpolation delay in milliseconds. Used on the client.
+    float GetInterpolationDelay() const { return interpolationDelay_; }
+    /// Return measured jitter of server update arrival in milliseconds. Used on the client.
+    float GetJitter() const { return jitter_; }
+    /// Return number of top-level nodes currently relevant to this client. Only counted when interest management is in use.
+    unsigned GetNumRelevantNodes() const { return relevantNodes_.size(); }
+
     /// Return whether is a client connection.
     /// @property
     bool IsClient() const { return isClient_; }
@@ -272,6 +308,14 @@ public:
 
     /// Set network simulation parameters. Called by Network.
     void ConfigureNetworkSimulator(int latencyMs, float packetLoss);
+    /// Set whether latest data is sent in unreliable snapshots instead of reliable messages. Called by Network.
+    void SetSnapshotReplication(bool enable) { snapshotReplication_ = enable; }
+    /// Return whether latest data is sent in unreliable snapshots.
+    bool GetSnapshotReplication() const { return snapshotReplication_; }
+    /// Set maximum rate of package data sent to the client in bytes per second, or 0 for unlimited. Called by Network.
+    void SetPackageSendRate(unsigned bytesPerSec) { packageSendRate_ = bytesPerSec; }
+    /// Return maximum rate of package data sent to the client in bytes per second.
+    unsigned GetPackageSendRate() const { return packageSendRate_; }
     /// Buffered packet size limit, when reached, packet is sent out immediately
     void SetPacketSizeLimit(int limit);
 
@@ -301,27 +345,63 @@ private:
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
+    /// Process a snapshot part from the server. Called by Network.
+    void ProcessSnapshot(int msgID, MemoryBuffer& msg);
+    /// Process a snapshot acknowledgement from the client. Called by Network.
+    void ProcessSnapshotAck(int msgID, MemoryBuffer& msg);
+    /// Process a server time message. Called by Network.
+    void ProcessServerTime(int msgID, MemoryBuffer& msg);
+    /// Convert server system time to milliseconds relative to the first received server time.
+    double ConvertServerTime(unsigned serverTime);
+    /// Apply node latest data stamped with the server time of its update, or cache it if the node does not exist yet.
+    void ProcessNodeLatestData(MemoryBuffer& msg, unsigned serverTime);
+    /// Apply component latest data stamped with the server time of its update, or cache it if the component does not exist yet.
+    void ProcessComponentLatestData(MemoryBuffer& msg, unsigned serverTime);
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
+    /// Start tracking replication state of a node. Locks because the node is shared by all connections.
+    void AddNodeReplicationState(Node* node, NodeReplicationState& nodeState);
+    /// Start tracking replication state of a component. Locks because the component is shared by all connections.
+    void AddComponentReplicationState(Component* component, NodeReplicationState& nodeState, ComponentReplicationState& componentState);
     /// Process a node that the client has not yet received.
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Update the set of relevant top-level nodes from the interest grid. Newly relevant nodes are marked dirty, others removed.
+    void UpdateInterest();
+    /// Return whether a node is within the interest area of this client.
+    bool IsNodeRelevant(Node* node) const;
+    /// Mark a node and its replicated descendants dirty, so that they are sent as new nodes.
+    void MarkInterestDirty(Node* node);
+    /// Remove a node that left the interest area from the client, and stop tracking it and its descendants.
+    void RemoveIrrelevantNode(Node* node);
+    /// Stop tracking replication state of a node and its descendants.
+    void RemoveNodeReplicationState(Node* node);
+    /// Write latest data of nodes and components changed since the last acknowledged snapshot, split into unreliable parts.
+    void SendSnapshot();
+    /// Reset snapshot state when the scene changes.
+    void ResetSnapshots();
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Process unknown message. All unknown messages are forwarded as an events
     void ProcessUnknownMessage(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set).
     bool RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg);
-    /// Initiate a package download.
+    /// Queue a package download. The download is started by ContinuePackageDownloads().
     void RequestPackage(const ea::string& name, unsigned fileSize, unsigned checksum);
+    /// Open the partial file of a package download and request the fragments not yet received. Does not finish the download if the partial file is already complete.
+    void RequestPackageData(PackageDownload& download);
+    /// Start the next package download, or finish downloads whose fragments have all been written. Call OnPackagesReady() once no downloads remain.
+    void ContinuePackageDownloads();
+    /// Finish a package download after all fragments have been written. Return true on success, or false if the download failed and all downloads were cleared.
+    bool OnPackageDownloadFinished(StringHash nameHash);
     /// Send an error reply for a package download.
     void SendPackageError(const ea::string& name);
     /// Handle scene load failure on the server or client.
     void OnSceneLoadFailed();
     /// Handle a package download failure on the client.
     void OnPackageDownloadFailed(const ea::string& name);
-    /// Handle all packages loaded successfully. Also called directly on MSG_LOADSCENE if there are none.
+    /// Handle all packages loaded successfully. Also called on MSG_LOADSCENE if there are no downloads.
     void OnPackagesReady();
 
     /// Scene.
@@ -332,9 +412,15 @@ private:
     ea::unordered_map<StringHash, PackageDownload> downloads_;
     /// Ongoing package send transfers.
     ea::unordered_map<StringHash, PackageUpload> uploads_;
-    /// Pending latest data for not yet received nodes.
+    /// Maximum rate of package data sent in bytes per second, or 0 for unlimited.
+    unsigned packageSendRate_{};
+    /// Bytes of package data that may be sent now without exceeding the send rate.
+    float packageSendBudget_{};
+    /// Package send budget refill timer.
+    Timer packageSendTimer_;
+    /// Pending latest data for not yet received nodes, prefixed with the server time stamp.
     ea::unordered_map<unsigned, ea::vector<unsigned char> > nodeLatestData_;
-    /// Pending latest data for not yet received components.
+    /// Pending latest data for not yet received components, prefixed with the server time stamp.
     ea::unordered_map<unsigned, ea::vector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     ea::hash_set<unsigned> nodesToProcess_;
@@ -352,6 +438,16 @@ private:
     Vector3 position_;
     /// Observer rotation for interest management.
     Quaternion rotation_;
+    /// Interest radius around the observer position.
+    float interestRadius_{};
+    /// Whether interest management was in use on the last update.
+    bool interestManaged_{};
+    /// Top-level node IDs within the interest area.
+    ea::hash_set<unsigned> relevantNodes_;
+    /// Top-level node IDs within the interest area, being rebuilt.
+    ea::hash_set<unsigned> newRelevantNodes_;
+    /// Interest grid query result.
+    ea::vector<unsigned> interestQuery_;
     /// Send mode for the observer position & rotation.
     ObserverPositionSendMode sendMode_;
     /// Client connection flag.
@@ -378,6 +474,54 @@ private:
     ea::unordered_map<int, VectorBuffer> outgoingBuffer_;
     /// Outgoing packet size limit
     int packedMessageLimit_;
+    /// Packets completed while sends are deferred.
+    ea::vector<ea::pair<PacketType, VectorBuffer> > deferredPackets_;
+    /// Number of packets in use in the deferred packet list. The rest keep their buffers for reuse.
+    unsigned numDeferredPackets_{};
+    /// Whether to defer sending completed packets.
+    bool deferSends_{};
+    /// Whether latest data is sent in snapshots.
+    bool snapshotReplication_{};
+    /// Node IDs with latest data not yet acknowledged by the client, mapped to the frame of their latest change.
+    ea::unordered_map<unsigned, unsigned> snapshotNodes_;
+    /// Component IDs with latest data not yet acknowledged by the client, mapped to the frame of their latest change.
+    ea::unordered_map<unsigned, unsigned> snapshotComponents_;
+    /// Reusable snapshot part buffers.
+    ea::vector<VectorBuffer> snapshotParts_;
+    /// Latest snapshot frame acknowledged by the client. Used on the server.
+    unsigned ackedSnapshotFrame_{};
+    /// Snapshot frame being received. Used on the client.
+    unsigned snapshotFrame_{};
+    /// Received parts of the snapshot being received. Used on the client.
+    ea::vector<bool> snapshotPartsReceived_;
+    /// Number of received parts of the snapshot being received. Used on the client.
+    unsigned numSnapshotPartsReceived_{};
+    /// Latest fully received snapshot frame to acknowledge. Used on the client.
+    unsigned completeSnapshotFrame_{};
+    /// Local clock for server time synchronization. Used on the client.
+    HiresTimer clockTimer_;
+    /// Whether the clock has been synchronized.
+    bool clockSynchronized_{};
+    /// Whether any server time has been received.
+    bool serverTimeReceived_{};
+    /// Server system time from which synchronized time is measured.
+    unsigned serverTimeBase_{};
+    /// Recent samples of the offset from local to server time in milliseconds.
+    ea::vector<double> clockOffsetSamples_;
+    /// Next clock offset sample to overwrite.
+    unsigned clockOffsetIndex_{};
+    /// Offset from local to server time in milliseconds.
+    double clockOffset_{};
+    /// Latest received server time in milliseconds.
+    double lastServerTime_{};
+    /// Local time of receiving the latest server time in milliseconds.
+    double lastArrivalTime_{};
+    /// Smoothed interval between server updates in milliseconds.
+    float updateInterval_{};
+    /// Smoothed deviation of server update arrival intervals in milliseconds.
+    float jitter_{};
+    /// Interpolation delay in milliseconds.
+    float interpolationDelay_{};
 };
 
 }
@@ -0,0 +1,654 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../IO/Log.h"
+#include "../Network/HttpClient.h"
+
+#include <Civetweb/civetweb.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned ERROR_BUFFER_SIZE = 256;
+static const unsigned READ_CHUNK_SIZE = 16384;
+/// Undispatched response data at which the worker thread waits for the main thread.
+static const unsigned MAX_UNDISPATCHED_DATA = 1024 * 1024;
+/// Number of times a request is sent before failing when no response arrives, e.g. because a kept-alive connection was closed by the server.
+static const unsigned MAX_REQUEST_ATTEMPTS = 2;
+
+/// %HTTP client worker thread.
+class HttpClientWorker : public Thread, public RefCounted
+{
+public:
+    /// Construct.
+    explicit HttpClientWorker(HttpClient* owner) :
+        Thread("HttpClientWorker"),
+        owner_(owner),
+        readBuffer_(READ_CHUNK_SIZE)
+    {
+    }
+
+    /// Process requests until stopped.
+    void ThreadFunction() override
+    {
+        URHO3D_PROFILE_THREAD("HttpClientWorker");
+        owner_->ProcessRequests(this);
+    }
+
+    /// Return whether should keep running.
+    bool ShouldRun() const { return shouldRun_; }
+    /// Return read buffer.
+    unsigned char* GetReadBuffer() { return readBuffer_.data(); }
+    /// Return flag that interrupts opening a connection.
+    volatile int* GetStopFlag() { return &stopFlag_; }
+
+    /// Stop without waiting for the thread to exit, and interrupt the connection in use. Called from the main thread.
+    void Interrupt()
+    {
+        MutexLock lock(mutex_);
+        shouldRun_ = false;
+        stopFlag_ = 1;
+        if (connection_)
+            mg_interrupt_connection(connection_);
+    }
+
+    /// Set connection in use, or null when done with it. Return false if interrupted.
+    bool SetConnection(mg_connection* connection)
+    {
+        MutexLock lock(mutex_);
+        if (connection && !shouldRun_)
+            return false;
+        connection_ = connection;
+        return true;
+    }
+
+private:
+    /// HTTP client.
+    HttpClient* owner_;
+    /// Read buffer.
+    ea::vector<unsigned char> readBuffer_;
+    /// Mutex for the connection in use.
+    Mutex mutex_;
+    /// Connection in use.
+    mg_connection* connection_{};
+    /// Flag that interrupts opening a connection.
+    volatile int stopFlag_{};
+};
+
+HttpClientRequest::HttpClientRequest(const ea::string& url, const ea::string& verb, const ea::vector<ea::string>& headers, const ea::string& postData) :
+    url_(url.trimmed()),
+    verb_(!verb.empty() ? verb : "GET"),
+    headers_(headers),
+    postData_(postData)
+{
+    ea::string protocol = "http";
+    unsigned protocolEnd = url_.find("://");
+    if (protocolEnd != ea::string::npos)
+    {
+        protocol = url_.substr(0, protocolEnd);
+        host_ = url_.substr(protocolEnd + 3);
+    }
+    else
+        host_ = url_;
+
+    unsigned pathStart = host_.find('/');
+    if (pathStart != ea::string::npos)
+    {
+        path_ = host_.substr(pathStart);
+        host_ = host_.substr(0, pathStart);
+    }
+
+    ssl_ = protocol.comparei("https") == 0;
+    unsigned portStart = host_.find(':');
+    if (portStart != ea::string::npos)
+    {
+        port_ = ToInt(host_.substr(portStart + 1));
+        host_ = host_.substr(0, portStart);
+    }
+    else if (ssl_)
+        port_ = 443;
+
+    connectionKey_ = Format("{}:{}{}", host_, port_, ssl_ ? "/s" : "");
+}
+
+void HttpClientRequest::Cancel()
+{
+    MutexLock lock(mutex_);
+    cancelled_ = true;
+
+    // Interrupt the worker thread waiting for the response, or for the main thread to take the received data
+    if (workerConnection_)
+    {
+        mg_interrupt_connection(workerConnection_);
+        workerConnection_ = nullptr;
+    }
+    dataTaken_.Set();
+}
+
+const ea::string& HttpClientRequest::GetResponseHeader(const ea::string& name) const
+{
+    for (const auto& header : responseHeaders_)
+    {
+        if (header.first.comparei(name) == 0)
+            return header.second;
+    }
+
+    return EMPTY_STRING;
+}
+
+bool HttpClientRequest::IsCancelled() const
+{
+    MutexLock lock(mutex_);
+    return cancelled_;
+}
+
+bool HttpClientRequest::SetWorkerConnection(mg_connection* connection)
+{
+    MutexLock lock(mutex_);
+    workerConnection_ = cancelled_ ? nullptr : connection;
+    return !cancelled_;
+}
+
+bool HttpClientRequest::Dispatch()
+{
+    ea::vector<unsigned char> data;
+    {
+        MutexLock lock(mutex_);
+        state_ = workerState_;
+        statusCode_ = workerStatusCode_;
+        error_ = workerError_;
+        if (responseHeaders_.size() != workerResponseHeaders_.size())
+            responseHeaders_ = workerResponseHeaders_;
+        data.swap(incomingData_);
+    }
+
+    if (!data.empty())
+    {
+        dataTaken_.Set();
+        bytesReceived_ += data.size();
+        if (onData_)
+            onData_(this, data.data(), data.size());
+        else
+            body_.insert(body_.end(), data.begin(), data.end());
+    }
+
+    if (!IsDone())
+        return false;
+
+    if (onComplete_)
+        onComplete_(this);
+    return true;
+}
+
+HttpClient::HttpClient(Context* context) :
+    Object(context)
+{
+#ifdef URHO3D_SSL
+    static bool sslInitialized = false;
+    if (!sslInitialized)
+    {
+        mg_init_library(MG_FEATURES_TLS);
+        sslInitialized = true;
+    }
+#endif
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(HttpClient, HandleBeginFrame));
+}
+
+HttpClient::~HttpClient()
+{
+    // Stop the workers first, so that they do not return connections to the pool any more. Wake up the idle workers and
+    // interrupt the connections and data deliveries the others are waiting on
+    for (HttpClientWorker* worker : workers_)
+        worker->Interrupt();
+    requestsQueued_.Set();
+    for (HttpClientRequest* request : activeRequests_)
+        request->dataTaken_.Set();
+    for (HttpClientWorker* worker : workers_)
+        worker->Stop();
+    workers_.clear();
+
+    for (auto& pair : idleConnections_)
+    {
+        for (IdleConnection& idle : pair.second)
+            mg_close_connection(idle.connection_);
+    }
+    idleConnections_.clear();
+}
+
+SharedPtr<HttpClientRequest> HttpClient::Send(const ea::string& url, const ea::string& verb, const ea::vector<ea::string>& headers,
+    const ea::string& postData)
+{
+    URHO3D_PROFILE("SendHttpRequest");
+
+    SharedPtr<HttpClientRequest> request(new HttpClientRequest(url, verb, headers, postData));
+    activeRequests_.push_back(request);
+
+    if (request->host_.empty())
+    {
+        SetRequestState(request, HTTP_REQUEST_FAILED, "No host in URL " + request->url_);
+        return request;
+    }
+
+#ifdef URHO3D_THREADING
+    URHO3D_LOGDEBUG("HTTP " + request->verb_ + " request to URL " + request->url_);
+
+    if (workers_.empty())
+        StartWorkers();
+
+    {
+        MutexLock lock(queueMutex_);
+        queue_.push_back(request);
+    }
+    requestsQueued_.Set();
+#else
+    SetRequestState(request, HTTP_REQUEST_FAILED, "HTTP request will not execute as threading is disabled");
+#endif
+
+    return request;
+}
+
+void HttpClient::SetNumWorkers(unsigned num)
+{
+    if (!workers_.empty())
+    {
+        URHO3D_LOGWARNING("Can not change number of HTTP client workers after sending requests");
+        return;
+    }
+
+    numWorkers_ = Max(num, 1U);
+}
+
+unsigned HttpClient::GetNumQueuedRequests() const
+{
+    MutexLock lock(queueMutex_);
+    return queue_.size();
+}
+
+unsigned HttpClient::GetNumIdleConnections() const
+{
+    MutexLock lock(connectionMutex_);
+    unsigned num = 0;
+    for (const auto& pair : idleConnections_)
+        num += pair.second.size();
+    return num;
+}
+
+void HttpClient::StartWorkers()
+{
+    for (unsigned i = 0; i < numWorkers_; ++i)
+    {
+        SharedPtr<HttpClientWorker> worker(new HttpClientWorker(this));
+        worker->Run();
+        workers_.push_back(worker);
+    }
+}
+
+void HttpClient::ProcessRequests(HttpClientWorker* worker)
+{
+    ea::vector<SharedPtr<HttpClientRequest> > batch;
+
+    while (worker->ShouldRun())
+    {
+        if (!TakeRequests(batch))
+        {
+            requestsQueued_.Wait();
+            continue;
+        }
+
+        ExecuteRequests(worker, batch);
+        batch.clear();
+    }
+
+    // Pass the wake-up on to the other stopping workers
+    requestsQueued_.Set();
+}
+
+bool HttpClient::TakeRequests(ea::vector<SharedPtr<HttpClientRequest> >& batch)
+{
+    MutexLock lock(queueMutex_);
+
+    while (!queue_.empty() && batch.empty())
+    {
+        SharedPtr<HttpClientRequest> request = queue_.front();
+        queue_.pop_front();
+        if (request->IsCancelled())
+            SetRequestState(request, HTTP_REQUEST_FAILED, "Cancelled");
+        else
+            batch.push_back(request);
+    }
+
+    if (batch.empty())
+        return false;
+
+    // Pipeline further requests to the same server, but leave enough for the other workers to stay busy
+    HttpClientRequest* first = batch.front();
+    if (first->IsPipelinable())
+    {
+        const unsigned maxBatchSize = Min(pipelineDepth_, Max((unsigned)(queue_.size() + 1) / numWorkers_, 1U));
+        for (auto i = queue_.begin(); i != queue_.end() && batch.size() < maxBatchSize;)
+        {
+            HttpClientRequest* request = *i;
+            if (request->connectionKey_ == first->connectionKey_ && request->IsPipelinable() && !request->IsCancelled())
+            {
+                batch.push_back(*i);
+                i = queue_.erase(i);
+                ++numPipelinedRequests_;
+            }
+            else
+                ++i;
+        }
+    }
+
+    for (HttpClientRequest* request : batch)
+    {
+        ++request->attempts_;
+        SetRequestState(request, HTTP_REQUEST_ACTIVE);
+    }
+
+    // Wake up another worker for the requests left in the queue
+    if (!queue_.empty())
+        requestsQueued_.Set();
+
+    return true;
+}
+
+void HttpClient::RetryRequests(const ea::vector<SharedPtr<HttpClientRequest> >& requests, bool reused, const ea::string& error)
+{
+    MutexLock lock(queueMutex_);
+
+    // Keep the original order at the front of the queue
+    for (auto i = requests.rbegin(); i != requests.rend(); ++i)
+    {
+        HttpClientRequest* request = *i;
+        if (request->attempts_ < MAX_REQUEST_ATTEMPTS && (request->IsPipelinable() || reused))
+        {
+            SetRequestState(request, HTTP_REQUEST_QUEUED);
+            queue_.push_front(*i);
+        }
+        else
+            SetRequestState(request, HTTP_REQUEST_FAILED, error);
+    }
+
+    if (!queue_.empty())
+        requestsQueued_.Set();
+}
+
+void HttpClient::ExecuteRequests(HttpClientWorker* worker, ea::vector<SharedPtr<HttpClientRequest> >& batch)
+{
+    HttpClientRequest* first = batch.front();
+
+    bool reused = false;
+    ea::string error;
+    mg_connection* connection = AcquireConnection(worker, first, reused, error);
+    if (!connection)
+    {
+        for (HttpClientRequest* request : batch)
+            SetRequestState(request, HTTP_REQUEST_FAILED, error);
+        return;
+    }
+
+    // Let stopping the worker interrupt the connection
+    if (!worker->SetConnection(connection))
+    {
+        mg_close_connection(connection);
+        for (HttpClientRequest* request : batch)
+            SetRequestState(request, HTTP_REQUEST_FAILED, "HTTP client stopped");
+        return;
+    }
+
+    // Send all requests in one write before reading the responses
+    const ea::string hostHeader = first->port_ != (first->ssl_ ? 443 : 80) ? Format("{}:{}", first->host_, first->port_) : first->host_;
+    ea::string message;
+    for (HttpClientRequest* request : batch)
+    {
+        message += Format("{} {} HTTP/1.1\r\nHost: {}\r\n", request->verb_, request->path_, hostHeader);
+        for (const ea::string& header : request->headers_)
+        {
+            // Trim and only add non-empty header strings
+            ea::string trimmedHeader = header.trimmed();
+            if (trimmedHeader.length())
+                message += trimmedHeader + "\r\n";
+        }
+        message += "Connection: keep-alive\r\n";
+        if (!request->postData_.empty())
+            message += Format("Content-Length: {}\r\n", request->postData_.length());
+        message += "\r\n";
+        message += request->postData_;
+    }
+
+    if (mg_write(connection, message.data(), message.length()) != (int)message.length())
+    {
+        // Connection is unusable. Nothing has been answered yet, so every request of the batch can be retried
+        worker->SetConnection(nullptr);
+        mg_close_connection(connection);
+        RetryRequests(batch, reused, "Failed to send requests");
+        return;
+    }
+
+    if (reused)
+        ++numConnectionsReused_;
+
+    for (unsigned i = 0; i < batch.size(); ++i)
+    {
+        // Let cancelling the request interrupt the connection while its response is read
+        ResponseResult result = RESPONSE_FAILED;
+        if (batch[i]->SetWorkerConnection(connection))
+        {
+            result = ReadResponse(worker, connection, batch[i]);
+            if (!batch[i]->SetWorkerConnection(nullptr) && result == RESPONSE_KEEPALIVE)
+                result = RESPONSE_CLOSE;
+        }
+        if (result == RESPONSE_KEEPALIVE)
+            continue;
+
+        worker->SetConnection(nullptr);
+        mg_close_connection(connection);
+
+        // Requests after the last answered one were not processed by the server
+        ea::vector<SharedPtr<HttpClientRequest> > unanswered(batch.begin() + (result == RESPONSE_NONE ? i : i + 1), batch.end());
+        if (result == RESPONSE_FAILED)
+            SetRequestState(batch[i], HTTP_REQUEST_FAILED, batch[i]->IsCancelled() ? "Cancelled" : "Failed to read response");
+        if (result != RESPONSE_NONE)
+        {
+            // The connection ended after an earlier response, which does not count as a failed attempt
+            for (HttpClientRequest* request : unanswered)
+                --request->attempts_;
+        }
+        if (!unanswered.empty())
+            RetryRequests(unanswered, reused, "No response received");
+        return;
+    }
+
+    worker->SetConnection(nullptr);
+    ReleaseConnection(first->connectionKey_, connection);
+}
+
+HttpClient::ResponseResult HttpClient::ReadResponse(HttpClientWorker* worker, mg_connection* connection, HttpClientRequest* request)
+{
+    char errorBuffer[ERROR_BUFFER_SIZE];
+    memset(errorBuffer, 0, sizeof(errorBuffer));
+
+    // A request interrupted by cancelling or stopping must not be retried
+    if (mg_get_response(connection, errorBuffer, sizeof(errorBuffer), responseTimeout_) < 0)
+        return request->IsCancelled() || !worker->ShouldRun() ? RESPONSE_FAILED : RESPONSE_NONE;
+
+    const mg_response_info* info = mg_get_response_info(connection);
+    const int statusCode = info->status_code;
+    bool chunked = false;
+    bool keepAlive = info->http_version && !strcmp(info->http_version, "1.1");
+
+    {
+        MutexLock lock(request->mutex_);
+        request->workerStatusCode_ = statusCode;
+        request->workerResponseHeaders_.clear();
+        for (int i = 0; i < info->num_headers; ++i)
+        {
+            const ea::string name = info->http_headers[i].name;
+            const ea::string value = info->http_headers[i].value;
+            if (name.comparei("Transfer-Encoding") == 0)
+                chunked = value.comparei("chunked") == 0;
+            else if (name.comparei("Connection") == 0)
+                keepAlive = value.comparei("keep-alive") == 0 || (keepAlive && value.comparei("close") != 0);
+            request->workerResponseHeaders_.emplace_back(name, value);
+        }
+    }
+
+    // Read the body, unless the response never has one
+    const bool hasBody = request->verb_ != "HEAD" && statusCode >= 200 && statusCode != 204 && statusCode != 304;
+    const long long contentLength = chunked ? -1 : info->content_length;
+    if (hasBody)
+    {
+        // Without length or chunked encoding the body ends when the server closes the connection
+        if (contentLength < 0 && !chunked)
+            keepAlive = false;
+
+        long long remaining = contentLength;
+        while (remaining != 0)
+        {
+            unsigned readSize = remaining > 0 ? (unsigned)Min(remaining, (long long)READ_CHUNK_SIZE) : READ_CHUNK_SIZE;
+            int bytesRead = mg_read(connection, worker->GetReadBuffer(), readSize);
+            if (bytesRead < 0 || (bytesRead == 0 && remaining > 0))
+                return RESPONSE_FAILED;
+            if (bytesRead == 0)
+            {
+                // Without a length, the end of the body is not told apart from an interrupted connection
+                if (request->IsCancelled() || !worker->ShouldRun())
+                    return RESPONSE_FAILED;
+                break;
+            }
+
+            if (!DeliverData(worker, request, worker->GetReadBuffer(), (unsigned)bytesRead))
+                return RESPONSE_FAILED;
+            if (remaining > 0)
+                remaining -= bytesRead;
+        }
+    }
+
+    SetRequestState(request, HTTP_REQUEST_COMPLETED);
+    return keepAlive ? RESPONSE_KEEPALIVE : RESPONSE_CLOSE;
+}
+
+bool HttpClient::DeliverData(HttpClientWorker* worker, HttpClientRequest* request, const unsigned char* data, unsigned size)
+{
+    for (;;)
+    {
+        {
+            MutexLock lock(request->mutex_);
+            if (request->cancelled_ || !worker->ShouldRun())
+                return false;
+
+            if (request->incomingData_.size() < MAX_UNDISPATCHED_DATA)
+            {
+                request->incomingData_.insert(request->incomingData_.end(), data, data + size);
+                return true;
+            }
+        }
+
+        // Wait until the main thread has caught up
+        request->dataTaken_.Wait();
+    }
+}
+
+mg_connection* HttpClient::AcquireConnection(HttpClientWorker* worker, HttpClientRequest* request, bool& reused, ea::string& error)
+{
+    {
+        MutexLock lock(connectionMutex_);
+        auto i = idleConnections_.find(request->connectionKey_);
+        if (i != idleConnections_.end())
+        {
+            ea::vector<IdleConnection>& connections = i->second;
+            while (!connections.empty())
+            {
+                IdleConnection idle = connections.back();
+                connections.pop_back();
+                if (idle.idleTimer_.GetMSec(false) < keepAliveTimeout_)
+                {
+                    reused = true;
+                    return idle.connection_;
+                }
+                mg_close_connection(idle.connection_);
+            }
+        }
+    }
+
+    // Open a new connection. This may block due to DNS query, but waiting for the server ends when the worker is stopped
+    char errorBuffer[ERROR_BUFFER_SIZE];
+    memset(errorBuffer, 0, sizeof(errorBuffer));
+    mg_connection* connection = mg_connect_client_interruptible(request->host_.c_str(), request->port_, request->ssl_ ? 1 : 0,
+        errorBuffer, sizeof(errorBuffer), worker->GetStopFlag());
+    if (!connection)
+        error = ea::string(&errorBuffer[0]);
+    else
+        ++numConnectionsOpened_;
+
+    reused = false;
+    return connection;
+}
+
+void HttpClient::ReleaseConnection(const ea::string& key, mg_connection* connection)
+{
+    {
+        MutexLock lock(connectionMutex_);
+        unsigned numIdle = 0;
+        for (const auto& pair : idleConnections_)
+            numIdle += pair.second.size();
+
+        if (numIdle < maxIdleConnections_)
+        {
+            idleConnections_[key].push_back(IdleConnection{ connection, Timer() });
+            return;
+        }
+    }
+
+    mg_close_connection(connection);
+}
+
+void HttpClient::SetRequestState(HttpClientRequest* request, HttpClientRequestState state, const ea::string& error)
+{
+    MutexLock lock(request->mutex_);
+    request->workerState_ = state;
+    request->workerError_ = error;
+}
+
+void HttpClient::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Callbacks may send new requests, which are appended to the list
+    for (unsigned i = 0; i < activeRequests_.size();)
+    {
+        SharedPtr<HttpClientRequest> request = activeRequests_[i];
+        if (request->Dispatch())
+            activeRequests_.erase(activeRequests_.begin() + i);
+        else
+            ++i;
+    }
+}
+
+}
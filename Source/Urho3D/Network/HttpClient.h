@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include <EASTL/deque.h>
+#include <EASTL/functional.h>
+#include <EASTL/unordered_map.h>
+
+#include <atomic>
+
+#include "../Core/Condition.h"
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+
+struct mg_connection;
+
+namespace Urho3D
+{
+
+class HttpClient;
+class HttpClientRequest;
+class HttpClientWorker;
+
+/// HTTP client request state.
+enum HttpClientRequestState
+{
+    HTTP_REQUEST_QUEUED = 0,
+    HTTP_REQUEST_ACTIVE,
+    HTTP_REQUEST_COMPLETED,
+    HTTP_REQUEST_FAILED
+};
+
+/// Callback receiving a part of the response body.
+using HttpDataCallback = ea::function<void(HttpClientRequest* request, const unsigned char* data, unsigned size)>;
+/// Callback called once the request has completed or failed.
+using HttpCompleteCallback = ea::function<void(HttpClientRequest* request)>;
+
+/// An asynchronous HTTP request executed by HttpClient. Callbacks are invoked in the main thread at the beginning of the frame, so they may be set after sending the request within the same frame.
+class URHO3D_API HttpClientRequest : public RefCounted
+{
+public:
+    /// Construct with parameters.
+    HttpClientRequest(const ea::string& url, const ea::string& verb, const ea::vector<ea::string>& headers, const ea::string& postData);
+
+    /// Set callback receiving the response body as it arrives. If not set, the body is accumulated and can be retrieved with GetBody().
+    void SetDataCallback(const HttpDataCallback& callback) { onData_ = callback; }
+    /// Set callback called once the request has completed or failed.
+    void SetCompleteCallback(const HttpCompleteCallback& callback) { onComplete_ = callback; }
+    /// Cancel the request. A request already waiting for or receiving its response closes the connection.
+    void Cancel();
+
+    /// Return URL used in the request.
+    const ea::string& GetURL() const { return url_; }
+    /// Return verb used in the request. Default GET if empty verb specified on construction.
+    const ea::string& GetVerb() const { return verb_; }
+    /// Return request state.
+    HttpClientRequestState GetState() const { return state_; }
+    /// Return whether the request has completed or failed.
+    bool IsDone() const { return state_ == HTTP_REQUEST_COMPLETED || state_ == HTTP_REQUEST_FAILED; }
+    /// Return HTTP status code of the response, or 0 if not received yet.
+    int GetStatusCode() const { return statusCode_; }
+    /// Return error. Only non-empty in the failed state.
+    const ea::string& GetError() const { return error_; }
+    /// Return response header value by case-insensitive name, or empty if not found.
+    const ea::string& GetResponseHeader(const ea::string& name) const;
+    /// Return all response headers as name-value pairs.
+    const ea::vector<ea::pair<ea::string, ea::string> >& GetResponseHeaders() const { return responseHeaders_; }
+    /// Return accumulated response body. Empty if a data callback is set.
+    const ea::vector<unsigned char>& GetBody() const { return body_; }
+    /// Return number of response body bytes received so far.
+    unsigned long long GetBytesReceived() const { return bytesReceived_; }
+
+private:
+    friend class HttpClient;
+
+    /// Return whether the request may be pipelined with others on the same connection.
+    bool IsPipelinable() const { return postData_.empty() && (verb_ == "GET" || verb_ == "HEAD"); }
+    /// Return whether the request has been cancelled. Called from the worker thread.
+    bool IsCancelled() const;
+    /// Set connection the worker thread is reading the response from, so that cancelling interrupts it, or null when done. Return false if cancelled when setting, or if cancelled meanwhile when clearing.
+    bool SetWorkerConnection(mg_connection* connection);
+    /// Copy state and response data received by the worker thread and invoke callbacks. Return true once done.
+    bool Dispatch();
+
+    /// URL.
+    ea::string url_;
+    /// Verb.
+    ea::string verb_;
+    /// Headers.
+    ea::vector<ea::string> headers_;
+    /// POST data.
+    ea::string postData_;
+    /// Server host name parsed from the URL.
+    ea::string host_;
+    /// Server port parsed from the URL.
+    int port_{ 80 };
+    /// Whether to use HTTPS.
+    bool ssl_{};
+    /// Request path parsed from the URL.
+    ea::string path_{ "/" };
+    /// Key of the connection pool the request uses.
+    ea::string connectionKey_;
+    /// Number of times the request has been sent without receiving a response.
+    unsigned attempts_{};
+
+    /// Data callback.
+    HttpDataCallback onData_;
+    /// Completion callback.
+    HttpCompleteCallback onComplete_;
+    /// Request state seen by the main thread.
+    HttpClientRequestState state_{ HTTP_REQUEST_QUEUED };
+    /// Status code seen by the main thread.
+    int statusCode_{};
+    /// Error seen by the main thread.
+    ea::string error_;
+    /// Response headers seen by the main thread.
+    ea::vector<ea::pair<ea::string, ea::string> > responseHeaders_;
+    /// Accumulated response body.
+    ea::vector<unsigned char> body_;
+    /// Response body bytes dispatched to the main thread.
+    unsigned long long bytesReceived_{};
+
+    /// Mutex for synchronizing the worker and the main thread.
+    mutable Mutex mutex_;
+    /// Request state set by the worker thread.
+    HttpClientRequestState workerState_{ HTTP_REQUEST_QUEUED };
+    /// Status code set by the worker thread.
+    int workerStatusCode_{};
+    /// Error set by the worker thread.
+    ea::string workerError_;
+    /// Response headers set by the worker thread.
+    ea::vector<ea::pair<ea::string, ea::string> > workerResponseHeaders_;
+    /// Response data received by the worker thread and not yet dispatched.
+    ea::vector<unsigned char> incomingData_;
+    /// Connection the worker thread is reading the response from.
+    mg_connection* workerConnection_{};
+    /// Cancelled flag.
+    bool cancelled_{};
+    /// Condition set when the main thread takes the received data or the request is cancelled.
+    Condition dataTaken_;
+};
+
+/// %HTTP client subsystem. Executes requests asynchronously on a fixed pool of worker threads, keeps connections alive between requests to the same server and pipelines idempotent requests on them.
+class URHO3D_API HttpClient : public Object
+{
+    URHO3D_OBJECT(HttpClient, Object);
+
+public:
+    /// Construct.
+    explicit HttpClient(Context* context);
+    /// Destruct. Stop the worker threads and close the kept-alive connections.
+    ~HttpClient() override;
+
+    /// Queue a request and return the request object. Worker threads are started on the first request.
+    SharedPtr<HttpClientRequest> Send(const ea::string& url, const ea::string& verb = EMPTY_STRING, const ea::vector<ea::string>& headers = ea::vector<ea::string>(), const ea::string& postData = EMPTY_STRING);
+
+    /// Set number of worker threads. Must be called before sending the first request.
+    void SetNumWorkers(unsigned num);
+    /// Set maximum number of requests sent on one connection before reading their responses. 1 disables pipelining.
+    void SetPipelineDepth(unsigned depth) { pipelineDepth_ = Max(depth, 1U); }
+    /// Set maximum number of idle connections kept alive. 0 disables keep-alive.
+    void SetMaxIdleConnections(unsigned num) { maxIdleConnections_ = num; }
+    /// Set time in milliseconds after which an idle connection is closed.
+    void SetKeepAliveTimeout(unsigned ms) { keepAliveTimeout_ = ms; }
+    /// Set time in milliseconds to wait for the response header.
+    void SetResponseTimeout(unsigned ms) { responseTimeout_ = ms; }
+
+    /// Return number of worker threads.
+    unsigned GetNumWorkers() const { return numWorkers_; }
+    /// Return maximum number of requests sent on one connection before reading their responses.
+    unsigned GetPipelineDepth() const { return pipelineDepth_; }
+    /// Return maximum number of idle connections kept alive.
+    unsigned GetMaxIdleConnections() const { return maxIdleConnections_; }
+    /// Return time in milliseconds after which an idle connection is closed.
+    unsigned GetKeepAliveTimeout() const { return keepAliveTimeout_; }
+    /// Return time in milliseconds to wait for the response header.
+    unsigned GetResponseTimeout() const { return responseTimeout_; }
+    /// Return number of requests waiting for a worker thread.
+    unsigned GetNumQueuedRequests() const;
+    /// Return number of idle connections kept alive.
+    unsigned GetNumIdleConnections() const;
+    /// Return number of connections opened so far.
+    unsigned GetNumConnectionsOpened() const { return numConnectionsOpened_; }
+    /// Return number of times an idle connection has been reused so far.
+    unsigned GetNumConnectionsReused() const { return numConnectionsReused_; }
+    /// Return number of requests sent pipelined behind another request so far.
+    unsigned GetNumPipelinedRequests() const { return numPipelinedRequests_; }
+
+    /// Process requests until the worker is stopped. Called by the worker threads.
+    void ProcessRequests(HttpClientWorker* worker);
+
+private:
+    /// Kept-alive connection waiting for reuse.
+    struct IdleConnection
+    {
+        /// Civetweb connection.
+        mg_connection* connection_;
+        /// Time since the connection became idle.
+        Timer idleTimer_;
+    };
+
+    /// Outcome of reading a response.
+    enum ResponseResult
+    {
+        /// Response received, connection may be reused.
+        RESPONSE_KEEPALIVE = 0,
+        /// Response received, connection must be closed.
+        RESPONSE_CLOSE,
+        /// No response received, request may be retried.
+        RESPONSE_NONE,
+        /// Failed while receiving the response.
+        RESPONSE_FAILED
+    };
+
+    /// Start the worker threads.
+    void StartWorkers();
+    /// Take the next request and requests that can be pipelined with it from the queue. Return false if the queue is empty.
+    bool TakeRequests(ea::vector<SharedPtr<HttpClientRequest> >& batch);
+    /// Return requests that did not receive a response to the front of the queue, or fail them if retried already. Non-idempotent requests are only retried if sent on a reused connection, which the server may have closed meanwhile.
+    void RetryRequests(const ea::vector<SharedPtr<HttpClientRequest> >& requests, bool reused, const ea::string& error);
+    /// Send a batch of requests on one connection and receive their responses.
+    void ExecuteRequests(HttpClientWorker* worker, ea::vector<SharedPtr<HttpClientRequest> >& batch);
+    /// Read one response.
+    ResponseResult ReadResponse(HttpClientWorker* worker, mg_connection* connection, HttpClientRequest* request);
+    /// Pass response data to the main thread. Wait while too much data is undispatched. Return false if cancelled.
+    bool DeliverData(HttpClientWorker* worker, HttpClientRequest* request, const unsigned char* data, unsigned size);
+    /// Return an idle connection to the server or open a new one. Return null and fill error on failure.
+    mg_connection* AcquireConnection(HttpClientWorker* worker, HttpClientRequest* request, bool& reused, ea::string& error);
+    /// Keep a connection alive for reuse, or close it if there are too many idle connections.
+    void ReleaseConnection(const ea::string& key, mg_connection* connection);
+    /// Set request state and error from a worker thread.
+    void SetRequestState(HttpClientRequest* request, HttpClientRequestState state, const ea::string& error = EMPTY_STRING);
+    /// Dispatch request state and data to callbacks at the beginning of the frame.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Worker threads.
+    ea::vector<SharedPtr<HttpClientWorker> > workers_;
+    /// Requests sent but not yet done, owned by the main thread.
+    ea::vector<SharedPtr<HttpClientRequest> > activeRequests_;
+    /// Mutex for the request queue.
+    mutable Mutex queueMutex_;
+    /// Requests waiting for a worker thread.
+    ea::deque<SharedPtr<HttpClientRequest> > queue_;
+    /// Condition set when requests are queued or the workers are stopped.
+    Condition requestsQueued_;
+    /// Mutex for the idle connection pool.
+    mutable Mutex connectionMutex_;
+    /// Idle connections by host, port and protocol.
+    ea::unordered_map<ea::string, ea::vector<IdleConnection> > idleConnections_;
+    /// Number of worker threads.
+    unsigned numWorkers_{ 4 };
+    /// Maximum number of requests sent on one connection before reading their responses.
+    unsigned pipelineDepth_{ 4 };
+    /// Maximum number of idle connections kept alive.
+    unsigned maxIdleConnections_{ 16 };
+    /// Time in milliseconds after which an idle connection is closed.
+    unsigned keepAliveTimeout_{ 30000 };
+    /// Time in milliseconds to wait for the response header.
+    unsigned responseTimeout_{ 30000 };
+    /// Number of connections opened.
+    std::atomic<unsigned> numConnectionsOpened_{};
+    /// Number of times an idle connection has been reused.
+    std::atomic<unsigned> numConnectionsReused_{};
+    /// Number of requests sent pipelined behind another request.
+    std::atomic<unsigned> numPipelinedRequests_{};
+};
+
+}
@@ -0,0 +1,409 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include <EASTL/sort.h>
+
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/GraphicsEvents.h"
+#include "../IO/Log.h"
+#include "../Network/Connection.h"
+#include "../Network/MetricsServer.h"
+#include "../Network/Network.h"
+#include "../Resource/JSONFile.h"
+#include "../Resource/ResourceCache.h"
+#include "../Scene/Scene.h"
+
+#include <Civetweb/civetweb.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static const unsigned DEFAULT_FRAME_WINDOW = 600;
+static const float FRAME_TIME_QUANTILES[] = { 0.5f, 0.9f, 0.99f, 1.0f };
+
+static int HandleMetricsRequest(mg_connection* connection, void* data)
+{
+    return static_cast<MetricsServer*>(data)->HandleRequest(connection);
+}
+
+/// Escape a Prometheus label value.
+static ea::string EscapeLabelValue(const ea::string& value)
+{
+    ea::string ret;
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+            ret += '\\';
+        if (c == '\n')
+            ret += "\\n";
+        else
+            ret += c;
+    }
+    return ret;
+}
+
+MetricsServer::MetricsServer(Context* context) :
+    Object(context),
+    frameTimes_(DEFAULT_FRAME_WINDOW)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    Stop();
+}
+
+bool MetricsServer::Start(unsigned short port, const ea::string& address)
+{
+    Stop();
+
+    const ea::string listeningPorts = address.empty() ? ea::to_string(port) : Format("{}:{}", address, port);
+    const char* options[] = {
+        "listening_ports", listeningPorts.c_str(),
+        "num_threads", "2",
+        "enable_keep_alive", "yes",
+        "tcp_nodelay", "1",
+        nullptr
+    };
+
+    mg_callbacks callbacks{};
+    server_ = mg_start(&callbacks, nullptr, options);
+    if (!server_)
+    {
+        URHO3D_LOGERROR("Failed to start metrics server on " + listeningPorts);
+        return false;
+    }
+
+    mg_set_request_handler(server_, "/metrics", HandleMetricsRequest, this);
+    mg_set_request_handler(server_, "/metrics.json", HandleMetricsRequest, this);
+    port_ = port;
+
+    // Serve an initial sample right away
+    frameStarted_ = false;
+    numFrames_ = numFramesAtSample_ = 0;
+    Sample();
+
+    SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(MetricsServer, HandleBeginFrame));
+    SubscribeToEvent(E_POSTRENDERUPDATE, URHO3D_HANDLER(MetricsServer, HandleFrameWorkEnd));
+    SubscribeToEvent(E_ENDRENDERING, URHO3D_HANDLER(MetricsServer, HandleFrameWorkEnd));
+
+    URHO3D_LOGINFO("Serving metrics on " + listeningPorts);
+    return true;
+}
+
+void MetricsServer::Stop()
+{
+    if (!server_)
+        return;
+
+    // Waits for the server threads to finish
+    mg_stop(server_);
+    server_ = nullptr;
+    port_ = 0;
+
+    UnsubscribeFromEvent(E_BEGINFRAME);
+    UnsubscribeFromEvent(E_POSTRENDERUPDATE);
+    UnsubscribeFromEvent(E_ENDRENDERING);
+}
+
+void MetricsServer::SetFrameWindow(unsigned frames)
+{
+    frameTimes_.clear();
+    frameTimes_.resize(Max(frames, 1U));
+    numFrames_ = numFramesAtSample_ = 0;
+}
+
+void MetricsServer::AddScene(Scene* scene)
+{
+    if (scene && ea::find(scenes_.begin(), scenes_.end(), scene) == scenes_.end())
+        scenes_.push_back(WeakPtr<Scene>(scene));
+}
+
+void MetricsServer::RemoveScene(Scene* scene)
+{
+    auto i = ea::find(scenes_.begin(), scenes_.end(), scene);
+    if (i != scenes_.end())
+        scenes_.erase(i);
+}
+
+ea::string MetricsServer::GetPrometheusText() const
+{
+    MutexLock lock(sampleMutex_);
+    return prometheusText_;
+}
+
+ea::string MetricsServer::GetJSONText() const
+{
+    MutexLock lock(sampleMutex_);
+    return jsonText_;
+}
+
+int MetricsServer::HandleRequest(mg_connection* connection)
+{
+    const mg_request_info* info = mg_get_request_info(connection);
+    const bool head = !strcmp(info->request_method, "HEAD");
+    if (!head && strcmp(info->request_method, "GET") != 0)
+    {
+        mg_send_http_error(connection, 405, "%s", "Method not allowed");
+        return 405;
+    }
+
+    ea::string body;
+    const char* contentType;
+    if (!strcmp(info->local_uri, "/metrics"))
+    {
+        body = GetPrometheusText();
+        contentType = "text/plain; version=0.0.4; charset=utf-8";
+    }
+    else if (!strcmp(info->local_uri, "/metrics.json"))
+    {
+        body = GetJSONText();
+        contentType = "application/json";
+    }
+    else
+    {
+        mg_send_http_error(connection, 404, "%s", "Not found");
+        return 404;
+    }
+
+    // Send the header and body in one write
+    ea::string response = Format("HTTP/1.1 200 OK\r\nContent-Type: {}\r\nContent-Length: {}\r\nCache-Control: no-cache\r\n\r\n",
+        contentType, body.length());
+    if (!head)
+        response += body;
+    mg_write(connection, response.data(), response.length());
+    return 200;
+}
+
+void MetricsServer::Sample()
+{
+    URHO3D_PROFILE("SampleMetrics");
+
+    JSONValue root;
+    ea::string text;
+
+    auto addMetric = [&text](const char* name, const char* type, const char* help)
+    {
+        text += Format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    };
+
+    // Time and frame times
+    auto* time = GetSubsystem<Time>();
+    const float uptime = time ? time->GetElapsedTime() : 0.0f;
+    root.Set("uptime", uptime);
+    addMetric("urho3d_uptime_seconds", "gauge", "Time since the engine was started.");
+    text += Format("urho3d_uptime_seconds {}\n", uptime);
+
+    const float elapsed = sampleTimer_.GetMSec(true) * 0.001f;
+    const float fps = elapsed > 0.0f ? (numFrames_ - numFramesAtSample_) / elapsed : 0.0f;
+    numFramesAtSample_ = numFrames_;
+
+    const unsigned numFrameTimes = (unsigned)Min(numFrames_, (unsigned long long)frameTimes_.size());
+    ea::vector<long long> sortedFrameTimes(frameTimes_.begin(), frameTimes_.begin() + numFrameTimes);
+    ea::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+    long long frameTimeSum = 0;
+    for (long long frameTime : sortedFrameTimes)
+        frameTimeSum += frameTime;
+
+    JSONValue frames;
+    frames.Set("fps", fps);
+    frames.Set("count", numFrameTimes);
+    addMetric("urho3d_frames_per_second", "gauge", "Frames per second since the previous sample.");
+    text += Format("urho3d_frames_per_second {}\n", fps);
+    addMetric("urho3d_frame_time_seconds", "summary", "Time spent in updating and rendering recent frames, excluding the frame limiter wait.");
+    for (float quantile : FRAME_TIME_QUANTILES)
+    {
+        const long long frameTime = numFrameTimes ? sortedFrameTimes[Min((unsigned)(quantile * numFrameTimes), numFrameTimes - 1)] : 0;
+        const ea::string key = quantile < 1.0f ? Format("p{}", RoundToInt(quantile * 100.0f)) : ea::string("max");
+        frames.Set(key, frameTime * 0.001);
+        text += Format("urho3d_frame_time_seconds{{quantile=\"{}\"}} {}\n", quantile, frameTime * 0.000001);
+    }
+    text += Format("urho3d_frame_time_seconds_sum {}\nurho3d_frame_time_seconds_count {}\n", frameTimeSum * 0.000001, numFrameTimes);
+    root.Set("frameTimeMs", frames);
+
+    // Work queue
+    if (auto* workQueue = GetSubsystem<WorkQueue>())
+    {
+        const unsigned numThreads = workQueue->GetNumThreads();
+        const unsigned numIncomplete = workQueue->GetNumIncomplete(0);
+        JSONValue queue;
+        queue.Set("threads", numThreads);
+        queue.Set("incomplete", numIncomplete);
+        root.Set("workQueue", queue);
+        addMetric("urho3d_workqueue_threads", "gauge", "Number of work queue worker threads.");
+        text += Format("urho3d_workqueue_threads {}\n", numThreads);
+        addMetric("urho3d_workqueue_incomplete_items", "gauge", "Number of queued or running work items.");
+        text += Format("urho3d_workqueue_incomplete_items {}\n", numIncomplete);
+    }
+
+    // Network connections. Their scenes are reported below
+    ea::vector<Scene*> scenes;
+    if (auto* network = GetSubsystem<Network>())
+    {
+        ea::vector<SharedPtr<Connection> > connections = network->GetClientConnections();
+        if (Connection* serverConnection = network->GetServerConnection())
+            connections.push_back(SharedPtr<Connection>(serverConnection));
+
+        float bytesIn = 0.0f;
+        float bytesOut = 0.0f;
+        int packetsIn = 0;
+        int packetsOut = 0;
+        for (Connection* connection : connections)
+        {
+            bytesIn += connection->GetBytesInPerSec();
+            bytesOut += connection->GetBytesOutPerSec();
+            packetsIn += connection->GetPacketsInPerSec();
+            packetsOut += connection->GetPacketsOutPerSec();
+            Scene* scene = connection->GetScene();
+            if (scene && ea::find(scenes.begin(), scenes.end(), scene) == scenes.end())
+                scenes.push_back(scene);
+        }
+
+        const bool serverRunning = network->IsServerRunning();
+        JSONValue net;
+        net.Set("serverRunning", serverRunning);
+        net.Set("connections", (unsigned)connections.size());
+        net.Set("bytesInPerSec", bytesIn);
+        net.Set("bytesOutPerSec", bytesOut);
+        net.Set("packetsInPerSec", packetsIn);
+        net.Set("packetsOutPerSec", packetsOut);
+        root.Set("network", net);
+        addMetric("urho3d_network_server_running", "gauge", "Whether the network server is running.");
+        text += Format("urho3d_network_server_running {}\n", serverRunning ? 1 : 0);
+        addMetric("urho3d_network_connections", "gauge", "Number of client connections, or the server connection on a client.");
+        text += Format("urho3d_network_connections {}\n", connections.size());
+        addMetric("urho3d_network_bytes_in_per_second", "gauge", "Bytes received per second over all connections.");
+        text += Format("urho3d_network_bytes_in_per_second {}\n", bytesIn);
+        addMetric("urho3d_network_bytes_out_per_second", "gauge", "Bytes sent per second over all connections.");
+        text += Format("urho3d_network_bytes_out_per_second {}\n", bytesOut);
+        addMetric("urho3d_network_packets_in_per_second", "gauge", "Packets received per second over all connections.");
+        text += Format("urho3d_network_packets_in_per_second {}\n", packetsIn);
+        addMetric("urho3d_network_packets_out_per_second", "gauge", "Packets sent per second over all connections.");
+        text += Format("urho3d_network_packets_out_per_second {}\n", packetsOut);
+    }
+
+    // Resource memory per type
+    if (auto* cache = GetSubsystem<ResourceCache>())
+    {
+        JSONValue types;
+        ea::string memoryText;
+        ea::string countText;
+        unsigned long long totalMemory = 0;
+        for (const auto& pair : cache->GetAllResources())
+        {
+            const ResourceGroup& group = pair.second;
+            if (group.resources_.empty())
+                continue;
+
+            const ea::string typeName = EscapeLabelValue(group.resources_.begin()->second->GetTypeName());
+            JSONValue type;
+            type.Set("count", (unsigned)group.resources_.size());
+            type.Set("memory", (double)group.memoryUse_);
+            types.Set(group.resources_.begin()->second->GetTypeName(), type);
+            memoryText += Format("urho3d_resource_memory_bytes{{type=\"{}\"}} {}\n", typeName, group.memoryUse_);
+            countText += Format("urho3d_resources{{type=\"{}\"}} {}\n", typeName, group.resources_.size());
+            totalMemory += group.memoryUse_;
+        }
+
+        JSONValue resources;
+        resources.Set("totalMemory", (double)totalMemory);
+        resources.Set("types", types);
+        root.Set("resources", resources);
+        addMetric("urho3d_resource_memory_bytes", "gauge", "Memory use of loaded resources by type.");
+        text += memoryText;
+        addMetric("urho3d_resources", "gauge", "Number of loaded resources by type.");
+        text += countText;
+    }
+
+    // Scene node counts
+    for (unsigned i = 0; i < scenes_.size();)
+    {
+        if (Scene* scene = scenes_[i])
+        {
+            if (ea::find(scenes.begin(), scenes.end(), scene) == scenes.end())
+                scenes.push_back(scene);
+            ++i;
+        }
+        else
+            scenes_.erase(scenes_.begin() + i);
+    }
+
+    JSONValue sceneArray(JSON_ARRAY);
+    ea::string replicatedText;
+    ea::string localText;
+    for (unsigned i = 0; i < scenes.size(); ++i)
+    {
+        Scene* scene = scenes[i];
+        const ea::string name = !scene->GetName().empty() ? scene->GetName() : Format("Scene{}", i);
+        JSONValue sceneValue;
+        sceneValue.Set("name", name);
+        sceneValue.Set("replicatedNodes", scene->GetNumReplicatedNodes());
+        sceneValue.Set("localNodes", scene->GetNumLocalNodes());
+        sceneArray.Push(sceneValue);
+        replicatedText += Format("urho3d_scene_nodes{{scene=\"{}\",kind=\"replicated\"}} {}\n", EscapeLabelValue(name), scene->GetNumReplicatedNodes());
+        localText += Format("urho3d_scene_nodes{{scene=\"{}\",kind=\"local\"}} {}\n", EscapeLabelValue(name), scene->GetNumLocalNodes());
+    }
+    root.Set("scenes", sceneArray);
+    addMetric("urho3d_scene_nodes", "gauge", "Number of nodes in the scene, including the scene itself.");
+    text += replicatedText;
+    text += localText;
+
+    JSONFile jsonFile(context_);
+    jsonFile.GetRoot() = root;
+
+    MutexLock lock(sampleMutex_);
+    prometheusText_ = ea::move(text);
+    jsonText_ = jsonFile.ToString("  ");
+}
+
+void MetricsServer::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    // Record the previous frame. If neither update nor rendering ended, count the whole frame
+    if (frameStarted_)
+    {
+        frameTimes_[numFrames_ % frameTimes_.size()] = frameWorkTime_ ? frameWorkTime_ : frameTimer_.GetUSec(false);
+        ++numFrames_;
+    }
+
+    frameTimer_.Reset();
+    frameWorkTime_ = 0;
+    frameStarted_ = true;
+
+    if (sampleTimer_.GetMSec(false) >= sampleInterval_ * 1000.0f)
+        Sample();
+}
+
+void MetricsServer::HandleFrameWorkEnd(StringHash eventType, VariantMap& eventData)
+{
+    if (frameStarted_)
+        frameWorkTime_ = frameTimer_.GetUSec(false);
+}
+
+}
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+
+struct mg_connection;
+struct mg_context;
+
+namespace Urho3D
+{
+
+class Scene;
+
+/// Embedded %HTTP endpoint exposing engine metrics for monitoring headless servers. Serves /metrics in Prometheus text format and /metrics.json in JSON. Metrics are sampled in the main thread at a fixed interval, and the server threads only return the last sample.
+class URHO3D_API MetricsServer : public Object
+{
+    URHO3D_OBJECT(MetricsServer, Object);
+
+public:
+    /// Construct.
+    explicit MetricsServer(Context* context);
+    /// Destruct. Stop the server.
+    ~MetricsServer() override;
+
+    /// Start serving on the given port, optionally bound to one address. Return true if successful.
+    bool Start(unsigned short port, const ea::string& address = EMPTY_STRING);
+    /// Stop serving.
+    void Stop();
+    /// Set interval in seconds between metric samples.
+    void SetSampleInterval(float interval) { sampleInterval_ = Max(interval, 0.0f); }
+    /// Set number of most recent frames used for the frame time percentiles.
+    void SetFrameWindow(unsigned frames);
+    /// Add a scene whose node counts are reported. Scenes of network connections are reported automatically.
+    void AddScene(Scene* scene);
+    /// Remove a scene added with AddScene().
+    void RemoveScene(Scene* scene);
+
+    /// Return whether the server is running.
+    bool IsRunning() const { return server_ != nullptr; }
+    /// Return port being served, or 0 if not running.
+    unsigned short GetPort() const { return port_; }
+    /// Return interval in seconds between metric samples.
+    float GetSampleInterval() const { return sampleInterval_; }
+    /// Return number of most recent frames used for the frame time percentiles.
+    unsigned GetFrameWindow() const { return frameTimes_.size(); }
+    /// Return last sample in Prometheus text format.
+    ea::string GetPrometheusText() const;
+    /// Return last sample in JSON format.
+    ea::string GetJSONText() const;
+
+    /// Respond to a request. Called from the server threads.
+    int HandleRequest(mg_connection* connection);
+
+private:
+    /// Take a sample of all metrics and format it.
+    void Sample();
+    /// Handle beginning of frame. Record the previous frame's time and sample if due.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Handle end of the update or rendering. Mark end of the frame's work.
+    void HandleFrameWorkEnd(StringHash eventType, VariantMap& eventData);
+
+    /// Civetweb server context.
+    mg_context* server_{};
+    /// Port being served.
+    unsigned short port_{};
+    /// Interval in seconds between metric samples.
+    float sampleInterval_{ 1.0f };
+    /// Frame timer.
+    HiresTimer frameTimer_;
+    /// Microseconds spent in the current frame until the end of its update or rendering.
+    long long frameWorkTime_{};
+    /// Whether a frame has begun since starting.
+    bool frameStarted_{};
+    /// Ring buffer of the most recent frame times in microseconds.
+    ea::vector<long long> frameTimes_;
+    /// Number of frame times recorded in total.
+    unsigned long long numFrames_{};
+    /// Number of frames at the last sample.
+    unsigned long long numFramesAtSample_{};
+    /// Timer since the last sample.
+    Timer sampleTimer_;
+    /// Explicitly added scenes.
+    ea::vector<WeakPtr<Scene> > scenes_;
+    /// Mutex for the formatted sample.
+    mutable Mutex sampleMutex_;
+    /// Last sample in Prometheus text format.
+    ea::string prometheusText_;
+    /// Last sample in JSON format.
+    ea::string jsonText_;
+};
+
+}
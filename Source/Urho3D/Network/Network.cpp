@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
@@ -311,6 +312,8 @@ void Network::NewConnectionEstablished(const SLNet::AddressOrGUID& connection)
     SharedPtr<Connection> newConnection(context_->CreateObject<Connection>());
     newConnection->Initialize(true, connection, rakPeer_);
     newConnection->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+    newConnection->SetSnapshotReplication(snapshotReplication_);
+    newConnection->SetPackageSendRate(packageSendRate_);
     clientConnections_[GetEndpointHash(connection)] = newConnection;
     URHO3D_LOGINFO("Client " + newConnection->ToString() + " connected");
 
@@ -536,16 +539,38 @@ void Network::BroadcastMessage(int msgID, bool reliable, bool inOrder, const uns
 
 void Network::BroadcastRemoteEvent(StringHash eventType, bool inOrder, const VariantMap& eventData)
 {
+    if (clientConnections_.empty())
+        return;
+
+    // Serialize once for all connections
+    SharedPtr<OutgoingMessage> message = messagePool_.Acquire(MSG_REMOTEEVENT, true, inOrder);
+    message->data_.WriteStringHash(eventType);
+    message->data_.WriteVariantMap(eventData);
+
     for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
-        i->second->SendRemoteEvent(eventType, inOrder, eventData);
+    {
+        i->second->SendRemoteEvent(message);
+        messagePool_.AddSharedSend();
+    }
 }
 
 void Network::BroadcastRemoteEvent(Scene* scene, StringHash eventType, bool inOrder, const VariantMap& eventData)
 {
+    SharedPtr<OutgoingMessage> message;
     for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
     {
-        if (i->second->GetScene() == scene)
-            i->second->SendRemoteEvent(eventType, inOrder, eventData);
+        if (i->second->GetScene() != scene)
+            continue;
+
+        // Serialize once, when the first connection in the scene is found
+        if (!message)
+        {
+            message = messagePool_.Acquire(MSG_REMOTEEVENT, true, inOrder);
+            message->data_.WriteStringHash(eventType);
+            message->data_.WriteVariantMap(eventData);
+        }
+        i->second->SendRemoteEvent(message);
+        messagePool_.AddSharedSend();
     }
 }
 
@@ -563,10 +588,21 @@ void Network::BroadcastRemoteEvent(Node* node, StringHash eventType, bool inOrde
     }
 
     Scene* scene = node->GetScene();
+    SharedPtr<OutgoingMessage> message;
     for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
     {
-        if (i->second->GetScene() == scene)
-            i->second->SendRemoteEvent(node, eventType, inOrder, eventData);
+        if (i->second->GetScene() != scene)
+            continue;
+
+        if (!message)
+        {
+            message = messagePool_.Acquire(MSG_REMOTENODEEVENT, true, inOrder);
+            message->data_.WriteNetID(node->GetID());
+            message->data_.WriteStringHash(eventType);
+            message->data_.WriteVariantMap(eventData);
+        }
+        i->second->SendRemoteEvent(message);
+        messagePool_.AddSharedSend();
     }
 }
 
@@ -577,6 +613,13 @@ void Network::SetUpdateFps(int fps)
     updateAcc_ = 0.0f;
 }
 
+void Network::SetSnapshotReplication(bool enable)
+{
+    snapshotReplication_ = enable;
+    for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+        i->second->SetSnapshotReplication(enable);
+}
+
 void Network::SetSimulatedLatency(int ms)
 {
     simulatedLatency_ = Max(ms, 0);
@@ -615,6 +658,13 @@ void Network::SetPackageCacheDir(const ea::string& path)
     packageCacheDir_ = AddTrailingSlash(path);
 }
 
+void Network::SetPackageSendRate(unsigned bytesPerSec)
+{
+    packageSendRate_ = bytesPerSec;
+    for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+        i->second->SetPackageSendRate(bytesPerSec);
+}
+
 void Network::SendPackageToClients(Scene* scene, PackageFile* package)
 {
     if (!scene)
@@ -907,6 +957,13 @@ void Network::Update(float timeStep)
             rakPeerClient_->DeallocatePacket(packet);
         }
     }
+
+    // Advance the server time at which the client scene shows interpolated transforms
+    if (serverConnection_ && serverConnection_->GetScene())
+    {
+        serverConnection_->GetScene()->SetNetworkInterpolationTime(
+            clientInterpolation_ ? serverConnection_->GetInterpolationTime() : 0.0);
+    }
 }
 
 void Network::PostUpdate(float timeStep)
@@ -918,6 +975,9 @@ void Network::PostUpdate(float timeStep)
     bool updateNow = updateAcc_ >= updateInterval_;
     if (updateNow)
     {
+        // Message pool counters are collected per network update
+        messagePool_.BeginUpdate();
+
         // Notify of the impending update to allow for example updated client controls to be set
         SendEvent(E_NETWORKUPDATE);
         updateAcc_ = fmodf(updateAcc_, updateInterval_);
@@ -940,13 +1000,39 @@ void Network::PostUpdate(float timeStep)
                     (*i)->PrepareNetworkUpdate();
             }
 
+            auto* queue = GetSubsystem<WorkQueue>();
+            if (parallelReplication_ && queue && queue->GetNumThreads() && clientConnections_.size() > 1)
+            {
+                URHO3D_PROFILE("BuildServerUpdate");
+
+                // Interest management reads world positions: update cached transforms now, as they are shared between connections
+                for (auto i = networkScenes_.begin(); i != networkScenes_.end(); ++i)
+                {
+                    for (Component* component : (*i)->GetComponentIndex<NetworkPriority>())
+                        component->GetNode()->GetWorldPosition();
+                }
+
+                // Prepared attribute values are not modified until the next update, so connections can build their messages in parallel
+                for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+                {
+                    Connection* connection = i->second;
+                    queue->AddWorkItem([connection]() { connection->BuildServerUpdate(); }, M_MAX_UNSIGNED);
+                }
+                queue->Complete(M_MAX_UNSIGNED);
+            }
+            else
+            {
+                for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+                    i->second->BuildServerUpdate();
+            }
+
             {
                 URHO3D_PROFILE("SendServerUpdate");
 
                 // Then send server updates for each client connection
                 for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
                 {
-                    i->second->SendServerUpdate();
+                    i->second->SendDeferredBuffers();
                     i->second->SendRemoteEvents();
                     i->second->SendPackages();
                     i->second->SendAllBuffers();
@@ -89,6 +89,15 @@ public:
     /// Set network update FPS.
     /// @property
     void SetUpdateFps(int fps);
+    /// Set whether server updates for multiple client connections are built in parallel on worker threads. Enabled by default.
+    /// @property
+    void SetParallelReplication(bool enable) { parallelReplication_ = enable; }
+    /// Set whether latest data attributes are sent to clients in unreliable snapshots, resent until acknowledged, instead of reliable messages. Disabled by default.
+    /// @property
+    void SetSnapshotReplication(bool enable);
+    /// Set whether the client interpolates SmoothedTransform components between time-stamped server updates, delayed adaptively by measured jitter, instead of smoothing exponentially. Disabled by default.
+    /// @property
+    void SetClientInterpolation(bool enable) { clientInterpolation_ = enable; }
     /// Set simulated latency in milliseconds. This adds a fixed delay before sending each packet.
     /// @property
     void SetSimulatedLatency(int ms);
@@ -104,15 +113,31 @@ public:
     /// Set the package download cache directory.
     /// @property
     void SetPackageCacheDir(const ea::string& path);
+    /// Set maximum rate of package data sent to each client connection in bytes per second, or 0 for unlimited. Limits how much a client downloading packages takes from the bandwidth of scene updates. Default 256 KB/s.
+    /// @property
+    void SetPackageSendRate(unsigned bytesPerSec);
     /// Trigger all client connections in the specified scene to download a package file from the server. Can be used to download additional resource packages when clients are already joined in the scene. The package must have been added as a requirement to the scene, or else the eventual download will fail.
     void SendPackageToClients(Scene* scene, PackageFile* package);
     /// Perform an HTTP request to the specified URL. Empty verb defaults to a GET request. Return a request object which can be used to read the response data.
     SharedPtr<HttpRequest> MakeHttpRequest(const ea::string& url, const ea::string& verb = EMPTY_STRING, const ea::vector<ea::string>& headers = ea::vector<ea::string>(), const ea::string& postData = EMPTY_STRING);
     /// Ban specific IP addresses.
     void BanAddress(const ea::string& address);
+    /// Acquire a pooled message to serialize once and send to several connections with Connection::SendMessage(). Released back to the pool when no longer referenced.
+    SharedPtr<OutgoingMessage> AcquireMessage(int msgID, bool reliable, bool inOrder, unsigned contentID = 0) { return messagePool_.Acquire(msgID, reliable, inOrder, contentID); }
+    /// Return message pool counters of the previous network update.
+    const OutgoingMessageStats& GetMessagePoolStats() const { return messagePool_.GetStats(); }
     /// Return network update FPS.
     /// @property
     int GetUpdateFps() const { return updateFps_; }
+    /// Return whether server updates are built in parallel.
+    /// @property
+    bool GetParallelReplication() const { return parallelReplication_; }
+    /// Return whether latest data is sent in snapshots.
+    /// @property
+    bool GetSnapshotReplication() const { return snapshotReplication_; }
+    /// Return whether the client interpolates between server updates.
+    /// @property
+    bool GetClientInterpolation() const { return clientInterpolation_; }
 
     /// Return simulated latency in milliseconds.
     /// @property
@@ -139,6 +164,9 @@ public:
     /// Return the package download cache directory.
     /// @property
     const ea::string& GetPackageCacheDir() const { return packageCacheDir_; }
+    /// Return maximum rate of package data sent to each client connection in bytes per second.
+    /// @property
+    unsigned GetPackageSendRate() const { return packageSendRate_; }
 
     /// Process incoming messages from connections. Called by HandleBeginFrame.
     void Update(float timeStep);
@@ -185,8 +213,18 @@ private:
     float updateInterval_;
     /// Update time accumulator.
     float updateAcc_;
+    /// Whether to build server updates in parallel.
+    bool parallelReplication_{ true };
+    /// Whether to send latest data in snapshots.
+    bool snapshotReplication_{};
+    /// Whether the client interpolates between server updates.
+    bool clientInterpolation_{};
+    /// Pool of messages serialized once for several connections.
+    OutgoingMessagePool messagePool_;
     /// Package cache directory.
     ea::string packageCacheDir_;
+    /// Maximum rate of package data sent to each client connection in bytes per second.
+    unsigned packageSendRate_{ 256 * 1024 };
     /// Whether we started as server or not.
     bool isServer_;
     /// Server/Client password used for connecting.
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Network/OutgoingMessage.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void OutgoingMessage::Reset(int msgID, bool reliable, bool inOrder, unsigned contentID)
+{
+    msgID_ = msgID;
+    reliable_ = reliable;
+    inOrder_ = inOrder;
+    contentID_ = contentID;
+    // Keeps the allocated capacity
+    data_.Clear();
+}
+
+SharedPtr<OutgoingMessage> OutgoingMessagePool::Acquire(int msgID, bool reliable, bool inOrder, unsigned contentID)
+{
+    ++stats_.acquired_;
+
+    OutgoingMessage* message;
+    if (!freeMessages_.empty())
+    {
+        message = freeMessages_.back();
+        freeMessages_.pop_back();
+    }
+    else
+    {
+        ++stats_.allocated_;
+        message = new OutgoingMessage();
+        messages_.emplace_back(message);
+    }
+
+    message->Reset(msgID, reliable, inOrder, contentID);
+    return SharedPtr<OutgoingMessage>(message);
+}
+
+void OutgoingMessagePool::BeginUpdate()
+{
+    lastStats_ = stats_;
+    stats_ = OutgoingMessageStats();
+
+    // A message referenced only by the pool has been sent by all connections
+    freeMessages_.clear();
+    for (const SharedPtr<OutgoingMessage>& message : messages_)
+    {
+        if (message->Refs() == 1)
+            freeMessages_.push_back(message);
+    }
+}
+
+}
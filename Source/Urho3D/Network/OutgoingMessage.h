@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../IO/VectorBuffer.h"
+
+namespace Urho3D
+{
+
+/// Network message serialized once, which can be queued on any number of connections without serializing it again. Acquired from the network message pool.
+class URHO3D_API OutgoingMessage : public RefCounted
+{
+public:
+    /// Clear data and set message parameters for reuse.
+    void Reset(int msgID, bool reliable, bool inOrder, unsigned contentID = 0);
+
+    /// Message ID.
+    int msgID_{};
+    /// Reliable flag.
+    bool reliable_{};
+    /// In order flag.
+    bool inOrder_{};
+    /// Content ID.
+    unsigned contentID_{};
+    /// Message data.
+    VectorBuffer data_;
+};
+
+/// Outgoing message pool counters of one network update.
+struct OutgoingMessageStats
+{
+    /// Messages acquired from the pool.
+    unsigned acquired_{};
+    /// Messages that had to be allocated because the pool had no free message.
+    unsigned allocated_{};
+    /// Connections a pooled message was queued on. Each would otherwise have serialized the message separately.
+    unsigned sharedSends_{};
+};
+
+/// Pool of reusable outgoing messages. A message returns to the pool once all connections have sent it.
+class URHO3D_API OutgoingMessagePool
+{
+public:
+    /// Return a free message, allocating a new one if necessary.
+    SharedPtr<OutgoingMessage> Acquire(int msgID, bool reliable, bool inOrder, unsigned contentID = 0);
+    /// Count a pooled message being queued on a connection.
+    void AddSharedSend() { ++stats_.sharedSends_; }
+    /// Collect messages released since the previous update and start counting a new update.
+    void BeginUpdate();
+
+    /// Return counters of the previous network update.
+    const OutgoingMessageStats& GetStats() const { return lastStats_; }
+    /// Return total number of pooled messages.
+    unsigned GetSize() const { return messages_.size(); }
+
+private:
+    /// All messages.
+    ea::vector<SharedPtr<OutgoingMessage> > messages_;
+    /// Messages free for reuse.
+    ea::vector<OutgoingMessage*> freeMessages_;
+    /// Counters of the current update.
+    OutgoingMessageStats stats_;
+    /// Counters of the previous update.
+    OutgoingMessageStats lastStats_;
+};
+
+}
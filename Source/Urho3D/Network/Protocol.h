@@ -44,7 +44,7 @@ static const int MSG_SCENECHECKSUMERROR = 0x8D;
 static const int MSG_CREATENODE = 0x8E;
 /// Server->client: node delta update.
 static const int MSG_NODEDELTAUPDATE = 0x8F;
-/// Server->client: node latest data update.
+/// Server->client: node latest data update, stamped with the server time of the update.
 static const int MSG_NODELATESTDATA = 0x90;
 /// Server->client: remove node.
 static const int MSG_REMOVENODE = 0x91;
@@ -52,7 +52,7 @@ static const int MSG_REMOVENODE = 0x91;
 static const int MSG_CREATECOMPONENT = 0x92;
 /// Server->client: component delta update.
 static const int MSG_COMPONENTDELTAUPDATE = 0x93;
-/// Server->client: component latest data update.
+/// Server->client: component latest data update, stamped with the server time of the update.
 static const int MSG_COMPONENTLATESTDATA = 0x94;
 /// Server->client: remove component.
 static const int MSG_REMOVECOMPONENT = 0x95;
@@ -66,6 +66,12 @@ static const int MSG_PACKAGEINFO = 0x98;
 
 /// Packet that includes all the above messages
 static const int MSG_PACKED_MESSAGE = 0x99;
+/// Server->client: unreliable part of a snapshot of latest data changed since the last acknowledged snapshot.
+static const int MSG_SNAPSHOT = 0x9A;
+/// Client->server: unreliable acknowledgement of the latest fully received snapshot.
+static const int MSG_SNAPSHOTACK = 0x9B;
+/// Server->client: server system time of the network update, for clock synchronization and interpolation.
+static const int MSG_SERVERTIME = 0x9C;
 
 /// Fixed content ID for client controls update.
 static const unsigned CONTROLS_CONTENT_ID = 1;
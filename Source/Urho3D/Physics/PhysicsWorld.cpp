@@ -781,23 +781,33 @@ void PhysicsWorld::CleanupGeometryCache()
 
 void PhysicsWorld::OnSceneSet(Scene* scene)
 {
-    // Subscribe to the scene subsystem update, which will trigger the physics simulation step
+    if (scene_)
+        scene_->GetUpdateScheduler().RemoveTasks(this);
+
+    // Add the scene subsystem update task, which will trigger the physics simulation step
     if (scene)
     {
         scene_ = GetScene();
-        SubscribeToEvent(scene_, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(PhysicsWorld, HandleSceneSubsystemUpdate));
+
+        // Collision and step events may run arbitrary user code, so the step is executed on the main thread in order
+        SceneUpdateTaskDesc task;
+        task.name_ = "PhysicsWorld";
+        task.phase_ = SUP_SUBSYSTEM;
+        task.reads_ = SUR_ALL;
+        task.writes_ = SUR_PHYSICS | SUR_NODE_TRANSFORMS | SUR_USER_LOGIC;
+        task.function_ = [this](float timeStep) { HandleSceneSubsystemUpdate(timeStep); };
+        scene_->GetUpdateScheduler().AddTask(this, task);
     }
     else
-        UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+        scene_ = nullptr;
 }
 
-void PhysicsWorld::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
+void PhysicsWorld::HandleSceneSubsystemUpdate(float timeStep)
 {
     if (!updateEnabled_)
         return;
 
-    using namespace SceneSubsystemUpdate;
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(timeStep);
 }
 
 void PhysicsWorld::PreStep(float timeStep)
@@ -953,21 +963,29 @@ void PhysicsWorld::SendCollisionEvents()
             if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
                 continue;
 
-            nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
-            nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
-            nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
             nodeCollisionData_[NodeCollision::P_TRIGGER] = trigger;
-            nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
 
-            if (newCollision)
+            // Node collision events are sent for every body pair, so skip preparing them for nodes without receivers
+            if (nodeA->HasEventReceivers(E_NODECOLLISION) || (newCollision && nodeA->HasEventReceivers(E_NODECOLLISIONSTART)))
             {
-                nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
+                nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeB;
+                nodeCollisionData_[NodeCollision::P_OTHERBODY] = bodyB;
+                nodeCollisionData_[NodeCollision::P_CONTACTS] = contacts_.GetBuffer();
+
+                if (newCollision)
+                {
+                    nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
+                    if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                        continue;
+                }
+
+                nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
                 if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
                     continue;
             }
 
-            nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+            if (!nodeB->HasEventReceivers(E_NODECOLLISION) && !(newCollision && nodeB->HasEventReceivers(E_NODECOLLISIONSTART)))
                 continue;
 
             // Flip perspective to body B
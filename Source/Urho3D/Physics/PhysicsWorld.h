@@ -308,8 +308,8 @@ protected:
     void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Handle the scene subsystem update event, step simulation here.
-    void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the scene subsystem update task, step simulation here.
+    void HandleSceneSubsystemUpdate(float timeStep);
     /// Trigger update before each physics simulation step.
     void PreStep(float timeStep);
     /// Trigger update after each physics simulation step.
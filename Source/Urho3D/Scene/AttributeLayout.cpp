@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Log.h"
+#include "../IO/Serializer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Scene/AttributeLayout.h"
+#include "../Scene/Serializable.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+AttributeLayout::AttributeLayout(StringHash type, const ea::vector<AttributeInfo>* attributes) :
+    type_(type)
+{
+    if (attributes)
+    {
+        for (const AttributeInfo& attr : *attributes)
+        {
+            if (attr.ShouldSave())
+            {
+                names_.push_back(StringHash(attr.name_));
+                types_.push_back(attr.type_);
+            }
+        }
+    }
+
+    Map(attributes);
+}
+
+bool AttributeLayout::Write(Serializer& dest) const
+{
+    bool success = dest.WriteStringHash(type_);
+    success &= dest.WriteVLE(names_.size());
+    for (unsigned i = 0; i < names_.size(); ++i)
+    {
+        success &= dest.WriteStringHash(names_[i]);
+        success &= dest.WriteUByte(static_cast<unsigned char>(types_[i]));
+    }
+    return success;
+}
+
+bool AttributeLayout::Read(Deserializer& source)
+{
+    type_ = source.ReadStringHash();
+    const unsigned numAttributes = source.ReadVLE();
+    names_.resize(numAttributes);
+    types_.resize(numAttributes);
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (source.IsEof())
+            return false;
+
+        names_[i] = source.ReadStringHash();
+        const unsigned type = source.ReadUByte();
+        if (type >= MAX_VAR_TYPES)
+            return false;
+        types_[i] = static_cast<VariantType>(type);
+    }
+    return true;
+}
+
+void AttributeLayout::Map(const ea::vector<AttributeInfo>* attributes)
+{
+    mappedAttributes_ = attributes;
+    sourceIndices_.clear();
+    identity_ = true;
+
+    unsigned numLoaded = 0;
+    if (attributes)
+    {
+        sourceIndices_.resize(attributes->size(), M_MAX_UNSIGNED);
+        for (unsigned i = 0; i < attributes->size(); ++i)
+        {
+            const AttributeInfo& attr = attributes->at(i);
+            if (!attr.ShouldLoad())
+                continue;
+
+            const StringHash nameHash(attr.name_);
+            if (numLoaded >= names_.size() || names_[numLoaded] != nameHash || types_[numLoaded] != attr.type_)
+                identity_ = false;
+            ++numLoaded;
+
+            const auto iter = ea::find(names_.begin(), names_.end(), nameHash);
+            if (iter != names_.end() && types_[iter - names_.begin()] == attr.type_)
+                sourceIndices_[i] = iter - names_.begin();
+        }
+    }
+
+    if (numLoaded != names_.size())
+        identity_ = false;
+}
+
+bool AttributeLayout::ReadValues(Deserializer& source, Context* context, ea::vector<Variant>& values) const
+{
+    ea::vector<Variant> storedValues(names_.size());
+    for (unsigned i = 0; i < names_.size(); ++i)
+    {
+        if (source.IsEof())
+            return false;
+        storedValues[i] = source.ReadVariant(types_[i], context);
+    }
+
+    values.clear();
+    values.resize(sourceIndices_.size());
+    for (unsigned i = 0; i < sourceIndices_.size(); ++i)
+    {
+        const unsigned sourceIndex = sourceIndices_[i];
+        if (sourceIndex != M_MAX_UNSIGNED)
+            values[i] = ea::move(storedValues[sourceIndex]);
+    }
+
+    return true;
+}
+
+bool AttributeLayout::Convert(Deserializer& source, Serializable* serializable, Serializer& dest) const
+{
+    ea::vector<Variant> values;
+    if (!ReadValues(source, serializable->GetContext(), values))
+    {
+        URHO3D_LOGERROR("Could not load " + serializable->GetTypeName() + ", stream not open or at end");
+        return false;
+    }
+
+    if (!mappedAttributes_)
+        return true;
+
+    for (unsigned i = 0; i < mappedAttributes_->size(); ++i)
+    {
+        if (!mappedAttributes_->at(i).ShouldLoad())
+            continue;
+
+        if (!dest.WriteVariantData(!values[i].IsEmpty() ? values[i] : serializable->GetAttribute(i)))
+            return false;
+    }
+
+    return true;
+}
+
+bool LoadWithLayout(Serializable* serializable, Deserializer& source, const AttributeLayout* layout)
+{
+    if (!layout || layout->IsIdentity() || !layout->IsMappedTo(serializable->GetAttributes()))
+        return serializable->Load(source);
+
+    VectorBuffer attrBuffer;
+    if (!layout->Convert(source, serializable, attrBuffer))
+        return false;
+    attrBuffer.Seek(0);
+    return serializable->Load(attrBuffer);
+}
+
+void AttributeLayoutTable::AddLayout(Context* context, StringHash type)
+{
+    if (layoutIndices_.find(type) != layoutIndices_.end())
+        return;
+
+    layoutIndices_[type] = layouts_.size();
+    layouts_.emplace_back(type, context->GetAttributes(type));
+}
+
+bool AttributeLayoutTable::Write(Serializer& dest) const
+{
+    bool success = dest.WriteVLE(layouts_.size());
+    for (const AttributeLayout& layout : layouts_)
+        success &= layout.Write(dest);
+    return success;
+}
+
+bool AttributeLayoutTable::Read(Deserializer& source, Context* context)
+{
+    layouts_.clear();
+    layoutIndices_.clear();
+
+    const unsigned numLayouts = source.ReadVLE();
+    layouts_.resize(numLayouts);
+    for (unsigned i = 0; i < numLayouts; ++i)
+    {
+        AttributeLayout& layout = layouts_[i];
+        if (source.IsEof() || !layout.Read(source))
+        {
+            URHO3D_LOGERROR("Could not read attribute layouts of " + source.GetName());
+            return false;
+        }
+
+        layout.Map(context->GetAttributes(layout.GetType()));
+        layoutIndices_[layout.GetType()] = i;
+    }
+
+    return true;
+}
+
+const AttributeLayout* AttributeLayoutTable::GetLayout(StringHash type) const
+{
+    const auto iter = layoutIndices_.find(type);
+    return iter != layoutIndices_.end() ? &layouts_[iter->second] : nullptr;
+}
+
+}
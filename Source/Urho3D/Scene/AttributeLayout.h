@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Core/Attribute.h"
+#include "../Math/StringHash.h"
+
+#include <EASTL/algorithm.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Context;
+class Deserializer;
+class Serializable;
+class Serializer;
+
+/// Version of the versioned binary scene format.
+static const unsigned SCENE_BINARY_VERSION = 1;
+
+/// Order and types of the attributes saved by one serializable type. Stored in versioned binary scene files so that attribute data can be read positionally when the layout is unchanged, and remapped by name when attributes were added, removed or reordered since saving.
+class URHO3D_API AttributeLayout
+{
+public:
+    /// Construct empty.
+    AttributeLayout() = default;
+    /// Construct from the attributes that the current version of the type saves.
+    AttributeLayout(StringHash type, const ea::vector<AttributeInfo>* attributes);
+
+    /// Write to binary stream. Return true if successful.
+    bool Write(Serializer& dest) const;
+    /// Read from binary stream. Return true if successful.
+    bool Read(Deserializer& source);
+    /// Map the stored layout to the attributes that the current version of the type loads.
+    void Map(const ea::vector<AttributeInfo>* attributes);
+    /// Read attribute data in the stored layout into values indexed by current attribute. Values of attributes missing from the stored data are left empty. Does not create objects unless the layout has custom types. Return true if successful.
+    bool ReadValues(Deserializer& source, Context* context, ea::vector<Variant>& values) const;
+    /// Read attribute data in the stored layout and write it in the current layout of the object, filling attributes missing from the stored data with their current values. Return true if successful.
+    bool Convert(Deserializer& source, Serializable* serializable, Serializer& dest) const;
+
+    /// Return type.
+    StringHash GetType() const { return type_; }
+    /// Return whether stored data can be loaded positionally without conversion.
+    bool IsIdentity() const { return identity_; }
+    /// Return whether the layout is mapped to the given attributes. Objects with dynamic attributes are not.
+    bool IsMappedTo(const ea::vector<AttributeInfo>* attributes) const { return attributes == mappedAttributes_; }
+    /// Return whether the stored data can be read on a worker thread, which requires that it has no custom types.
+    bool IsThreadSafe() const { return ea::find(types_.begin(), types_.end(), VAR_CUSTOM) == types_.end(); }
+
+private:
+    /// Type.
+    StringHash type_;
+    /// Name hashes of the stored attributes.
+    ea::vector<StringHash> names_;
+    /// Types of the stored attributes.
+    ea::vector<VariantType> types_;
+    /// Attributes the layout is mapped to.
+    const ea::vector<AttributeInfo>* mappedAttributes_{};
+    /// Index into the stored attributes for each current attribute, or M_MAX_UNSIGNED if not stored or not loaded.
+    ea::vector<unsigned> sourceIndices_;
+    /// Whether the stored layout matches the current one.
+    bool identity_{};
+};
+
+/// Load attributes of an object with its virtual Load(), converting them first if the stored layout differs from the current one. Layout may be null for data in the current layout. Return true if successful.
+URHO3D_API bool LoadWithLayout(Serializable* serializable, Deserializer& source, const AttributeLayout* layout);
+
+/// Attribute layouts of all serializable types in a versioned binary scene file.
+class URHO3D_API AttributeLayoutTable
+{
+public:
+    /// Add layout of type from its currently registered attributes, if not added yet.
+    void AddLayout(Context* context, StringHash type);
+    /// Write to binary stream. Return true if successful.
+    bool Write(Serializer& dest) const;
+    /// Read from binary stream and map to the currently registered attributes. Return true if successful.
+    bool Read(Deserializer& source, Context* context);
+
+    /// Return layout of type, or null if not stored.
+    const AttributeLayout* GetLayout(StringHash type) const;
+    /// Return number of layouts.
+    unsigned GetNumLayouts() const { return layouts_.size(); }
+
+private:
+    /// Layouts.
+    ea::vector<AttributeLayout> layouts_;
+    /// Layout index by type.
+    ea::unordered_map<StringHash, unsigned> layoutIndices_;
+};
+
+}
@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Scene/InterestGrid.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+void InterestGrid::SetCellSize(float size)
+{
+    cellSize_ = Max(size, 0.0f);
+    Clear();
+}
+
+void InterestGrid::UpdateNode(unsigned nodeID, const Vector3& position)
+{
+    const IntVector2 cell = GetCell(position);
+
+    auto i = nodes_.find(nodeID);
+    if (i != nodes_.end())
+    {
+        if (i->second.cell_ == cell)
+            return;
+        RemoveFromCell(i->second);
+    }
+    else
+        i = nodes_.emplace(nodeID, NodeLocation{}).first;
+
+    ea::vector<unsigned>& cellNodes = cells_[GetCellKey(cell)];
+    i->second.cell_ = cell;
+    i->second.index_ = cellNodes.size();
+    cellNodes.push_back(nodeID);
+}
+
+void InterestGrid::RemoveNode(unsigned nodeID)
+{
+    auto i = nodes_.find(nodeID);
+    if (i == nodes_.end())
+        return;
+
+    RemoveFromCell(i->second);
+    nodes_.erase(i);
+}
+
+void InterestGrid::Clear()
+{
+    cells_.clear();
+    nodes_.clear();
+}
+
+void InterestGrid::Query(ea::vector<unsigned>& result, const Vector3& center, float radius) const
+{
+    if (!IsEnabled())
+        return;
+
+    const IntVector2 minCell = GetCell(center - Vector3(radius, 0.0f, radius));
+    const IntVector2 maxCell = GetCell(center + Vector3(radius, 0.0f, radius));
+
+    // Visit whichever is fewer: the cells in the window, looked up one by one, or all occupied cells, filtered by the window
+    const unsigned long long numWindowCells = (unsigned long long)(maxCell.x_ - minCell.x_ + 1) * (maxCell.y_ - minCell.y_ + 1);
+    if (numWindowCells <= cells_.size())
+    {
+        for (int y = minCell.y_; y <= maxCell.y_; ++y)
+        {
+            for (int x = minCell.x_; x <= maxCell.x_; ++x)
+            {
+                auto i = cells_.find(GetCellKey(IntVector2(x, y)));
+                if (i != cells_.end())
+                    result.insert(result.end(), i->second.begin(), i->second.end());
+            }
+        }
+    }
+    else
+    {
+        for (const auto& cellNodes : cells_)
+        {
+            const IntVector2 cell = GetCellFromKey(cellNodes.first);
+            if (cell.x_ >= minCell.x_ && cell.x_ <= maxCell.x_ && cell.y_ >= minCell.y_ && cell.y_ <= maxCell.y_)
+                result.insert(result.end(), cellNodes.second.begin(), cellNodes.second.end());
+        }
+    }
+}
+
+IntVector2 InterestGrid::GetCell(const Vector3& position) const
+{
+    return IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+}
+
+void InterestGrid::RemoveFromCell(const NodeLocation& location)
+{
+    auto i = cells_.find(GetCellKey(location.cell_));
+    if (i == cells_.end())
+        return;
+
+    ea::vector<unsigned>& cellNodes = i->second;
+    const unsigned lastID = cellNodes.back();
+    cellNodes[location.index_] = lastID;
+    nodes_[lastID].index_ = location.index_;
+    cellNodes.pop_back();
+
+    if (cellNodes.empty())
+        cells_.erase(i);
+}
+
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+
+namespace Urho3D
+{
+
+/// Uniform grid on the XZ plane that buckets top-level replicated scene nodes by position. Used by the server to find the nodes relevant to each client connection without visiting the whole scene.
+class URHO3D_API InterestGrid
+{
+public:
+    /// Set cell size and remove all nodes. Zero disables the grid.
+    void SetCellSize(float size);
+    /// Insert node or move it to the cell of its new position.
+    void UpdateNode(unsigned nodeID, const Vector3& position);
+    /// Remove node if it exists.
+    void RemoveNode(unsigned nodeID);
+    /// Remove all nodes.
+    void Clear();
+    /// Append IDs of nodes in all cells overlapping the square around the center. Cell-granular: may return nodes up to one cell outside the radius.
+    void Query(ea::vector<unsigned>& result, const Vector3& center, float radius) const;
+
+    /// Return cell size. Zero if disabled.
+    float GetCellSize() const { return cellSize_; }
+    /// Return whether the grid is in use.
+    bool IsEnabled() const { return cellSize_ > 0.0f; }
+    /// Return number of nodes in the grid.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+
+private:
+    /// Location of a node in the grid.
+    struct NodeLocation
+    {
+        /// Cell coordinates.
+        IntVector2 cell_;
+        /// Index in the cell's node list.
+        unsigned index_;
+    };
+
+    /// Return coordinates of the cell containing a position.
+    IntVector2 GetCell(const Vector3& position) const;
+    /// Return hash map key of a cell.
+    static unsigned long long GetCellKey(const IntVector2& cell)
+    {
+        return (unsigned long long)(unsigned)cell.x_ << 32u | (unsigned)cell.y_;
+    }
+    /// Return cell coordinates from hash key.
+    static IntVector2 GetCellFromKey(unsigned long long key)
+    {
+        return IntVector2((int)(unsigned)(key >> 32u), (int)(unsigned)key);
+    }
+    /// Remove node from its cell, keeping the cell's list dense.
+    void RemoveFromCell(const NodeLocation& location);
+
+    /// Cell size.
+    float cellSize_{};
+    /// Node IDs by cell.
+    ea::unordered_map<unsigned long long, ea::vector<unsigned> > cells_;
+    /// Locations by node ID.
+    ea::unordered_map<unsigned, NodeLocation> nodes_;
+};
+
+}
@@ -23,12 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../IO/Log.h"
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-#include "../Physics/PhysicsEvents.h"
-#endif
 #include "../Scene/LogicComponent.h"
 #include "../Scene/Scene.h"
-#include "../Scene/SceneEvents.h"
 
 namespace Urho3D
 {
@@ -41,7 +37,10 @@ LogicComponent::LogicComponent(Context* context) :
 {
 }
 
-LogicComponent::~LogicComponent() = default;
+LogicComponent::~LogicComponent()
+{
+    RemoveFromUpdateLists();
+}
 
 void LogicComponent::OnSetEnabled()
 {
@@ -87,20 +86,69 @@ void LogicComponent::OnNodeSet(Node* node)
     }
 }
 
+void LogicComponent::SetThreadSafeUpdate(bool enable)
+{
+    if (threadSafeUpdate_ != enable)
+    {
+        // The component moves between the serial and thread-safe update lists
+        RemoveFromUpdateLists();
+        threadSafeUpdate_ = enable;
+        UpdateEventSubscription();
+    }
+}
+
+void LogicComponent::ExecuteDelayedStart()
+{
+    if (delayedStartCalled_)
+        return;
+
+    DelayedStart();
+    delayedStartCalled_ = true;
+
+    // If did not need actual update events, remove from the update list now
+    if (!(updateEventMask_ & USE_UPDATE))
+        UpdateEventSubscription();
+}
+
+void LogicComponent::ExecuteUpdate(UpdateEvent phase, float timeStep)
+{
+    // Execute user-defined delayed start function before first update or fixed update
+    if (phase == USE_UPDATE || phase == USE_FIXEDUPDATE)
+        ExecuteDelayedStart();
+
+    // DelayedStart may have disabled the component or changed the update event mask
+    if (!(currentEventMask_ & phase))
+        return;
+
+    switch (phase)
+    {
+    case USE_UPDATE:
+        Update(timeStep);
+        break;
+
+    case USE_POSTUPDATE:
+        PostUpdate(timeStep);
+        break;
+
+    case USE_FIXEDUPDATE:
+        FixedUpdate(timeStep);
+        break;
+
+    case USE_FIXEDPOSTUPDATE:
+        FixedPostUpdate(timeStep);
+        break;
+
+    default:
+        break;
+    }
+}
+
 void LogicComponent::OnSceneSet(Scene* scene)
 {
     if (scene)
         UpdateEventSubscription();
     else
-    {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        currentEventMask_ = USE_NO_EVENT;
-    }
+        RemoveFromUpdateLists();
 }
 
 void LogicComponent::UpdateEventSubscription()
@@ -109,31 +157,16 @@ void LogicComponent::UpdateEventSubscription()
     if (!scene)
         return;
 
-    bool enabled = IsEnabledEffective();
-
-    bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
-    if (needUpdate && !(currentEventMask_ & USE_UPDATE))
+    if (scene != subscribedScene_)
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
-        currentEventMask_ |= USE_UPDATE;
-    }
-    else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
-        currentEventMask_ &= ~USE_UPDATE;
+        RemoveFromUpdateLists();
+        subscribedScene_ = scene;
     }
 
-    bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
-    if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
-    {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
-        currentEventMask_ |= USE_POSTUPDATE;
-    }
-    else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-        currentEventMask_ &= ~USE_POSTUPDATE;
-    }
+    bool enabled = IsEnabledEffective();
+
+    UpdatePhaseSubscription(scene, USE_UPDATE, enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_));
+    UpdatePhaseSubscription(scene, USE_POSTUPDATE, enabled && (updateEventMask_ & USE_POSTUPDATE));
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
     Component* world = GetFixedUpdateSource();
@@ -141,87 +174,80 @@ void LogicComponent::UpdateEventSubscription()
         return;
 
     bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
-    if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPreStep));
-        currentEventMask_ |= USE_FIXEDUPDATE;
-    }
-    else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
-    {
-        UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
-        currentEventMask_ &= ~USE_FIXEDUPDATE;
-    }
-
     bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
-    if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
+    if (needFixedUpdate || needFixedPostUpdate)
+        scene->SetFixedUpdateSource(world);
+
+    UpdatePhaseSubscription(scene, USE_FIXEDUPDATE, needFixedUpdate);
+    UpdatePhaseSubscription(scene, USE_FIXEDPOSTUPDATE, needFixedPostUpdate);
+#endif
+}
+
+void LogicComponent::UpdatePhaseSubscription(Scene* scene, UpdateEvent phase, bool needed)
+{
+    if (needed && !(currentEventMask_ & phase))
     {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPostStep));
-        currentEventMask_ |= USE_FIXEDPOSTUPDATE;
+        scene->GetLogicUpdateList(phase, threadSafeUpdate_).Add(this, phase);
+        currentEventMask_ |= phase;
     }
-    else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
+    else if (!needed && (currentEventMask_ & phase))
     {
-        UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
-        currentEventMask_ &= ~USE_FIXEDPOSTUPDATE;
+        scene->GetLogicUpdateList(phase, threadSafeUpdate_).Remove(this, phase);
+        currentEventMask_ &= ~phase;
     }
-#endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::RemoveFromUpdateLists()
 {
-    using namespace SceneUpdate;
-
-    // Execute user-defined delayed start function before first update
-    if (!delayedStartCalled_)
+    // The scene may already be expired if it is being destroyed, in which case its lists are going away as well
+    if (Scene* scene = subscribedScene_)
     {
-        DelayedStart();
-        delayedStartCalled_ = true;
-
-        // If did not need actual update events, unsubscribe now
-        if (!(updateEventMask_ & USE_UPDATE))
+        for (unsigned i = 0; i < NUM_LOGIC_UPDATE_PHASES; ++i)
         {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
-            currentEventMask_ &= ~USE_UPDATE;
-            return;
+            const auto phase = static_cast<UpdateEvent>(1u << i);
+            if (currentEventMask_ & phase)
+                scene->GetLogicUpdateList(phase, threadSafeUpdate_).Remove(this, phase);
         }
     }
 
-    // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    subscribedScene_ = nullptr;
+    currentEventMask_ = USE_NO_EVENT;
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponentUpdateList::Add(LogicComponent* component, UpdateEvent phase)
 {
-    using namespace ScenePostUpdate;
-
-    // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
+    component->updateListIndices_[GetLogicUpdatePhaseIndex(phase)] = components_.size();
+    components_.push_back(component);
 }
 
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-
-void LogicComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+void LogicComponentUpdateList::Remove(LogicComponent* component, UpdateEvent phase)
 {
-    using namespace PhysicsPreStep;
-
-    // Execute user-defined delayed start function before first fixed update if not called yet
-    if (!delayedStartCalled_)
+    const unsigned index = component->updateListIndices_[GetLogicUpdatePhaseIndex(phase)];
+    if (index < components_.size() && components_[index] == component)
     {
-        DelayedStart();
-        delayedStartCalled_ = true;
+        components_[index] = nullptr;
+        dirty_ = true;
     }
-
-    // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
 }
 
-void LogicComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+void LogicComponentUpdateList::Compact(UpdateEvent phase)
 {
-    using namespace PhysicsPostStep;
+    if (!dirty_)
+        return;
 
-    // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
-}
+    const unsigned phaseIndex = GetLogicUpdatePhaseIndex(phase);
+    unsigned numComponents = 0;
+    for (LogicComponent* component : components_)
+    {
+        if (component)
+        {
+            component->updateListIndices_[phaseIndex] = numComponents;
+            components_[numComponents++] = component;
+        }
+    }
 
-#endif
+    components_.resize(numComponents);
+    dirty_ = false;
+}
 
 }
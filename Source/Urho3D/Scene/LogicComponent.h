@@ -45,6 +45,40 @@ enum UpdateEvent : unsigned
 };
 URHO3D_FLAGSET(UpdateEvent, UpdateEventFlags);
 
+/// Number of logic component update phases, one per UpdateEvent bit.
+static const unsigned NUM_LOGIC_UPDATE_PHASES = 4;
+
+/// Return index of the update phase corresponding to a single UpdateEvent bit.
+inline unsigned GetLogicUpdatePhaseIndex(UpdateEvent phase) { return LogBaseTwo(phase); }
+
+class LogicComponent;
+class Scene;
+
+/// Contiguous list of logic components receiving one update phase. Owned by the Scene and iterated directly instead of sending an event to each component.
+class URHO3D_API LogicComponentUpdateList
+{
+public:
+    /// Add component to the end of the list.
+    void Add(LogicComponent* component, UpdateEvent phase);
+    /// Remove component. Leaves a hole, which is compacted before the next update.
+    void Remove(LogicComponent* component, UpdateEvent phase);
+    /// Remove holes left by removed components. Preserves update order.
+    void Compact(UpdateEvent phase);
+
+    /// Return number of components, including holes.
+    unsigned GetSize() const { return components_.size(); }
+    /// Return component at index, or null if removed.
+    LogicComponent* GetComponent(unsigned index) const { return components_[index]; }
+    /// Return whether the list is empty.
+    bool IsEmpty() const { return components_.empty(); }
+
+private:
+    /// Components. Null for removed components until compacted.
+    ea::vector<LogicComponent*> components_;
+    /// Whether there are holes to compact.
+    bool dirty_{};
+};
+
 /// Helper base class for user-defined game logic components that hooks up to update events and forwards them to virtual functions similar to ScriptInstance class.
 class URHO3D_API LogicComponent : public Component
 {
@@ -82,9 +116,20 @@ class URHO3D_API LogicComponent : public Component
     /// Return what update events are subscribed to.
     UpdateEventFlags GetUpdateEventMask() const { return updateEventMask_; }
 
+    /// Set whether the update functions are safe to call from worker threads. Thread-safe components are updated in parallel with each other, and may only modify their own state and their own node's transform; they must not send events or create or remove objects.
+    void SetThreadSafeUpdate(bool enable);
+
+    /// Return whether the update functions are safe to call from worker threads.
+    bool IsThreadSafeUpdate() const { return threadSafeUpdate_; }
+
     /// Return whether the DelayedStart() function has been called.
     bool IsDelayedStartCalled() const { return delayedStartCalled_; }
 
+    /// Call DelayedStart() if not called yet. Called by Scene before updating thread-safe components in parallel.
+    void ExecuteDelayedStart();
+    /// Execute update function of given phase, calling DelayedStart() first if necessary. Called by Scene.
+    void ExecuteUpdate(UpdateEvent phase, float timeStep);
+
 protected:
     /// Handle scene node being assigned at creation.
     void OnNodeSet(Node* node) override;
@@ -92,24 +137,27 @@ protected:
     void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
+    friend class LogicComponentUpdateList;
+
+    /// Add to/remove from the scene update lists based on current enabled state and update event mask.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
+    /// Add to/remove from the scene update list of one phase.
+    void UpdatePhaseSubscription(Scene* scene, UpdateEvent phase, bool needed);
+    /// Remove from all scene update lists.
+    void RemoveFromUpdateLists();
+
     /// Requested event subscription mask.
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
     UpdateEventFlags currentEventMask_;
+    /// Scene whose update lists the component is in.
+    WeakPtr<Scene> subscribedScene_;
+    /// Position in the scene update list of each phase.
+    unsigned updateListIndices_[NUM_LOGIC_UPDATE_PHASES]{};
     /// Flag for delayed start.
     bool delayedStartCalled_;
+    /// Whether the update functions are thread-safe.
+    bool threadSafeUpdate_{};
 };
 
 }
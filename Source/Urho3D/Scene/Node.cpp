@@ -30,7 +30,9 @@
 #include "../IO/MemoryBuffer.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/AttributeLayout.h"
 #include "../Scene/Component.h"
+#include "../Scene/NodeData.h"
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
@@ -47,6 +49,10 @@
 namespace Urho3D
 {
 
+/// Bits per smallest-three component of the replicated node rotation. Matches the precision of a 16-bit packed quaternion
+/// in 7 bytes; applications may lower it with Context::UpdateAttributeQuantization.
+static const unsigned NETWORK_ROTATION_BITS = 16;
+
 Node::Node(Context* context) :
     Animatable(context),
     worldTransform_(Matrix3x4::IDENTITY),
@@ -89,8 +95,9 @@ void Node::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Variables", VariantMap, vars_, Variant::emptyVariantMap, AM_FILE); // Network replication of vars uses custom data
     URHO3D_ACCESSOR_ATTRIBUTE("Network Position", GetNetPositionAttr, SetNetPositionAttr, Vector3, Vector3::ZERO,
         AM_NET | AM_LATESTDATA | AM_NOEDIT);
-    URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, Quaternion, Quaternion::IDENTITY,
+        AM_NET | AM_LATESTDATA | AM_NOEDIT)
+        .SetQuantization(AttributeQuantization(NETWORK_ROTATION_BITS));
     URHO3D_ACCESSOR_ATTRIBUTE("Network Parent Node", GetNetParentAttr, SetNetParentAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
         AM_NET | AM_NOEDIT);
 }
@@ -440,6 +447,12 @@ void Node::AddReplicationState(NodeReplicationState* state)
     networkState_->replicationStates_.push_back(state);
 }
 
+void Node::RemoveReplicationState(NodeReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.erase_first(state);
+}
+
 bool Node::SaveXML(Serializer& dest, const ea::string& indentation) const
 {
     SharedPtr<XMLFile> xml(context_->CreateObject<XMLFile>());
@@ -1608,14 +1621,13 @@ void Node::SetNetPositionAttr(const Vector3& value)
         SetPosition(value);
 }
 
-void Node::SetNetRotationAttr(const ea::vector<unsigned char>& value)
+void Node::SetNetRotationAttr(const Quaternion& value)
 {
-    MemoryBuffer buf(value);
     auto* transform = GetComponent<SmoothedTransform>();
     if (transform)
-        transform->SetTargetRotation(buf.ReadPackedQuaternion());
+        transform->SetTargetRotation(value);
     else
-        SetRotation(buf.ReadPackedQuaternion());
+        SetRotation(value);
 }
 
 void Node::SetNetParentAttr(const ea::vector<unsigned char>& value)
@@ -1660,11 +1672,9 @@ const Vector3& Node::GetNetPositionAttr() const
     return position_;
 }
 
-const ea::vector<unsigned char>& Node::GetNetRotationAttr() const
+const Quaternion& Node::GetNetRotationAttr() const
 {
-    impl_->attrBuffer_.Clear();
-    impl_->attrBuffer_.WritePackedQuaternion(rotation_);
-    return impl_->attrBuffer_.GetBuffer();
+    return rotation_;
 }
 
 const ea::vector<unsigned char>& Node::GetNetParentAttr() const
@@ -1694,30 +1704,62 @@ const ea::vector<unsigned char>& Node::GetNetParentAttr() const
     return impl_->attrBuffer_.GetBuffer();
 }
 
-bool Node::Load(Deserializer& source, SceneResolver& resolver, bool loadChildren, bool rewriteIDs, CreateMode mode)
+bool Node::Load(Deserializer& source, SceneResolver& resolver, bool loadChildren, bool rewriteIDs, CreateMode mode,
+    const AttributeLayoutTable* layouts)
 {
     // Remove all children and components first in case this is not a fresh load
     RemoveAllChildren();
     RemoveAllComponents();
 
     // ID has been read at the parent level
-    if (!Animatable::Load(source))
+    const AttributeLayout* layout = layouts ? layouts->GetLayout(GetType()) : nullptr;
+    if (layout && !layout->IsIdentity() && layout->IsMappedTo(GetAttributes()))
+    {
+        VectorBuffer attrBuffer;
+        if (!layout->Convert(source, this, attrBuffer))
+            return false;
+        attrBuffer.Seek(0);
+        if (!Animatable::Load(attrBuffer))
+            return false;
+    }
+    else if (!Animatable::Load(source))
         return false;
 
-    unsigned numComponents = source.ReadVLE();
-    for (unsigned i = 0; i < numComponents; ++i)
+    const auto loadComponent = [&](Deserializer& compBuffer)
     {
-        VectorBuffer compBuffer(source, source.ReadVLE());
         StringHash compType = compBuffer.ReadStringHash();
         unsigned compID = compBuffer.ReadUInt();
 
         Component* newComponent = SafeCreateComponent(EMPTY_STRING, compType,
             (mode == REPLICATED && Scene::IsReplicatedID(compID)) ? REPLICATED : LOCAL, rewriteIDs ? 0 : compID);
-        if (newComponent)
+        if (!newComponent)
+            return;
+
+        resolver.AddComponent(compID, newComponent);
+
+        // Do not abort if component fails to load, as the component buffer is nested and we can skip to the next
+        LoadWithLayout(newComponent, compBuffer, layouts ? layouts->GetLayout(compType) : nullptr);
+    };
+
+    // When the data is already in memory, read component data in place instead of copying it
+    auto* memorySource = dynamic_cast<MemoryBuffer*>(&source);
+
+    unsigned numComponents = source.ReadVLE();
+    components_.reserve(components_.size() + numComponents);
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        const unsigned dataSize = source.ReadVLE();
+        if (memorySource)
         {
-            resolver.AddComponent(compID, newComponent);
-            // Do not abort if component fails to load, as the component buffer is nested and we can skip to the next
-            newComponent->Load(compBuffer);
+            const unsigned position = memorySource->GetPosition();
+            MemoryBuffer compBuffer(memorySource->GetData() + position, Min(dataSize, memorySource->GetSize() - position));
+            memorySource->Seek(position + dataSize);
+            loadComponent(compBuffer);
+        }
+        else
+        {
+            VectorBuffer compBuffer(source, dataSize);
+            loadComponent(compBuffer);
         }
     }
 
@@ -1725,13 +1767,56 @@ bool Node::Load(Deserializer& source, SceneResolver& resolver, bool loadChildren
         return true;
 
     unsigned numChildren = source.ReadVLE();
+    children_.reserve(children_.size() + numChildren);
     for (unsigned i = 0; i < numChildren; ++i)
     {
         unsigned nodeID = source.ReadUInt();
         Node* newNode = CreateChild(rewriteIDs ? 0 : nodeID, (mode == REPLICATED && Scene::IsReplicatedID(nodeID)) ? REPLICATED :
             LOCAL);
         resolver.AddNode(nodeID, newNode);
-        if (!newNode->Load(source, resolver, loadChildren, rewriteIDs, mode))
+        if (!newNode->Load(source, resolver, loadChildren, rewriteIDs, mode, layouts))
+            return false;
+    }
+
+    return true;
+}
+
+bool Node::Load(const NodeData& source, SceneResolver& resolver, bool rewriteIDs, CreateMode mode)
+{
+    // Remove all children and components first in case this is not a fresh load
+    RemoveAllChildren();
+    RemoveAllComponents();
+
+    if (!LoadAttributeValues(source.attributes_))
+        return false;
+
+    components_.reserve(components_.size() + source.components_.size());
+    for (const ComponentData& compData : source.components_)
+    {
+        Component* newComponent = SafeCreateComponent(EMPTY_STRING, compData.type_,
+            (mode == REPLICATED && Scene::IsReplicatedID(compData.id_)) ? REPLICATED : LOCAL, rewriteIDs ? 0 : compData.id_);
+        if (!newComponent)
+            continue;
+
+        resolver.AddComponent(compData.id_, newComponent);
+
+        // Components with dynamic attributes, or with attributes that could not be parsed in advance, load from the raw data
+        if (compData.parsed_ && newComponent->GetAttributes() == context_->GetAttributes(compData.type_))
+            newComponent->LoadAttributeValues(compData.attributes_);
+        else
+        {
+            MemoryBuffer compBuffer(compData.data_, compData.dataSize_);
+            LoadWithLayout(newComponent, compBuffer, compData.layout_);
+        }
+    }
+
+    children_.reserve(children_.size() + source.children_.size());
+    for (const NodeData& childData : source.children_)
+    {
+        Node* newNode = CreateChild(rewriteIDs ? 0 : childData.id_,
+            (mode == REPLICATED && Scene::IsReplicatedID(childData.id_)) ? REPLICATED : LOCAL);
+        resolver.AddNode(childData.id_, newNode);
+        if (!newNode->Load(childData, resolver, rewriteIDs, mode))
             return false;
     }
 
@@ -31,12 +31,14 @@
 namespace Urho3D
 {
 
+class AttributeLayoutTable;
 class Component;
 class Connection;
 class Node;
 class Scene;
 class SceneResolver;
 
+struct NodeData;
 struct NodeReplicationState;
 
 /// Component and child node creation mode for networking.
@@ -114,6 +116,8 @@ public:
     void MarkNetworkUpdate() override;
     /// Add a replication state that is tracking this node.
     virtual void AddReplicationState(NodeReplicationState* state);
+    /// Remove a replication state that is no longer tracking this node.
+    void RemoveReplicationState(NodeReplicationState* state);
 
     /// Save to an XML file. Return true if successful.
     bool SaveXML(Serializer& dest, const ea::string& indentation = "\t") const;
@@ -641,18 +645,20 @@ public:
     /// Set network position attribute.
     void SetNetPositionAttr(const Vector3& value);
     /// Set network rotation attribute.
-    void SetNetRotationAttr(const ea::vector<unsigned char>& value);
+    void SetNetRotationAttr(const Quaternion& value);
     /// Set network parent attribute.
     void SetNetParentAttr(const ea::vector<unsigned char>& value);
     /// Return network position attribute.
     const Vector3& GetNetPositionAttr() const;
     /// Return network rotation attribute.
-    const ea::vector<unsigned char>& GetNetRotationAttr() const;
+    const Quaternion& GetNetRotationAttr() const;
     /// Return network parent attribute.
     const ea::vector<unsigned char>& GetNetParentAttr() const;
-    /// Load components and optionally load child nodes.
+    /// Load components and optionally load child nodes. Attribute layouts are given when loading the versioned binary scene format.
     bool Load(Deserializer& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
-        CreateMode mode = REPLICATED);
+        CreateMode mode = REPLICATED, const AttributeLayoutTable* layouts = nullptr);
+    /// Load components and child nodes from data parsed in advance.
+    bool Load(const NodeData& source, SceneResolver& resolver, bool rewriteIDs = false, CreateMode mode = REPLICATED);
     /// Load components from XML data and optionally load child nodes.
     bool LoadXML(const XMLElement& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
         CreateMode mode = REPLICATED);
@@ -0,0 +1,214 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/Log.h"
+#include "../Scene/Node.h"
+#include "../Scene/NodeData.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Parse attributes of a type without creating an object. Return false if failed or if the attributes can not be parsed off the main thread.
+bool ParseAttributes(Deserializer& source, Context* context, StringHash type, const AttributeLayout* layout,
+    ea::vector<Variant>& values)
+{
+    const ea::vector<AttributeInfo>* attributes = context->GetAttributes(type);
+    if (!attributes)
+        return false;
+
+    if (layout)
+    {
+        if (!layout->IsMappedTo(attributes) || !layout->IsThreadSafe())
+            return false;
+        return layout->ReadValues(source, context, values);
+    }
+
+    values.clear();
+    values.resize(attributes->size());
+    for (unsigned i = 0; i < attributes->size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if (!attr.ShouldLoad())
+            continue;
+
+        // Reading custom values creates objects
+        if (attr.type_ == VAR_CUSTOM || source.IsEof())
+            return false;
+
+        values[i] = source.ReadVariant(attr.type_, context);
+    }
+
+    return true;
+}
+
+void CollectResourcesFromValues(const ea::vector<Variant>& values, ea::vector<ResourceRef>& resources)
+{
+    for (const Variant& value : values)
+    {
+        if (value.GetType() == VAR_RESOURCEREF)
+            resources.push_back(value.GetResourceRef());
+        else if (value.GetType() == VAR_RESOURCEREFLIST)
+        {
+            const ResourceRefList& refList = value.GetResourceRefList();
+            for (const ea::string& name : refList.names_)
+                resources.emplace_back(refList.type_, name);
+        }
+    }
+}
+
+}
+
+bool NodeData::Parse(MemoryBuffer& source, Context* context, StringHash type, const AttributeLayoutTable* layouts, bool parseChildren)
+{
+    if (!ParseAttributes(source, context, type, layouts ? layouts->GetLayout(type) : nullptr, attributes_))
+        return false;
+
+    // Counts are not trusted for preallocation beyond what the remaining data can hold
+    const unsigned numComponents = source.ReadVLE();
+    components_.clear();
+    components_.reserve(Min(numComponents, source.GetSize() - source.GetPosition()));
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        const unsigned dataSize = source.ReadVLE();
+        const unsigned position = source.GetPosition();
+        if (dataSize > source.GetSize() - position)
+            return false;
+
+        MemoryBuffer compBuffer(source.GetData() + position, dataSize);
+        source.Seek(position + dataSize);
+
+        ComponentData& component = components_.emplace_back();
+        component.type_ = compBuffer.ReadStringHash();
+        component.id_ = compBuffer.ReadUInt();
+        component.data_ = source.GetData() + position + compBuffer.GetPosition();
+        component.dataSize_ = compBuffer.GetSize() - compBuffer.GetPosition();
+        component.layout_ = layouts ? layouts->GetLayout(component.type_) : nullptr;
+
+        // Components that can not be parsed here are loaded from the raw data on instantiation
+        component.parsed_ = ParseAttributes(compBuffer, context, component.type_, component.layout_, component.attributes_);
+        if (!component.parsed_)
+            component.attributes_.clear();
+    }
+
+    if (!parseChildren)
+        return true;
+
+    const unsigned numChildren = source.ReadVLE();
+    children_.clear();
+    children_.reserve(Min(numChildren, source.GetSize() - source.GetPosition()));
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        NodeData& child = children_.emplace_back();
+        child.id_ = source.ReadUInt();
+        if (!child.Parse(source, context, Node::GetTypeStatic(), layouts))
+            return false;
+    }
+
+    return true;
+}
+
+void NodeData::CollectResources(ea::vector<ResourceRef>& resources) const
+{
+    CollectResourcesFromValues(attributes_, resources);
+    for (const ComponentData& component : components_)
+        CollectResourcesFromValues(component.attributes_, resources);
+    for (const NodeData& child : children_)
+        child.CollectResources(resources);
+}
+
+BinarySceneParser::BinarySceneParser(Context* context, ea::vector<unsigned char> data, const AttributeLayoutTable* layouts,
+    unsigned numNodes, bool collectResources) :
+    context_(context),
+    data_(ea::move(data)),
+    source_(data_),
+    hasLayouts_(layouts != nullptr),
+    collectResources_(collectResources),
+    numNodes_(numNodes)
+{
+    if (layouts)
+        layouts_ = *layouts;
+    if (!numNodes_)
+        finished_ = true;
+}
+
+bool BinarySceneParser::ParseNext()
+{
+    if (finished_ || cancelled_)
+        return false;
+
+    NodeData node;
+    node.id_ = source_.ReadUInt();
+    if (source_.IsEof() || !node.Parse(source_, context_, Node::GetTypeStatic(), GetLayouts()))
+    {
+        URHO3D_LOGERROR("Could not parse scene node " + ea::to_string(numParsedNodes_) + ", data is truncated or invalid");
+        failed_ = true;
+        finished_ = true;
+        return false;
+    }
+
+    ea::vector<ResourceRef> resources;
+    if (collectResources_)
+        node.CollectResources(resources);
+
+    {
+        MutexLock lock(mutex_);
+        parsedNodes_.push_back(ea::move(node));
+        resources_.insert(resources_.end(), resources.begin(), resources.end());
+    }
+
+    if (++numParsedNodes_ >= numNodes_)
+        finished_ = true;
+    return true;
+}
+
+void BinarySceneParser::ParseAll()
+{
+    while (ParseNext())
+    {
+    }
+}
+
+void BinarySceneParser::TakeParsedNodes(ea::vector<NodeData>& nodes)
+{
+    MutexLock lock(mutex_);
+    for (NodeData& node : parsedNodes_)
+        nodes.push_back(ea::move(node));
+    parsedNodes_.clear();
+}
+
+void BinarySceneParser::TakeResources(ea::vector<ResourceRef>& resources)
+{
+    MutexLock lock(mutex_);
+    resources.insert(resources.end(), resources_.begin(), resources_.end());
+    resources_.clear();
+}
+
+}
@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Scene/AttributeLayout.h"
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+/// Component parsed from binary scene data without creating it.
+struct URHO3D_API ComponentData
+{
+    /// Component type.
+    StringHash type_;
+    /// Component ID in the source data.
+    unsigned id_{};
+    /// Values of the loaded attributes indexed by attribute. Valid if parsed.
+    ea::vector<Variant> attributes_;
+    /// Whether the attributes were parsed. Otherwise the component is loaded from raw data on instantiation.
+    bool parsed_{};
+    /// Raw attribute data. Points into the source data, which must outlive this object.
+    const unsigned char* data_{};
+    /// Size of raw attribute data.
+    unsigned dataSize_{};
+    /// Stored attribute layout of the raw data, or null if in the current layout.
+    const AttributeLayout* layout_{};
+};
+
+/// Node with its components and child nodes parsed from binary scene data without creating any objects. Parsing is safe to do on a worker thread, while instantiation with Node::Load() is done on the main thread.
+struct URHO3D_API NodeData
+{
+    /// Parse attributes, components and optionally child nodes. The node ID has been read at the parent level. Layouts are given when parsing the versioned binary scene format. Without child nodes, the source is left at the child node count. Return true if successful.
+    bool Parse(MemoryBuffer& source, Context* context, StringHash type, const AttributeLayoutTable* layouts, bool parseChildren = true);
+    /// Append resources referenced by the parsed attributes of the node, its components and child nodes.
+    void CollectResources(ea::vector<ResourceRef>& resources) const;
+
+    /// Node ID in the source data.
+    unsigned id_{};
+    /// Values of the loaded attributes indexed by attribute.
+    ea::vector<Variant> attributes_;
+    /// Components.
+    ea::vector<ComponentData> components_;
+    /// Child nodes.
+    ea::vector<NodeData> children_;
+};
+
+/// Parses the root-level child nodes of binary scene data in sequence. Can run on a worker thread while the main thread takes and instantiates the nodes parsed so far.
+class URHO3D_API BinarySceneParser
+{
+public:
+    /// Construct with the scene data following the root-level child node count. Layouts are given for the versioned binary scene format.
+    BinarySceneParser(Context* context, ea::vector<unsigned char> data, const AttributeLayoutTable* layouts, unsigned numNodes,
+        bool collectResources);
+
+    /// Parse next root-level child node. Return false if finished, failed or cancelled.
+    bool ParseNext();
+    /// Parse all remaining root-level child nodes unless cancelled.
+    void ParseAll();
+    /// Cancel parsing. Thread-safe.
+    void Cancel() { cancelled_ = true; }
+    /// Move nodes parsed so far to the end of the vector. Thread-safe.
+    void TakeParsedNodes(ea::vector<NodeData>& nodes);
+    /// Move resources referenced by the nodes parsed so far to the end of the vector. Thread-safe.
+    void TakeResources(ea::vector<ResourceRef>& resources);
+
+    /// Return attribute layouts, or null if parsing the legacy binary scene format.
+    const AttributeLayoutTable* GetLayouts() const { return hasLayouts_ ? &layouts_ : nullptr; }
+    /// Return whether all nodes have been parsed or parsing failed. Thread-safe.
+    bool IsFinished() const { return finished_; }
+    /// Return whether parsing failed. Thread-safe.
+    bool IsFailed() const { return failed_; }
+
+private:
+    /// Context.
+    Context* context_{};
+    /// Scene data.
+    ea::vector<unsigned char> data_;
+    /// Read position in the scene data.
+    MemoryBuffer source_;
+    /// Attribute layouts.
+    AttributeLayoutTable layouts_;
+    /// Whether attribute layouts are used.
+    bool hasLayouts_{};
+    /// Whether to collect referenced resources.
+    bool collectResources_{};
+    /// Number of root-level child nodes.
+    unsigned numNodes_{};
+    /// Number of parsed root-level child nodes.
+    unsigned numParsedNodes_{};
+    /// Mutex for the parsed nodes and resources.
+    Mutex mutex_;
+    /// Parsed nodes not taken yet.
+    ea::vector<NodeData> parsedNodes_;
+    /// Referenced resources not taken yet.
+    ea::vector<ResourceRef> resources_;
+    /// Cancelled flag.
+    std::atomic<bool> cancelled_{};
+    /// Finished flag.
+    std::atomic<bool> finished_{};
+    /// Failed flag.
+    std::atomic<bool> failed_{};
+};
+
+}
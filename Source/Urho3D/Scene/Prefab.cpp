@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/JSONFile.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/Component.h"
+#include "../Scene/Prefab.h"
+#include "../Scene/SceneResolver.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+Prefab::Prefab(Context* context) :
+    Resource(context)
+{
+}
+
+Prefab::~Prefab() = default;
+
+void Prefab::RegisterObject(Context* context)
+{
+    context->RegisterFactory<Prefab>();
+}
+
+bool Prefab::BeginLoad(Deserializer& source)
+{
+    // Objects can not be created in a worker thread, so only read the data here and compile in EndLoad()
+    loadData_.resize(source.GetSize() - source.GetPosition());
+    return source.Read(loadData_.data(), loadData_.size()) == loadData_.size();
+}
+
+bool Prefab::EndLoad()
+{
+    URHO3D_PROFILE("CompilePrefab");
+
+    // Load the file into a temporary node outside any scene, then compile from it. Keep the IDs stored in the file:
+    // without a scene they cannot clash, and rewriting would leave every ID zero and lose intra-prefab references
+    auto node = MakeShared<Node>(context_);
+    SceneResolver resolver;
+    MemoryBuffer source(loadData_);
+
+    bool success = false;
+    const char firstChar = loadData_.empty() ? '\0' : static_cast<char>(loadData_.front());
+    if (firstChar == '<')
+    {
+        XMLFile xmlFile(context_);
+        if (xmlFile.Load(source))
+        {
+            const XMLElement& root = xmlFile.GetRoot();
+            node->SetID(root.GetUInt("id"));
+            resolver.AddNode(node->GetID(), node);
+            success = node->LoadXML(root, resolver, true, false);
+        }
+    }
+    else if (firstChar == '{')
+    {
+        JSONFile jsonFile(context_);
+        if (jsonFile.Load(source))
+        {
+            const JSONValue& root = jsonFile.GetRoot();
+            node->SetID(root.Get("id").GetUInt());
+            resolver.AddNode(node->GetID(), node);
+            success = node->LoadJSON(root, resolver, true, false);
+        }
+    }
+    else
+    {
+        node->SetID(source.ReadUInt());
+        resolver.AddNode(node->GetID(), node);
+        success = node->Load(source, resolver, true, false);
+    }
+
+    loadData_.clear();
+    loadData_.shrink_to_fit();
+
+    if (!success)
+    {
+        URHO3D_LOGERROR("Could not load prefab " + GetName());
+        return false;
+    }
+
+    resolver.Resolve();
+    return Compile(node);
+}
+
+bool Prefab::Save(Serializer& dest) const
+{
+    if (data_.empty())
+    {
+        URHO3D_LOGERROR("Could not save prefab, not compiled");
+        return false;
+    }
+
+    return dest.Write(data_.data(), data_.size()) == data_.size();
+}
+
+bool Prefab::Compile(Node* node)
+{
+    if (!node || node->GetType() != Node::GetTypeStatic())
+    {
+        URHO3D_LOGERROR("Can only compile prefab from a scene node");
+        return false;
+    }
+
+    VectorBuffer buffer;
+    if (!node->Save(buffer))
+        return false;
+
+    data_ = buffer.GetBuffer();
+    nodeData_ = NodeData{};
+
+    MemoryBuffer source(data_);
+    nodeData_.id_ = source.ReadUInt();
+    if (!nodeData_.Parse(source, context_, Node::GetTypeStatic(), nullptr))
+    {
+        URHO3D_LOGERROR("Could not compile prefab from node " + node->GetName());
+        data_.clear();
+        nodeData_ = NodeData{};
+        return false;
+    }
+
+    SkipDefaultValues(node, nodeData_);
+    SetMemoryUse(sizeof(Prefab) + data_.size());
+    return true;
+}
+
+Node* Prefab::Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode) const
+{
+    URHO3D_PROFILE("InstantiatePrefab");
+
+    if (!parent || data_.empty())
+        return nullptr;
+
+    SceneResolver resolver;
+    // Rewrite IDs when instantiating
+    Node* node = parent->CreateChild(0, mode);
+    resolver.AddNode(nodeData_.id_, node);
+    if (node->Load(nodeData_, resolver, true, mode))
+    {
+        resolver.Resolve();
+        node->SetTransform(position, rotation);
+        node->ApplyAttributes();
+        return node;
+    }
+    else
+    {
+        node->Remove();
+        return nullptr;
+    }
+}
+
+void Prefab::SkipDefaultValues(Node* node, NodeData& nodeData) const
+{
+    // Same rule as in XML and JSON serialization, which do not save default values
+    const auto skipValues = [](const Serializable* serializable, ea::vector<Variant>& values)
+    {
+        const ea::vector<AttributeInfo>* attributes = serializable->GetAttributes();
+        if (!attributes || attributes->size() != values.size())
+            return;
+
+        for (unsigned i = 0; i < values.size(); ++i)
+        {
+            const AttributeInfo& attr = attributes->at(i);
+            if (!values[i].IsEmpty() && attr.ShouldSave() && !serializable->SaveDefaultAttributes(attr)
+                && values[i] == serializable->GetAttributeDefault(i))
+                values[i].Clear();
+        }
+    };
+
+    skipValues(node, nodeData.attributes_);
+
+    // Data was saved from this node, so persistent components and children match the parsed ones in order
+    unsigned componentIndex = 0;
+    for (Component* component : node->GetComponents())
+    {
+        if (component->IsTemporary() || componentIndex >= nodeData.components_.size())
+            continue;
+
+        ComponentData& componentData = nodeData.components_[componentIndex++];
+        if (componentData.parsed_)
+            skipValues(component, componentData.attributes_);
+    }
+
+    unsigned childIndex = 0;
+    for (Node* child : node->GetChildren())
+    {
+        if (!child->IsTemporary() && childIndex < nodeData.children_.size())
+            SkipDefaultValues(child, nodeData.children_[childIndex++]);
+    }
+}
+
+}
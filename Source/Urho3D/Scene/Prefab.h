@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Resource/Resource.h"
+#include "../Scene/Node.h"
+#include "../Scene/NodeData.h"
+
+namespace Urho3D
+{
+
+/// Node hierarchy compiled into an immutable template for repeated instantiation. Loaded from a binary, XML or JSON node file, or compiled from an existing node. The template is parsed once and shared by all instances, so instantiation does not parse or convert attribute data, and only applies attributes that differ from their defaults.
+class URHO3D_API Prefab : public Resource
+{
+    URHO3D_OBJECT(Prefab, Resource);
+
+public:
+    /// Construct.
+    explicit Prefab(Context* context);
+    /// Destruct.
+    ~Prefab() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Finish resource loading. Always called from the main thread. Return true if successful.
+    bool EndLoad() override;
+    /// Save template as binary node data. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Compile template from node with its components and child nodes. Temporary objects are skipped. Return true if successful.
+    bool Compile(Node* node);
+    /// Instantiate template as a child of parent node. Return the instance root node if successful.
+    Node* Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED) const;
+
+    /// Return template data.
+    const NodeData& GetNodeData() const { return nodeData_; }
+
+private:
+    /// Clear attribute values that the source objects consider default, so that they are not applied on instantiation.
+    void SkipDefaultValues(Node* node, NodeData& nodeData) const;
+
+    /// Binary node data. Raw data of components that could not be parsed points into it.
+    ea::vector<unsigned char> data_;
+    /// Parsed template.
+    NodeData nodeData_;
+    /// Source file data between BeginLoad() and EndLoad().
+    ea::vector<unsigned char> loadData_;
+};
+
+}
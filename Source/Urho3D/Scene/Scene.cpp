@@ -25,19 +25,27 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Texture2D.h"
 #include "../IO/Archive.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/AttributeLayout.h"
 #include "../Scene/CameraViewport.h"
 #include "../Scene/Component.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/Prefab.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -58,6 +66,8 @@ const char* SUBSYSTEM_CATEGORY = "Subsystem";
 
 static const float DEFAULT_SMOOTHING_CONSTANT = 50.0f;
 static const float DEFAULT_SNAP_THRESHOLD = 5.0f;
+/// Minimum number of thread-safe logic components per work item.
+static const unsigned MIN_LOGIC_COMPONENTS_PER_TASK = 64;
 
 Scene::Scene(Context* context) :
     Node(context),
@@ -119,23 +129,15 @@ void Scene::RegisterObject(Context* context)
 
 bool Scene::CreateComponentIndex(StringHash componentType)
 {
-    if (!IsEmpty())
-    {
-        URHO3D_LOGERROR("Component Index may be created only for empty Scene");
-        return false;
-    }
-
-    indexedComponentTypes_.push_back(componentType);
-    componentIndexes_.emplace_back();
+    componentIndexes_[componentType];
     return true;
 }
 
-const SceneComponentIndex& Scene::GetComponentIndex(StringHash componentType)
+const SceneComponentIndex& Scene::GetComponentIndex(StringHash componentType) const
 {
     static const SceneComponentIndex emptyIndex;
-    if (auto index = GetMutableComponentIndex(componentType))
-        return *index;
-    return emptyIndex;
+    const auto iter = componentIndexes_.find(componentType);
+    return iter != componentIndexes_.end() ? iter->second : emptyIndex;
 }
 
 bool Scene::Serialize(Archive& archive)
@@ -155,7 +157,10 @@ bool Scene::Load(Deserializer& source)
     StopAsyncLoading();
 
     // Check ID
-    if (source.ReadFileID() != "USCN")
+    const ea::string fileID = source.ReadFileID();
+    if (fileID == "USCV")
+        return LoadVersioned(source);
+    if (fileID != "USCN")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid scene file");
         return false;
@@ -199,6 +204,72 @@ bool Scene::Save(Serializer& dest) const
         return false;
 }
 
+bool Scene::SaveVersioned(Serializer& dest) const
+{
+    URHO3D_PROFILE("SaveScene");
+
+    // Write ID first
+    if (!dest.WriteFileID("USCV"))
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+
+    auto* ptr = dynamic_cast<Deserializer*>(&dest);
+    if (ptr)
+        URHO3D_LOGINFO("Saving scene to " + ptr->GetName());
+
+    // Collect the attribute layouts of all saved types, and the object counts for preallocating on load
+    AttributeLayoutTable layouts;
+    unsigned numNodes = 0;
+    unsigned numComponents = 0;
+    layouts.AddLayout(context_, GetType());
+
+    ea::vector<const Node*> nodes{this};
+    while (!nodes.empty())
+    {
+        const Node* node = nodes.back();
+        nodes.pop_back();
+
+        for (Component* component : node->GetComponents())
+        {
+            if (!component->IsTemporary())
+            {
+                layouts.AddLayout(context_, component->GetType());
+                ++numComponents;
+            }
+        }
+
+        for (Node* child : node->GetChildren())
+        {
+            if (!child->IsTemporary())
+            {
+                layouts.AddLayout(context_, child->GetType());
+                nodes.push_back(child);
+                ++numNodes;
+            }
+        }
+    }
+
+    dest.WriteUInt(SCENE_BINARY_VERSION);
+    dest.WriteVLE(numNodes);
+    dest.WriteVLE(numComponents);
+    if (!layouts.Write(dest))
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+
+    // Node data follows in the same format as in the legacy binary scene
+    if (Node::Save(dest))
+    {
+        FinishSaving(&dest);
+        return true;
+    }
+    else
+        return false;
+}
+
 bool Scene::LoadXML(const XMLElement& source)
 {
     URHO3D_PROFILE("LoadSceneXML");
@@ -384,7 +455,9 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
     StopAsyncLoading();
 
     // Check ID
-    bool isSceneFile = file->ReadFileID() == "USCN";
+    const ea::string fileID = file->ReadFileID();
+    const bool isVersioned = fileID == "USCV";
+    bool isSceneFile = isVersioned || fileID == "USCN";
     if (!isSceneFile)
     {
         // In resource load mode can load also object prefabs, which have no identifier
@@ -397,6 +470,15 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
             file->Seek(0);
     }
 
+    AttributeLayoutTable layouts;
+    if (isVersioned)
+    {
+        unsigned numNodes = 0;
+        unsigned numComponents = 0;
+        if (!ReadVersionedHeader(*file, layouts, numNodes, numComponents))
+            return false;
+    }
+
     if (mode > LOAD_RESOURCES_ONLY)
     {
         URHO3D_LOGINFO("Loading scene from " + file->GetName());
@@ -411,36 +493,60 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
 
     if (mode > LOAD_RESOURCES_ONLY)
     {
-        // Preload resources if appropriate, then return to the original position for loading the scene content
+        // Store own old ID for resolving possible root node references
+        unsigned nodeID = file->ReadUInt();
+        resolver_.AddNode(nodeID, this);
+
+        ea::vector<unsigned char> data(file->GetSize() - file->GetPosition());
+        if (file->Read(data.data(), data.size()) != data.size())
+        {
+            URHO3D_LOGERROR("Could not read scene data from " + file->GetName());
+            StopAsyncLoading();
+            return false;
+        }
+        MemoryBuffer source(data);
+
+        // Preload resources of the root level components, unless disabled, before loading them first
         if (mode != LOAD_SCENE)
         {
             URHO3D_PROFILE("FindResourcesToPreload");
 
-            unsigned currentPos = file->GetPosition();
-            PreloadResources(file, isSceneFile);
-            file->Seek(currentPos);
+            NodeData rootData;
+            ea::vector<ResourceRef> resources;
+            // Preload what could be parsed even if the data is invalid
+            rootData.Parse(source, context_, GetType(), isVersioned ? &layouts : nullptr, false);
+            rootData.CollectResources(resources);
+            for (const ResourceRef& resource : resources)
+                PreloadResource(resource);
+            source.Seek(0);
         }
 
-        // Store own old ID for resolving possible root node references
-        unsigned nodeID = file->ReadUInt();
-        resolver_.AddNode(nodeID, this);
-
-        // Load root level components first
-        if (!Node::Load(*file, resolver_, false))
+        if (!Node::Load(source, resolver_, false, false, REPLICATED, isVersioned ? &layouts : nullptr))
         {
             StopAsyncLoading();
             return false;
         }
 
-        // Then prepare to load child nodes in the async updates
-        asyncProgress_.totalNodes_ = file->ReadVLE();
+        // Then parse child nodes in the background and instantiate them in the async updates. Resources referenced by
+        // the child nodes are preloaded as they are parsed, unless disabled
+        asyncProgress_.totalNodes_ = source.ReadVLE();
+        data.erase(data.begin(), data.begin() + source.GetPosition());
+
+        asyncProgress_.parser_ = ea::make_shared<BinarySceneParser>(context_, ea::move(data),
+            isVersioned ? &layouts : nullptr, asyncProgress_.totalNodes_, mode != LOAD_SCENE);
+
+        // Without worker threads, parse in the async updates instead
+        auto* queue = GetSubsystem<WorkQueue>();
+        asyncProgress_.parseOnMainThread_ = !queue || !queue->GetNumThreads();
+        if (!asyncProgress_.parseOnMainThread_)
+            queue->AddWorkItem([parser = asyncProgress_.parser_]() { parser->ParseAll(); });
     }
     else
     {
         URHO3D_PROFILE("FindResourcesToPreload");
 
         URHO3D_LOGINFO("Preloading resources from " + file->GetName());
-        PreloadResources(file, isSceneFile);
+        PreloadResources(file, isSceneFile, isVersioned ? &layouts : nullptr);
     }
 
     return true;
@@ -589,6 +695,12 @@ void Scene::StopAsyncLoading()
     asyncProgress_.xmlElement_ = XMLElement::EMPTY;
     asyncProgress_.jsonIndex_ = 0;
     asyncProgress_.resources_.clear();
+    // A worker thread may still be parsing; it stops at the next node and releases its reference
+    if (asyncProgress_.parser_)
+        asyncProgress_.parser_->Cancel();
+    asyncProgress_.parser_.reset();
+    asyncProgress_.parsedNodes_.clear();
+    asyncProgress_.parsedNodeIndex_ = 0;
     resolver_.Reset();
 }
 
@@ -772,8 +884,8 @@ void Scene::UnregisterAllVars()
 
 bool Scene::IsEmpty(bool ignoreComponents) const
 {
-    const bool noNodesExceptSelf = replicatedNodes_.size() == 1 && localNodes_.size() == 0;
-    const bool noComponents = replicatedComponents_.size() == 0 && localComponents_.size() == 0;
+    const bool noNodesExceptSelf = replicatedNodes_.Size() == 1 && localNodes_.Size() == 0;
+    const bool noComponents = replicatedComponents_.Size() == 0 && localComponents_.Size() == 0;
     return noNodesExceptSelf && (noComponents || ignoreComponents);
 }
 
@@ -781,13 +893,11 @@ Node* Scene::GetNode(unsigned id) const
 {
     if (IsReplicatedID(id))
     {
-        auto i = replicatedNodes_.find(id);
-        return i != replicatedNodes_.end() ? i->second : nullptr;
+        return replicatedNodes_.Get(id);
     }
     else
     {
-        auto i = localNodes_.find(id);
-        return i != localNodes_.end() ? i->second : nullptr;
+        return localNodes_.Get(id);
     }
 }
 
@@ -808,13 +918,11 @@ Component* Scene::GetComponent(unsigned id) const
 {
     if (IsReplicatedID(id))
     {
-        auto i = replicatedComponents_.find(id);
-        return i != replicatedComponents_.end() ? i->second : nullptr;
+        return replicatedComponents_.Get(id);
     }
     else
     {
-        auto i = localComponents_.find(id);
-        return i != localComponents_.end() ? i->second : nullptr;
+        return localComponents_.Get(id);
     }
 }
 
@@ -847,18 +955,32 @@ void Scene::Update(float timeStep)
 
     using namespace SceneUpdate;
 
+    SceneUpdateArgs updateArgs;
+    updateArgs.timeStep_ = timeStep;
+
+    // Typed signal handlers run on the same event nesting level and may reuse the event data map, so fill it before each send
     VariantMap& eventData = GetEventDataMap();
-    eventData[P_SCENE] = this;
-    eventData[P_TIMESTEP] = timeStep;
+    const auto sendUpdateEvent = [&](StringHash eventType)
+    {
+        eventData[P_SCENE] = this;
+        eventData[P_TIMESTEP] = timeStep;
+        SendEvent(eventType, eventData);
+    };
 
     // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
+    UpdateLogicComponents(USE_UPDATE, timeStep);
+    updateScheduler_.Run(this, SUP_UPDATE, timeStep);
+    sceneUpdateEvent_(this, updateArgs);
+    sendUpdateEvent(E_SCENEUPDATE);
 
     // Update scene attribute animation.
-    SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
+    updateScheduler_.Run(this, SUP_ATTRIBUTEANIMATION, timeStep);
+    sendUpdateEvent(E_ATTRIBUTEANIMATIONUPDATE);
 
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
-    SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
+    updateScheduler_.Run(this, SUP_SUBSYSTEM, timeStep);
+    sceneSubsystemUpdateEvent_(this, updateArgs);
+    sendUpdateEvent(E_SCENESUBSYSTEMUPDATE);
 
     // Update transform smoothing
     {
@@ -867,15 +989,29 @@ void Scene::Update(float timeStep)
         float constant = 1.0f - Clamp(powf(2.0f, -timeStep * smoothingConstant_), 0.0f, 1.0f);
         float squaredSnapThreshold = snapThreshold_ * snapThreshold_;
 
-        using namespace UpdateSmoothing;
+        updateScheduler_.Run(this, SUP_SMOOTHING, timeStep);
 
-        smoothingData_[P_CONSTANT] = constant;
-        smoothingData_[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold;
-        SendEvent(E_UPDATESMOOTHING, smoothingData_);
+        SceneSmoothingArgs smoothingArgs;
+        smoothingArgs.constant_ = constant;
+        smoothingArgs.squaredSnapThreshold_ = squaredSnapThreshold;
+        smoothingArgs.interpolationTime_ = networkInterpolationTime_;
+        updateSmoothingEvent_(this, smoothingArgs);
+
+        if (HasEventReceivers(E_UPDATESMOOTHING))
+        {
+            using namespace UpdateSmoothing;
+
+            smoothingData_[P_CONSTANT] = constant;
+            smoothingData_[P_SQUAREDSNAPTHRESHOLD] = squaredSnapThreshold;
+            SendEvent(E_UPDATESMOOTHING, smoothingData_);
+        }
     }
 
     // Post-update variable timestep logic
-    SendEvent(E_SCENEPOSTUPDATE, eventData);
+    UpdateLogicComponents(USE_POSTUPDATE, timeStep);
+    updateScheduler_.Run(this, SUP_POSTUPDATE, timeStep);
+    scenePostUpdateEvent_(this, updateArgs);
+    sendUpdateEvent(E_SCENEPOSTUPDATE);
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -883,6 +1019,101 @@ void Scene::Update(float timeStep)
     elapsedTime_ += timeStep;
 }
 
+LogicComponentUpdateList& Scene::GetLogicUpdateList(UpdateEvent phase, bool threadSafe)
+{
+    const unsigned phaseIndex = GetLogicUpdatePhaseIndex(phase);
+    return threadSafe ? threadSafeLogicUpdateLists_[phaseIndex] : logicUpdateLists_[phaseIndex];
+}
+
+void Scene::SetFixedUpdateSource(Component* source)
+{
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    if (source == fixedUpdateSource_)
+        return;
+
+    if (fixedUpdateSource_)
+    {
+        UnsubscribeFromEvent(fixedUpdateSource_, E_PHYSICSPRESTEP);
+        UnsubscribeFromEvent(fixedUpdateSource_, E_PHYSICSPOSTSTEP);
+    }
+
+    fixedUpdateSource_ = source;
+
+    if (source)
+    {
+        SubscribeToEvent(source, E_PHYSICSPRESTEP, URHO3D_HANDLER(Scene, HandlePhysicsPreStep));
+        SubscribeToEvent(source, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(Scene, HandlePhysicsPostStep));
+    }
+#endif
+}
+
+void Scene::UpdateLogicComponents(UpdateEvent phase, float timeStep)
+{
+    const unsigned phaseIndex = GetLogicUpdatePhaseIndex(phase);
+    LogicComponentUpdateList& threadSafeList = threadSafeLogicUpdateLists_[phaseIndex];
+    LogicComponentUpdateList& list = logicUpdateLists_[phaseIndex];
+
+    threadSafeList.Compact(phase);
+    list.Compact(phase);
+
+    if (!threadSafeList.IsEmpty())
+        UpdateLogicComponentsThreaded(threadSafeList, phase, timeStep);
+
+    // Components added during the update are updated starting from the next frame
+    const unsigned numComponents = list.GetSize();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        if (LogicComponent* component = list.GetComponent(i))
+            component->ExecuteUpdate(phase, timeStep);
+    }
+}
+
+void Scene::UpdateLogicComponentsThreaded(LogicComponentUpdateList& list, UpdateEvent phase, float timeStep)
+{
+    // Delayed start may touch other components and objects, so it is always executed on the main thread
+    const unsigned numComponents = list.GetSize();
+    if (phase == USE_UPDATE || phase == USE_FIXEDUPDATE)
+    {
+        for (unsigned i = 0; i < numComponents; ++i)
+        {
+            if (LogicComponent* component = list.GetComponent(i))
+                component->ExecuteDelayedStart();
+        }
+    }
+
+    // Work queue may be used only from main thread
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numTasks = queue && Thread::IsMainThread() && !queue->IsCompleting()
+        ? Min(queue->GetNumThreads() + 1, numComponents / MIN_LOGIC_COMPONENTS_PER_TASK) : 1;
+
+    const auto updateRange = [&list, phase, timeStep](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            if (LogicComponent* component = list.GetComponent(i))
+                component->ExecuteUpdate(phase, timeStep);
+        }
+    };
+
+    if (numTasks <= 1)
+    {
+        updateRange(0, numComponents);
+        return;
+    }
+
+    URHO3D_PROFILE("UpdateLogicComponentsThreaded");
+
+    BeginThreadedUpdate();
+    const unsigned componentsPerTask = (numComponents + numTasks - 1) / numTasks;
+    for (unsigned begin = 0; begin < numComponents; begin += componentsPerTask)
+    {
+        const unsigned end = Min(begin + componentsPerTask, numComponents);
+        queue->AddWorkItem([=, &updateRange]() { updateRange(begin, end); }, M_MAX_UNSIGNED);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+    EndThreadedUpdate();
+}
+
 void Scene::BeginThreadedUpdate()
 {
     // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
@@ -926,7 +1157,7 @@ unsigned Scene::GetFreeNodeID(CreateMode mode)
             else
                 replicatedNodeID_ = FIRST_REPLICATED_ID;
 
-            if (!replicatedNodes_.contains(ret))
+            if (!replicatedNodes_.Contains(ret))
                 return ret;
         }
     }
@@ -940,7 +1171,7 @@ unsigned Scene::GetFreeNodeID(CreateMode mode)
             else
                 localNodeID_ = FIRST_LOCAL_ID;
 
-            if (!localNodes_.contains(ret))
+            if (!localNodes_.Contains(ret))
                 return ret;
         }
     }
@@ -958,7 +1189,7 @@ unsigned Scene::GetFreeComponentID(CreateMode mode)
             else
                 replicatedComponentID_ = FIRST_REPLICATED_ID;
 
-            if (!replicatedComponents_.contains(ret))
+            if (!replicatedComponents_.Contains(ret))
                 return ret;
         }
     }
@@ -972,7 +1203,7 @@ unsigned Scene::GetFreeComponentID(CreateMode mode)
             else
                 localComponentID_ = FIRST_LOCAL_ID;
 
-            if (!localComponents_.contains(ret))
+            if (!localComponents_.Contains(ret))
                 return ret;
         }
     }
@@ -1001,27 +1232,27 @@ void Scene::NodeAdded(Node* node)
     // If node with same ID exists, remove the scene reference from it and overwrite with the new node
     if (IsReplicatedID(id))
     {
-        auto i = replicatedNodes_.find(id);
-        if (i != replicatedNodes_.end() && i->second != node)
+        Node* existing = replicatedNodes_.Get(id);
+        if (existing && existing != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + ea::to_string(id));
-            NodeRemoved(i->second);
+            NodeRemoved(existing);
         }
 
-        replicatedNodes_[id] = node;
+        replicatedNodes_.Set(id, node);
 
         MarkNetworkUpdate(node);
         MarkReplicationDirty(node);
     }
     else
     {
-        auto i = localNodes_.find(id);
-        if (i != localNodes_.end() && i->second != node)
+        Node* existing = localNodes_.Get(id);
+        if (existing && existing != node)
         {
             URHO3D_LOGWARNING("Overwriting node with ID " + ea::to_string(id));
-            NodeRemoved(i->second);
+            NodeRemoved(existing);
         }
-        localNodes_[id] = node;
+        localNodes_.Set(id, node);
     }
 
     // Cache tag if already tagged.
@@ -1059,11 +1290,12 @@ void Scene::NodeRemoved(Node* node)
     unsigned id = node->GetID();
     if (Scene::IsReplicatedID(id))
     {
-        replicatedNodes_.erase(id);
+        replicatedNodes_.Erase(id);
+        interestGrid_.RemoveNode(id);
         MarkReplicationDirty(node);
     }
     else
-        localNodes_.erase(id);
+        localNodes_.Erase(id);
 
     node->ResetScene();
 
@@ -1100,31 +1332,35 @@ void Scene::ComponentAdded(Component* component)
 
     if (IsReplicatedID(id))
     {
-        auto i = replicatedComponents_.find(id);
-        if (i != replicatedComponents_.end() && i->second != component)
+        Component* existing = replicatedComponents_.Get(id);
+        if (existing && existing != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + ea::to_string(id));
-            ComponentRemoved(i->second);
+            ComponentRemoved(existing);
         }
 
-        replicatedComponents_[id] = component;
+        replicatedComponents_.Set(id, component);
     }
     else
     {
-        auto i = localComponents_.find(id);
-        if (i != localComponents_.end() && i->second != component)
+        Component* existing = localComponents_.Get(id);
+        if (existing && existing != component)
         {
             URHO3D_LOGWARNING("Overwriting component with ID " + ea::to_string(id));
-            ComponentRemoved(i->second);
+            ComponentRemoved(existing);
         }
 
-        localComponents_[id] = component;
+        localComponents_.Set(id, component);
     }
 
     component->OnSceneSet(this);
 
-    if (auto index = GetMutableComponentIndex(component->GetType()))
-        index->insert(component);
+    SceneComponentIndex& index = componentIndexes_[component->GetType()];
+    if (component->indexPosition_ >= index.size() || index[component->indexPosition_] != component)
+    {
+        component->indexPosition_ = index.size();
+        index.push_back(component);
+    }
 }
 
 void Scene::ComponentRemoved(Component* component)
@@ -1132,14 +1368,26 @@ void Scene::ComponentRemoved(Component* component)
     if (!component)
         return;
 
-    if (auto index = GetMutableComponentIndex(component->GetType()))
-        index->erase(component);
+    const auto indexIter = componentIndexes_.find(component->GetType());
+    if (indexIter != componentIndexes_.end())
+    {
+        // Swap with the last component to keep the array dense
+        SceneComponentIndex& index = indexIter->second;
+        const unsigned position = component->indexPosition_;
+        if (position < index.size() && index[position] == component)
+        {
+            Component* last = index.back();
+            index[position] = last;
+            last->indexPosition_ = position;
+            index.pop_back();
+        }
+    }
 
     unsigned id = component->GetID();
     if (Scene::IsReplicatedID(id))
-        replicatedComponents_.erase(id);
+        replicatedComponents_.Erase(id);
     else
-        localComponents_.erase(id);
+        localComponents_.Erase(id);
 
     component->SetID(0);
     component->OnSceneSet(nullptr);
@@ -1171,11 +1419,25 @@ ea::string Scene::GetVarNamesAttr() const
 
 void Scene::PrepareNetworkUpdate()
 {
+    ++networkFrame_;
+    networkTime_ = Time::GetSystemTime();
+
     for (auto i = networkUpdateNodes_.begin(); i != networkUpdateNodes_.end(); ++i)
     {
         Node* node = GetNode(*i);
         if (node)
+        {
             node->PrepareNetworkUpdate();
+
+            // Moved, added and reparented nodes are all marked for network update, so this keeps the grid current
+            if (interestGrid_.IsEnabled())
+            {
+                if (node->GetParent() == this)
+                    interestGrid_.UpdateNode(node->GetID(), node->GetWorldPosition());
+                else
+                    interestGrid_.RemoveNode(node->GetID());
+            }
+        }
     }
 
     for (auto i = networkUpdateComponents_.begin(); i != networkUpdateComponents_.end(); ++i)
@@ -1189,6 +1451,19 @@ void Scene::PrepareNetworkUpdate()
     networkUpdateComponents_.clear();
 }
 
+void Scene::SetInterestCellSize(float size)
+{
+    interestGrid_.SetCellSize(size);
+    if (!interestGrid_.IsEnabled())
+        return;
+
+    for (Node* child : GetChildren())
+    {
+        if (child->IsReplicated())
+            interestGrid_.UpdateNode(child->GetID(), child->GetWorldPosition());
+    }
+}
+
 void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
@@ -1251,6 +1526,24 @@ void Scene::HandleUpdate(StringHash eventType, VariantMap& eventData)
     Update(eventData[P_TIMESTEP].GetFloat());
 }
 
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+
+void Scene::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    UpdateLogicComponents(USE_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void Scene::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+
+    UpdateLogicComponents(USE_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#endif
+
 void Scene::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
 {
     using namespace ResourceBackgroundLoaded;
@@ -1270,12 +1563,35 @@ void Scene::UpdateAsyncLoading()
 {
     URHO3D_PROFILE("UpdateAsyncLoading");
 
+    HiresTimer asyncLoadTimer;
+
+    BinarySceneParser* parser = asyncProgress_.parser_.get();
+    if (parser)
+    {
+        if (asyncProgress_.parseOnMainThread_)
+        {
+            while (parser->ParseNext() && asyncLoadTimer.GetUSec(false) < asyncLoadingMs_ * 1000LL)
+            {
+            }
+        }
+
+        if (asyncProgress_.mode_ != LOAD_SCENE)
+        {
+            ea::vector<ResourceRef> resources;
+            parser->TakeResources(resources);
+            for (const ResourceRef& resource : resources)
+                PreloadResource(resource);
+
+            // All resources are known only after all nodes are parsed
+            if (!parser->IsFinished())
+                return;
+        }
+    }
+
     // If resources left to load, do not load nodes yet
     if (asyncProgress_.loadedResources_ < asyncProgress_.totalResources_)
         return;
 
-    HiresTimer asyncLoadTimer;
-
     for (;;)
     {
         if (asyncProgress_.loadedNodes_ >= asyncProgress_.totalNodes_)
@@ -1306,12 +1622,32 @@ void Scene::UpdateAsyncLoading()
             newNode->LoadJSON(childValue, resolver_);
             ++asyncProgress_.jsonIndex_;
         }
-        else // Load from binary
+        else // Load from binary data parsed in the background
         {
-            unsigned nodeID = asyncProgress_.file_->ReadUInt();
-            Node* newNode = CreateChild(nodeID, IsReplicatedID(nodeID) ? REPLICATED : LOCAL);
-            resolver_.AddNode(nodeID, newNode);
-            newNode->Load(*asyncProgress_.file_, resolver_);
+            if (asyncProgress_.parsedNodeIndex_ >= asyncProgress_.parsedNodes_.size())
+            {
+                asyncProgress_.parsedNodes_.clear();
+                asyncProgress_.parsedNodeIndex_ = 0;
+                parser->TakeParsedNodes(asyncProgress_.parsedNodes_);
+
+                if (asyncProgress_.parsedNodes_.empty())
+                {
+                    // Finish with the nodes loaded so far if the rest of the file is invalid
+                    if (parser->IsFailed())
+                    {
+                        FinishAsyncLoading();
+                        return;
+                    }
+
+                    // Wait for the parser
+                    break;
+                }
+            }
+
+            const NodeData& nodeData = asyncProgress_.parsedNodes_[asyncProgress_.parsedNodeIndex_++];
+            Node* newNode = CreateChild(nodeData.id_, IsReplicatedID(nodeData.id_) ? REPLICATED : LOCAL);
+            resolver_.AddNode(nodeData.id_, newNode);
+            newNode->Load(nodeData, resolver_);
         }
 
         ++asyncProgress_.loadedNodes_;
@@ -1351,6 +1687,70 @@ void Scene::FinishAsyncLoading()
     SendEvent(E_ASYNCLOADFINISHED, eventData);
 }
 
+bool Scene::ReadVersionedHeader(Deserializer& source, AttributeLayoutTable& layouts, unsigned& numNodes, unsigned& numComponents)
+{
+    const unsigned version = source.ReadUInt();
+    if (version == 0 || version > SCENE_BINARY_VERSION)
+    {
+        URHO3D_LOGERROR(source.GetName() + " has unsupported scene format version " + ea::to_string(version));
+        return false;
+    }
+
+    numNodes = source.ReadVLE();
+    numComponents = source.ReadVLE();
+    return layouts.Read(source, context_);
+}
+
+bool Scene::LoadVersioned(Deserializer& source)
+{
+    AttributeLayoutTable layouts;
+    unsigned numNodes = 0;
+    unsigned numComponents = 0;
+    if (!ReadVersionedHeader(source, layouts, numNodes, numComponents))
+        return false;
+
+    URHO3D_LOGINFO("Loading scene from " + source.GetName());
+
+    // Read the rest of the file at once unless it is already in memory. Component data is then parsed in place
+    ea::vector<unsigned char> sceneData;
+    auto* memorySource = dynamic_cast<MemoryBuffer*>(&source);
+    if (!memorySource)
+    {
+        sceneData.resize(source.GetSize() - source.GetPosition());
+        if (source.Read(sceneData.data(), sceneData.size()) != sceneData.size())
+        {
+            URHO3D_LOGERROR("Could not read scene data from " + source.GetName());
+            return false;
+        }
+    }
+    MemoryBuffer sceneBuffer(memorySource ? memorySource->GetData() + memorySource->GetPosition() : sceneData.data(),
+        memorySource ? memorySource->GetSize() - memorySource->GetPosition() : sceneData.size());
+
+    Clear();
+
+    // Most nodes and components of a scene file are replicated
+    replicatedNodes_.Reserve(numNodes + 1);
+    replicatedComponents_.Reserve(numComponents);
+
+    SceneResolver resolver;
+    resolver.Reserve(numNodes + 1, numComponents);
+
+    // Store own old ID for resolving possible root node references
+    const unsigned nodeID = sceneBuffer.ReadUInt();
+    resolver.AddNode(nodeID, this);
+
+    const bool success = Node::Load(sceneBuffer, resolver, true, false, REPLICATED, &layouts);
+    if (memorySource)
+        memorySource->Seek(memorySource->GetPosition() + sceneBuffer.GetPosition());
+    if (!success)
+        return false;
+
+    resolver.Resolve();
+    ApplyAttributes();
+    FinishLoading(&source);
+    return true;
+}
+
 void Scene::FinishLoading(Deserializer* source)
 {
     if (source)
@@ -1372,79 +1772,41 @@ void Scene::FinishSaving(Serializer* dest) const
     }
 }
 
-void Scene::PreloadResources(File* file, bool isSceneFile)
+void Scene::PreloadResource(const ResourceRef& resource)
 {
     // If not threaded, can not background load resources, so rather load synchronously later when needed
 #ifdef URHO3D_THREADING
     auto* cache = GetSubsystem<ResourceCache>();
 
-    // Read node ID (not needed)
-    /*unsigned nodeID = */file->ReadUInt();
-
-    // Read Node or Scene attributes; these do not include any resources
-    const ea::vector<AttributeInfo>* attributes = context_->GetAttributes(isSceneFile ? Scene::GetTypeStatic() : Node::GetTypeStatic());
-    assert(attributes);
-
-    for (unsigned i = 0; i < attributes->size(); ++i)
+    // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
+    ea::string name = cache->SanitateResourceName(resource.name_);
+    bool success = cache->BackgroundLoadResource(resource.type_, name);
+    if (success)
     {
-        const AttributeInfo& attr = attributes->at(i);
-        if (!(attr.mode_ & AM_FILE))
-            continue;
-        /*Variant varValue = */file->ReadVariant(attr.type_);
+        ++asyncProgress_.totalResources_;
+        asyncProgress_.resources_.insert(StringHash(name));
     }
+#endif
+}
 
-    // Read component attributes
-    unsigned numComponents = file->ReadVLE();
-    for (unsigned i = 0; i < numComponents; ++i)
-    {
-        VectorBuffer compBuffer(*file, file->ReadVLE());
-        StringHash compType = compBuffer.ReadStringHash();
-        // Read component ID (not needed)
-        /*unsigned compID = */compBuffer.ReadUInt();
+void Scene::PreloadResources(File* file, bool isSceneFile, const AttributeLayoutTable* layouts)
+{
+    // If not threaded, can not background load resources, so rather load synchronously later when needed
+#ifdef URHO3D_THREADING
+    ea::vector<unsigned char> data(file->GetSize() - file->GetPosition());
+    if (file->Read(data.data(), data.size()) != data.size())
+        return;
 
-        attributes = context_->GetAttributes(compType);
-        if (attributes)
-        {
-            for (unsigned j = 0; j < attributes->size(); ++j)
-            {
-                const AttributeInfo& attr = attributes->at(j);
-                if (!(attr.mode_ & AM_FILE))
-                    continue;
-                Variant varValue = compBuffer.ReadVariant(attr.type_);
-                if (attr.type_ == VAR_RESOURCEREF)
-                {
-                    const ResourceRef& ref = varValue.GetResourceRef();
-                    // Sanitate resource name beforehand so that when we get the background load event, the name matches exactly
-                    ea::string name = cache->SanitateResourceName(ref.name_);
-                    bool success = cache->BackgroundLoadResource(ref.type_, name);
-                    if (success)
-                    {
-                        ++asyncProgress_.totalResources_;
-                        asyncProgress_.resources_.insert(StringHash(name));
-                    }
-                }
-                else if (attr.type_ == VAR_RESOURCEREFLIST)
-                {
-                    const ResourceRefList& refList = varValue.GetResourceRefList();
-                    for (unsigned k = 0; k < refList.names_.size(); ++k)
-                    {
-                        ea::string name = cache->SanitateResourceName(refList.names_[k]);
-                        bool success = cache->BackgroundLoadResource(refList.type_, name);
-                        if (success)
-                        {
-                            ++asyncProgress_.totalResources_;
-                            asyncProgress_.resources_.insert(StringHash(name));
-                        }
-                    }
-                }
-            }
-        }
-    }
+    MemoryBuffer source(data);
+    NodeData rootData;
+    rootData.id_ = source.ReadUInt();
+    // Preload what could be parsed even if the data is invalid
+    rootData.Parse(source, context_, isSceneFile ? Scene::GetTypeStatic() : Node::GetTypeStatic(), layouts);
 
-    // Read child nodes
-    unsigned numChildren = file->ReadVLE();
-    for (unsigned i = 0; i < numChildren; ++i)
-        PreloadResources(file, false);
+    ea::vector<ResourceRef> resources;
+    rootData.CollectResources(resources);
+    for (const ResourceRef& resource : resources)
+        PreloadResource(resource);
 #endif
 }
 
@@ -1611,21 +1973,11 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
 #endif
 }
 
-SceneComponentIndex* Scene::GetMutableComponentIndex(StringHash componentType)
-{
-    if (indexedComponentTypes_.empty())
-        return nullptr;
-
-    const unsigned idx = indexedComponentTypes_.index_of(componentType);
-    if (idx < componentIndexes_.size())
-        return &componentIndexes_[idx];
-    return nullptr;
-}
-
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
     ObjectAnimation::RegisterObject(context);
+    Prefab::RegisterObject(context);
     Node::RegisterObject(context);
     Scene::RegisterObject(context);
     SmoothedTransform::RegisterObject(context);
@@ -24,14 +24,22 @@
 
 #pragma once
 
+#include <EASTL/shared_ptr.h>
 #include <EASTL/span.h>
+#include <EASTL/tuple.h>
 #include <EASTL/unique_ptr.h>
 
+#include "../Container/IdMap.h"
 #include "../Core/Mutex.h"
+#include "../Core/Signal.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/InterestGrid.h"
+#include "../Scene/LogicComponent.h"
 #include "../Scene/Node.h"
+#include "../Scene/NodeData.h"
 #include "../Scene/SceneResolver.h"
+#include "../Scene/SceneUpdateScheduler.h"
 
 namespace Urho3D
 {
@@ -84,10 +92,37 @@ struct AsyncProgress
     unsigned loadedNodes_;
     /// Total root-level nodes.
     unsigned totalNodes_;
+
+    /// Parser of binary root-level child nodes.
+    ea::shared_ptr<BinarySceneParser> parser_;
+    /// Whether the parser runs in the async updates instead of a worker thread.
+    bool parseOnMainThread_{};
+    /// Parsed root-level child nodes taken from the parser.
+    ea::vector<NodeData> parsedNodes_;
+    /// Next parsed root-level child node to instantiate.
+    unsigned parsedNodeIndex_{};
+};
+
+/// Arguments of typed scene update signals.
+struct SceneUpdateArgs
+{
+    /// Scaled time step.
+    float timeStep_{};
 };
 
-/// Index of components in the Scene.
-using SceneComponentIndex = ea::hash_set<Component*>;
+/// Arguments of typed transform smoothing signal.
+struct SceneSmoothingArgs
+{
+    /// Smoothing blend constant.
+    float constant_{};
+    /// Squared snap threshold.
+    float squaredSnapThreshold_{};
+    /// Server time in seconds at which to show interpolated transforms, or zero to use exponential smoothing.
+    double interpolationTime_{};
+};
+
+/// Index of components in the Scene. Dense array of all components of one type, order is unspecified and changes on removal.
+using SceneComponentIndex = ea::vector<Component*>;
 
 /// Root scene node, represents the whole scene.
 class URHO3D_API Scene : public Node
@@ -109,14 +144,20 @@ public:
     /// Register object factory. Node must be registered first.
     static void RegisterObject(Context* context);
 
-    /// Create component index. Scene must be empty.
+    /// Create component index. All component types are always indexed, so this only reserves the index storage.
     bool CreateComponentIndex(StringHash componentType);
-    /// Create component index for template type. Scene must be empty.
+    /// Create component index for template type.
     template <class T> void CreateComponentIndex() { CreateComponentIndex(T::GetTypeStatic()); }
-    /// Return component index. Iterable. Invalidated when indexed component is added or removed!
-    const SceneComponentIndex& GetComponentIndex(StringHash componentType);
-    /// Return component index for template type. Invalidated when indexed component is added or removed!
-    template <class T> const SceneComponentIndex& GetComponentIndex() { return GetComponentIndex(T::GetTypeStatic()); }
+    /// Return all components of exact type in the scene. Iterable. Invalidated when a component of that type is added or removed!
+    const SceneComponentIndex& GetComponentIndex(StringHash componentType) const;
+    /// Return all components of exact template type in the scene. Invalidated when a component of that type is added or removed!
+    template <class T> const SceneComponentIndex& GetComponentIndex() const { return GetComponentIndex(T::GetTypeStatic()); }
+    /// Return number of components of exact type in the scene.
+    unsigned GetNumComponentsOfType(StringHash componentType) const { return GetComponentIndex(componentType).size(); }
+    /// Invoke callback(T*, Others*...) for each component of type T whose node also has components of all other types. Iterates the index of T, so T should be the rarest type. Optionally skip components that are not effectively enabled. Components of the queried types must not be added or removed from the callback.
+    template <class T, class... Others, class Callback> void ForEachComponent(Callback callback, bool enabledOnly = false) const;
+    /// Return components of type T whose node also has components of all other types.
+    template <class T, class... Others> void QueryComponents(ea::vector<T*>& dest, bool enabledOnly = false) const;
 
     /// Serialize from/to archive. Return true if successful.
     bool Serialize(Archive& archive) override;
@@ -125,6 +166,8 @@ public:
     bool Load(Deserializer& source) override;
     /// Save to binary data. Return true if successful.
     bool Save(Serializer& dest) const override;
+    /// Save to versioned binary data, which stores the attribute layout of each type and loads faster than the other formats. Loaded with Load(). Return true if successful.
+    bool SaveVersioned(Serializer& dest) const;
     /// Load from XML data. Removes all existing child nodes and components first. Return true if successful.
     bool LoadXML(const XMLElement& source) override;
     /// Load from JSON data. Removes all existing child nodes and components first. Return true if successful.
@@ -212,6 +255,10 @@ public:
     Node* GetNode(unsigned id) const;
     /// Return component from the whole scene by ID, or null if not found.
     Component* GetComponent(unsigned id) const;
+    /// Return number of replicated nodes, including the scene itself.
+    unsigned GetNumReplicatedNodes() const { return replicatedNodes_.Size(); }
+    /// Return number of local nodes.
+    unsigned GetNumLocalNodes() const { return localNodes_.Size(); }
     /// Get nodes with specific tag from the whole scene, return false if empty.
     bool GetNodesWithTag(ea::vector<Node*>& dest, const ea::string& tag)  const;
 
@@ -278,6 +325,14 @@ public:
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
 
+    /// Return scheduler of scene update tasks.
+    SceneUpdateScheduler& GetUpdateScheduler() { return updateScheduler_; }
+
+    /// Return logic component update list of given phase. Used by LogicComponent.
+    LogicComponentUpdateList& GetLogicUpdateList(UpdateEvent phase, bool threadSafe);
+    /// Set the physics world whose steps drive logic component fixed updates. Used by LogicComponent.
+    void SetFixedUpdateSource(Component* source);
+
     /// Get free node ID, either non-local or local.
     unsigned GetFreeNodeID(CreateMode mode);
     /// Get free component ID, either non-local or local.
@@ -302,8 +357,26 @@ public:
     void SetVarNamesAttr(const ea::string& value);
     /// Return node user variable reverse mappings.
     ea::string GetVarNamesAttr() const;
-    /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
+    /// Prepare network update by comparing attributes and marking replication states dirty as necessary. Advances the network frame.
     void PrepareNetworkUpdate();
+    /// Return number of the current network update on the server. Identifies snapshots in snapshot replication.
+    unsigned GetNetworkFrame() const { return networkFrame_; }
+    /// Return server system time in milliseconds when the current network update was prepared.
+    unsigned GetNetworkTime() const { return networkTime_; }
+    /// Set server time in seconds of the time-stamped network data being applied on the client, or zero when not applying any. Used to time-stamp transform interpolation samples. Called by Connection.
+    void SetReceivedNetworkTime(double time) { receivedNetworkTime_ = time; }
+    /// Return server time in seconds of the time-stamped network data being applied on the client, or zero when not applying any.
+    double GetReceivedNetworkTime() const { return receivedNetworkTime_; }
+    /// Set server time in seconds at which the client shows interpolated transforms. Zero uses exponential smoothing instead. Called by Network.
+    void SetNetworkInterpolationTime(double time) { networkInterpolationTime_ = time; }
+    /// Return server time in seconds at which the client shows interpolated transforms.
+    double GetNetworkInterpolationTime() const { return networkInterpolationTime_; }
+    /// Set cell size of the interest management grid on the server. Top-level replicated nodes are bucketed by position, and connections with an interest radius are only sent the nodes near them. Zero (default) disables.
+    void SetInterestCellSize(float size);
+    /// Return cell size of the interest management grid.
+    float GetInterestCellSize() const { return interestGrid_.GetCellSize(); }
+    /// Return interest management grid.
+    const InterestGrid& GetInterestGrid() const { return interestGrid_; }
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
     /// Mark a node for attribute check on the next network update.
@@ -313,43 +386,64 @@ public:
     /// Mark a node dirty in scene replication states. The node does not need to have own replication state yet.
     void MarkReplicationDirty(Node* node);
 
+    /// Typed variable timestep update signal, invoked right before E_SCENEUPDATE. Avoids event data lookups for high-frequency engine receivers.
+    Signal<SceneUpdateArgs> sceneUpdateEvent_;
+    /// Typed scene subsystem update signal, invoked right before E_SCENESUBSYSTEMUPDATE.
+    Signal<SceneUpdateArgs> sceneSubsystemUpdateEvent_;
+    /// Typed transform smoothing signal, invoked right before E_UPDATESMOOTHING.
+    Signal<SceneSmoothingArgs> updateSmoothingEvent_;
+    /// Typed variable timestep post-update signal, invoked right before E_SCENEPOSTUPDATE.
+    Signal<SceneUpdateArgs> scenePostUpdateEvent_;
+
 private:
     /// Handle the logic update event to update the scene, if active.
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    /// Update logic components of given phase. Thread-safe components are updated first, in parallel if possible.
+    void UpdateLogicComponents(UpdateEvent phase, float timeStep);
+    /// Update thread-safe logic components of given phase in parallel.
+    void UpdateLogicComponentsThreaded(LogicComponentUpdateList& list, UpdateEvent phase, float timeStep);
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    /// Handle physics pre-step event to run logic component fixed updates.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle physics post-step event to run logic component fixed post-updates.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
     /// Update asynchronous loading.
     void UpdateAsyncLoading();
     /// Finish asynchronous loading.
     void FinishAsyncLoading();
+    /// Read versioned binary data header after the file ID. Return true if successful.
+    bool ReadVersionedHeader(Deserializer& source, AttributeLayoutTable& layouts, unsigned& numNodes, unsigned& numComponents);
+    /// Load from versioned binary data after the file ID. Return true if successful.
+    bool LoadVersioned(Deserializer& source);
     /// Finish loading. Sets the scene filename and checksum.
     void FinishLoading(Deserializer* source);
     /// Finish saving. Sets the scene filename and checksum.
     void FinishSaving(Serializer* dest) const;
+    /// Start background loading a resource referenced by the scene being loaded asynchronously.
+    void PreloadResource(const ResourceRef& resource);
     /// Preload resources from a binary scene or object prefab file.
-    void PreloadResources(File* file, bool isSceneFile);
+    void PreloadResources(File* file, bool isSceneFile, const AttributeLayoutTable* layouts);
     /// Preload resources from an XML scene or object prefab file.
     void PreloadResourcesXML(const XMLElement& element);
     /// Preload resources from a JSON scene or object prefab file.
     void PreloadResourcesJSON(const JSONValue& value);
-    /// Return component index storage for given type.
-    SceneComponentIndex* GetMutableComponentIndex(StringHash componentType);
     /// Mark lightmap textures dirty.
     void MarkLightmapTexturesDirty() { lightmapTexturesDirty_ = true; }
 
-    /// Types of components that should be indexed.
-    ea::vector<StringHash> indexedComponentTypes_;
-    /// Indexes of components.
-    ea::vector<SceneComponentIndex> componentIndexes_;
+    /// Dense arrays of components by type.
+    ea::unordered_map<StringHash, SceneComponentIndex> componentIndexes_;
 
     /// Replicated scene nodes by ID.
-    ea::unordered_map<unsigned, Node*> replicatedNodes_;
+    IdMap<Node> replicatedNodes_{FIRST_REPLICATED_ID};
     /// Local scene nodes by ID.
-    ea::unordered_map<unsigned, Node*> localNodes_;
+    IdMap<Node> localNodes_{FIRST_LOCAL_ID};
     /// Replicated components by ID.
-    ea::unordered_map<unsigned, Component*> replicatedComponents_;
+    IdMap<Component> replicatedComponents_{FIRST_REPLICATED_ID};
     /// Local components by ID.
-    ea::unordered_map<unsigned, Component*> localComponents_;
+    IdMap<Component> localComponents_{FIRST_LOCAL_ID};
     /// Cached tagged nodes by tag.
     ea::unordered_map<StringHash, ea::vector<Node*> > taggedNodes_;
     /// Asynchronous loading progress.
@@ -366,6 +460,14 @@ private:
     ea::hash_set<unsigned> networkUpdateNodes_;
     /// Components to check for attribute changes on the next network update.
     ea::hash_set<unsigned> networkUpdateComponents_;
+    /// Scene update tasks of subsystems.
+    SceneUpdateScheduler updateScheduler_;
+    /// Logic component update lists per phase.
+    LogicComponentUpdateList logicUpdateLists_[NUM_LOGIC_UPDATE_PHASES];
+    /// Thread-safe logic component update lists per phase.
+    LogicComponentUpdateList threadSafeLogicUpdateLists_[NUM_LOGIC_UPDATE_PHASES];
+    /// Physics world driving logic component fixed updates.
+    WeakPtr<Component> fixedUpdateSource_;
     /// Delayed dirty notification queue for components.
     ea::vector<Component*> delayedDirtyComponents_;
     /// Mutex for the delayed dirty notification queue.
@@ -380,6 +482,16 @@ private:
     unsigned localNodeID_;
     /// Next free local component ID.
     unsigned localComponentID_;
+    /// Number of the current network update.
+    unsigned networkFrame_{};
+    /// Server system time of the current network update.
+    unsigned networkTime_{};
+    /// Server time of the network update being applied on the client.
+    double receivedNetworkTime_{};
+    /// Server time at which the client shows interpolated transforms.
+    double networkInterpolationTime_{};
+    /// Interest management grid of top-level replicated nodes.
+    InterestGrid interestGrid_;
     /// Scene source file checksum.
     mutable unsigned checksum_;
     /// Maximum milliseconds per frame to spend on async scene loading.
@@ -407,6 +519,33 @@ private:
     ea::vector<SharedPtr<Texture2D>> lightmapTextures_;
 };
 
+template <class T, class... Others, class Callback> void Scene::ForEachComponent(Callback callback, bool enabledOnly) const
+{
+    const auto isAccepted = [enabledOnly](const Component* component)
+    {
+        return component && (!enabledOnly || component->IsEnabledEffective());
+    };
+
+    for (Component* component : GetComponentIndex<T>())
+    {
+        if (!isAccepted(component))
+            continue;
+
+        Node* node = component->GetNode();
+        const ea::tuple<Others*...> others{ node->GetComponent<Others>()... };
+        if (!ea::apply([&](const auto*... other) { return (isAccepted(other) && ...); }, others))
+            continue;
+
+        ea::apply([&](auto*... other) { callback(static_cast<T*>(component), other...); }, others);
+    }
+}
+
+template <class T, class... Others> void Scene::QueryComponents(ea::vector<T*>& dest, bool enabledOnly) const
+{
+    dest.clear();
+    ForEachComponent<T, Others...>([&dest](T* component, Others*...) { dest.push_back(component); }, enabledOnly);
+}
+
 /// Register Scene library objects.
 void URHO3D_API RegisterSceneLibrary(Context* context);
 
@@ -42,6 +42,12 @@ void SceneResolver::Reset()
     components_.clear();
 }
 
+void SceneResolver::Reserve(unsigned numNodes, unsigned numComponents)
+{
+    nodes_.reserve(numNodes);
+    components_.reserve(numComponents);
+}
+
 void SceneResolver::AddNode(unsigned oldID, Node* node)
 {
     if (node)
@@ -44,6 +44,8 @@ public:
 
     /// Reset. Clear all remembered nodes and components.
     void Reset();
+    /// Preallocate for the expected number of nodes and components.
+    void Reserve(unsigned numNodes, unsigned numComponents);
     /// Remember a created node.
     void AddNode(unsigned oldID, Node* node);
     /// Remember a created component.
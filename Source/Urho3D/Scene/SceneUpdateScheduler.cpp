@@ -0,0 +1,217 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneUpdateScheduler.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Return whether two tasks may not run concurrently or out of order.
+bool IsConflicting(const SceneUpdateTaskDesc& lhs, const SceneUpdateTaskDesc& rhs)
+{
+    return (lhs.writes_ & (rhs.reads_ | rhs.writes_)) || (rhs.writes_ & lhs.reads_);
+}
+
+}
+
+void SceneUpdateScheduler::AddTask(const void* owner, const SceneUpdateTaskDesc& desc)
+{
+    if (running_)
+    {
+        pendingTasks_.emplace_back(owner, desc);
+        return;
+    }
+
+    Phase& phase = phases_[desc.phase_];
+    Task task;
+    task.owner_ = owner;
+    task.desc_ = desc;
+    phase.tasks_.push_back(ea::move(task));
+    phase.dirty_ = true;
+}
+
+void SceneUpdateScheduler::RemoveTasks(const void* owner)
+{
+    pendingTasks_.erase(ea::remove_if(pendingTasks_.begin(), pendingTasks_.end(),
+        [owner](const ea::pair<const void*, SceneUpdateTaskDesc>& task) { return task.first == owner; }), pendingTasks_.end());
+
+    for (Phase& phase : phases_)
+    {
+        for (Task& task : phase.tasks_)
+        {
+            if (task.owner_ != owner)
+                continue;
+
+            // The task may be executing right now, so only mark it while running
+            task.removed_ = true;
+            hasRemovedTasks_ = true;
+        }
+    }
+
+    if (!running_ && hasRemovedTasks_)
+        EraseRemovedTasks();
+}
+
+void SceneUpdateScheduler::Run(Scene* scene, SceneUpdatePhase phaseIndex, float timeStep)
+{
+    Phase& phase = phases_[phaseIndex];
+    if (phase.tasks_.empty())
+        return;
+
+    if (phase.dirty_)
+        UpdateSchedule(phase);
+
+    // Work queue may be used only from main thread
+    auto* queue = scene->GetSubsystem<WorkQueue>();
+    const bool threaded = queue && queue->GetNumThreads() && Thread::IsMainThread() && !queue->IsCompleting();
+
+    running_ = true;
+
+    const unsigned numTasks = phase.schedule_.size();
+    for (unsigned waveBegin = 0; waveBegin < numTasks; )
+    {
+        const unsigned wave = phase.tasks_[phase.schedule_[waveBegin]].wave_;
+        unsigned waveEnd = waveBegin + 1;
+        while (waveEnd < numTasks && phase.tasks_[phase.schedule_[waveEnd]].wave_ == wave)
+            ++waveEnd;
+
+        // Start thread-safe tasks on worker threads first
+        bool hasWorkItems = false;
+        if (threaded)
+        {
+            for (unsigned i = waveBegin; i < waveEnd; ++i)
+            {
+                Task& task = phase.tasks_[phase.schedule_[i]];
+                if (!task.desc_.threadSafe_ || task.removed_)
+                    continue;
+
+                if (!hasWorkItems)
+                {
+                    scene->BeginThreadedUpdate();
+                    hasWorkItems = true;
+                }
+                queue->AddWorkItem([&task, timeStep]() { task.desc_.function_(timeStep); }, M_MAX_UNSIGNED);
+            }
+        }
+
+        // Then execute the rest on the main thread in registration order
+        for (unsigned i = waveBegin; i < waveEnd; ++i)
+        {
+            Task& task = phase.tasks_[phase.schedule_[i]];
+            if ((threaded && task.desc_.threadSafe_) || task.removed_)
+                continue;
+
+            URHO3D_PROFILE("SceneUpdateTask");
+            URHO3D_PROFILE_ZONENAME(task.desc_.name_.c_str(), task.desc_.name_.length());
+            task.desc_.function_(timeStep);
+        }
+
+        if (hasWorkItems)
+        {
+            queue->Complete(M_MAX_UNSIGNED);
+            scene->EndThreadedUpdate();
+        }
+
+        waveBegin = waveEnd;
+    }
+
+    running_ = false;
+
+    // Apply changes requested by the tasks
+    if (hasRemovedTasks_)
+        EraseRemovedTasks();
+
+    if (!pendingTasks_.empty())
+    {
+        const auto pendingTasks = ea::move(pendingTasks_);
+        pendingTasks_.clear();
+        for (const auto& task : pendingTasks)
+            AddTask(task.first, task.second);
+    }
+}
+
+unsigned SceneUpdateScheduler::GetNumWaves(SceneUpdatePhase phaseIndex)
+{
+    Phase& phase = phases_[phaseIndex];
+    if (phase.dirty_)
+        UpdateSchedule(phase);
+    return phase.numWaves_;
+}
+
+void SceneUpdateScheduler::EraseRemovedTasks()
+{
+    for (Phase& phase : phases_)
+    {
+        const auto isRemoved = [](const Task& task) { return task.removed_; };
+        const auto iter = ea::remove_if(phase.tasks_.begin(), phase.tasks_.end(), isRemoved);
+        if (iter != phase.tasks_.end())
+        {
+            phase.tasks_.erase(iter, phase.tasks_.end());
+            phase.dirty_ = true;
+        }
+    }
+    hasRemovedTasks_ = false;
+}
+
+void SceneUpdateScheduler::UpdateSchedule(Phase& phase)
+{
+    // Each task runs in the wave after the last earlier task it conflicts with, which keeps conflicting tasks in registration order
+    phase.numWaves_ = 0;
+    const unsigned numTasks = phase.tasks_.size();
+    for (unsigned i = 0; i < numTasks; ++i)
+    {
+        Task& task = phase.tasks_[i];
+        task.wave_ = 0;
+        for (unsigned j = 0; j < i; ++j)
+        {
+            const Task& otherTask = phase.tasks_[j];
+            if (otherTask.wave_ >= task.wave_ && IsConflicting(task.desc_, otherTask.desc_))
+                task.wave_ = otherTask.wave_ + 1;
+        }
+        phase.numWaves_ = Max(phase.numWaves_, task.wave_ + 1);
+    }
+
+    phase.schedule_.resize(numTasks);
+    for (unsigned i = 0; i < numTasks; ++i)
+        phase.schedule_[i] = i;
+
+    ea::stable_sort(phase.schedule_.begin(), phase.schedule_.end(),
+        [&phase](unsigned lhs, unsigned rhs) { return phase.tasks_[lhs].wave_ < phase.tasks_[rhs].wave_; });
+
+    phase.dirty_ = false;
+}
+
+}
@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/FlagSet.h"
+#include "../Core/Object.h"
+
+#include <EASTL/functional.h>
+
+namespace Urho3D
+{
+
+class Scene;
+
+/// Phase of the scene update, in execution order. Each phase runs right before the corresponding scene update event.
+enum SceneUpdatePhase
+{
+    /// Variable timestep logic update, before E_SCENEUPDATE.
+    SUP_UPDATE = 0,
+    /// Attribute animation update, before E_ATTRIBUTEANIMATIONUPDATE.
+    SUP_ATTRIBUTEANIMATION,
+    /// Scene subsystem update, before E_SCENESUBSYSTEMUPDATE.
+    SUP_SUBSYSTEM,
+    /// Transform smoothing, before E_UPDATESMOOTHING.
+    SUP_SMOOTHING,
+    /// Variable timestep logic post-update, before E_SCENEPOSTUPDATE.
+    SUP_POSTUPDATE,
+    MAX_SCENE_UPDATE_PHASES
+};
+
+/// Scene data that scene update tasks read or write. Tasks whose access conflicts are executed in registration order; other tasks may run concurrently.
+enum SceneUpdateResource : unsigned
+{
+    SUR_NONE = 0,
+    /// Node transforms.
+    SUR_NODE_TRANSFORMS = 1 << 0,
+    /// Node and component attributes other than transforms.
+    SUR_ATTRIBUTES = 1 << 1,
+    /// 3D physics simulation state.
+    SUR_PHYSICS = 1 << 2,
+    /// 2D physics simulation state.
+    SUR_PHYSICS2D = 1 << 3,
+    /// Navigation meshes.
+    SUR_NAVIGATION = 1 << 4,
+    /// Navigation crowd state.
+    SUR_CROWD = 1 << 5,
+    /// Animation state.
+    SUR_ANIMATION = 1 << 6,
+    /// Arbitrary user code, such as event handlers. Like any resource, it conflicts only through read/write overlap: a task writing it conflicts with every task reading it, which includes tasks left at the default SUR_ALL.
+    SUR_USER_LOGIC = 1 << 7,
+    /// All resources.
+    SUR_ALL = 0xffffffff
+};
+URHO3D_FLAGSET(SceneUpdateResource, SceneUpdateResourceFlags);
+
+/// Description of a scene update task.
+struct URHO3D_API SceneUpdateTaskDesc
+{
+    /// Name for debugging and profiling.
+    ea::string name_;
+    /// Update phase.
+    SceneUpdatePhase phase_{ SUP_SUBSYSTEM };
+    /// Resources read by the task.
+    SceneUpdateResourceFlags reads_{ SUR_ALL };
+    /// Resources written by the task.
+    SceneUpdateResourceFlags writes_{ SUR_ALL };
+    /// Whether the task may be executed on a worker thread. Thread-safe tasks must not send events or create or remove objects.
+    bool threadSafe_{};
+    /// Task function. Receives the scaled scene timestep.
+    ea::function<void(float)> function_;
+};
+
+/// Schedules scene update tasks of each phase into waves of tasks that do not conflict.
+/// Waves execute in order. Within a wave, thread-safe tasks run on worker threads while the other tasks run on the main thread in registration order.
+class URHO3D_API SceneUpdateScheduler
+{
+public:
+    /// Add task owned by an object. The task is removed when the owner calls RemoveTasks.
+    void AddTask(const void* owner, const SceneUpdateTaskDesc& desc);
+    /// Remove all tasks of an owner.
+    void RemoveTasks(const void* owner);
+    /// Execute tasks of a phase.
+    void Run(Scene* scene, SceneUpdatePhase phase, float timeStep);
+
+    /// Return whether the phase has any tasks.
+    bool HasTasks(SceneUpdatePhase phase) const { return !phases_[phase].tasks_.empty(); }
+    /// Return number of waves in the phase. Recalculates the schedule if needed.
+    unsigned GetNumWaves(SceneUpdatePhase phase);
+
+private:
+    /// Registered task.
+    struct Task
+    {
+        /// Owner.
+        const void* owner_{};
+        /// Description.
+        SceneUpdateTaskDesc desc_;
+        /// Index of the wave the task is executed in.
+        unsigned wave_{};
+        /// Whether the task was removed while the tasks were running.
+        bool removed_{};
+    };
+
+    /// Tasks of one phase.
+    struct Phase
+    {
+        /// Tasks in registration order.
+        ea::vector<Task> tasks_;
+        /// Task indices sorted by wave, in registration order within a wave.
+        ea::vector<unsigned> schedule_;
+        /// Number of waves.
+        unsigned numWaves_{};
+        /// Whether the schedule should be recalculated.
+        bool dirty_{};
+    };
+
+    /// Erase tasks marked as removed.
+    void EraseRemovedTasks();
+    /// Recalculate schedule of a phase.
+    void UpdateSchedule(Phase& phase);
+
+    /// Phases.
+    Phase phases_[MAX_SCENE_UPDATE_PHASES];
+    /// Tasks added while the tasks were running.
+    ea::vector<ea::pair<const void*, SceneUpdateTaskDesc>> pendingTasks_;
+    /// Whether tasks are running. Adding and removing tasks is deferred meanwhile.
+    bool running_{};
+    /// Whether tasks were removed while running.
+    bool hasRemovedTasks_{};
+};
+
+}
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../IO/Archive.h"
 #include "../IO/ArchiveSerialization.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -63,6 +64,78 @@ static unsigned RemapAttributeIndex(const ea::vector<AttributeInfo>* attributes,
     return netAttrIndex; // Could not remap
 }
 
+/// Write attribute value for network replication, quantized if the attribute declares it.
+static void WriteNetworkValue(Serializer& dest, const AttributeInfo& attr, const Variant& value)
+{
+    const AttributeQuantization& quantization = attr.quantization_;
+    if (!quantization.IsApplicable(attr.type_))
+    {
+        dest.WriteVariantData(value);
+        return;
+    }
+
+    BitStreamWriter writer(dest);
+    if (quantization.mode_ == AQ_QUATERNION)
+    {
+        writer.WriteQuaternion(value.GetQuaternion(), quantization.numBits_);
+        return;
+    }
+
+    float components[4]{};
+    unsigned numComponents = 0;
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        components[0] = value.GetFloat();
+        numComponents = 1;
+        break;
+    case VAR_VECTOR2:
+        memcpy(components, value.GetVector2().Data(), sizeof(Vector2));
+        numComponents = 2;
+        break;
+    case VAR_VECTOR3:
+        memcpy(components, value.GetVector3().Data(), sizeof(Vector3));
+        numComponents = 3;
+        break;
+    default:
+        memcpy(components, value.GetVector4().Data(), sizeof(Vector4));
+        numComponents = 4;
+        break;
+    }
+
+    for (unsigned i = 0; i < numComponents; ++i)
+        writer.WriteQuantizedFloat(components[i], quantization.minValue_, quantization.maxValue_, quantization.numBits_);
+}
+
+/// Read attribute value for network replication, quantized if the attribute declares it.
+static Variant ReadNetworkValue(Deserializer& source, const AttributeInfo& attr)
+{
+    const AttributeQuantization& quantization = attr.quantization_;
+    if (!quantization.IsApplicable(attr.type_))
+        return source.ReadVariant(attr.type_);
+
+    BitStreamReader reader(source);
+    if (quantization.mode_ == AQ_QUATERNION)
+        return reader.ReadQuaternion(quantization.numBits_);
+
+    float components[4]{};
+    const unsigned numComponents = attr.type_ == VAR_FLOAT ? 1 : attr.type_ == VAR_VECTOR2 ? 2 : attr.type_ == VAR_VECTOR3 ? 3 : 4;
+    for (unsigned i = 0; i < numComponents; ++i)
+        components[i] = reader.ReadQuantizedFloat(quantization.minValue_, quantization.maxValue_, quantization.numBits_);
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return components[0];
+    case VAR_VECTOR2:
+        return Vector2(components[0], components[1]);
+    case VAR_VECTOR3:
+        return Vector3(components[0], components[1], components[2]);
+    default:
+        return Vector4(components[0], components[1], components[2], components[3]);
+    }
+}
+
 static bool SaveAttributeWithName(Archive& archive, const AttributeInfo& attr, const Variant& value)
 {
     assert(!archive.IsInput());
@@ -369,6 +442,28 @@ bool Serializable::Load(Deserializer& source)
     return true;
 }
 
+bool Serializable::LoadAttributeValues(const ea::vector<Variant>& values)
+{
+    const ea::vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    if (values.size() != attributes->size())
+    {
+        URHO3D_LOGERROR("Could not load " + GetTypeName() + ", attribute count mismatch");
+        return false;
+    }
+
+    for (unsigned i = 0; i < attributes->size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if (attr.ShouldLoad() && !values[i].IsEmpty())
+            OnSetAttribute(attr, values[i]);
+    }
+
+    return true;
+}
+
 bool Serializable::Save(Serializer& dest) const
 {
     const ea::vector<AttributeInfo>* attributes = GetAttributes();
@@ -1031,7 +1126,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -1057,7 +1152,7 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -1080,7 +1175,7 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributes->at(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteNetworkValue(dest, attributes->at(i), networkState_->currentValues_[i]);
     }
 }
 
@@ -1105,7 +1200,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
             const AttributeInfo& attr = attributes->at(i);
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkValue(source, attr));
                 changed = true;
             }
             else
@@ -1117,7 +1212,7 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkValue(source, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
@@ -1145,7 +1240,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
         {
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, ReadNetworkValue(source, attr));
                 changed = true;
             }
             else
@@ -1157,7 +1252,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = ReadNetworkValue(source, attr);
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
@@ -71,6 +71,8 @@ public:
     virtual bool Load(Deserializer& source);
     /// Save as binary data. Return true if successful.
     virtual bool Save(Serializer& dest) const;
+    /// Load from attribute values parsed in advance, indexed by attribute. Empty values are skipped. Classes that override Load() should override this as well. Return true if successful.
+    virtual bool LoadAttributeValues(const ea::vector<Variant>& values);
     /// Load from XML data. Return true if successful.
     virtual bool LoadXML(const XMLElement& source);
     /// Save as XML data. Return true if successful.
@@ -32,12 +32,14 @@
 namespace Urho3D
 {
 
+/// Maximum number of buffered interpolation samples.
+static const unsigned MAX_INTERPOLATION_SAMPLES = 16;
+
 SmoothedTransform::SmoothedTransform(Context* context) :
     Component(context),
     targetPosition_(Vector3::ZERO),
     targetRotation_(Quaternion::IDENTITY),
-    smoothingMask_(SMOOTH_NONE),
-    subscribed_(false)
+    smoothingMask_(SMOOTH_NONE)
 {
 }
 
@@ -90,23 +92,76 @@ void SmoothedTransform::Update(float constant, float squaredSnapThreshold)
 
     // If smoothing has completed, unsubscribe from the update event
     if (!smoothingMask_)
+        UnsubscribeFromSmoothing();
+}
+
+void SmoothedTransform::UpdateInterpolation(double time, float squaredSnapThreshold)
+{
+    // Keep only the latest sample at or before the interpolation time, and the ones after it
+    unsigned numExpired = 0;
+    while (numExpired + 1 < samples_.size() && samples_[numExpired + 1].time_ <= time)
+        ++numExpired;
+    samples_.erase(samples_.begin(), samples_.begin() + numExpired);
+
+    const Sample& from = samples_.front();
+    if (samples_.size() == 1 || time <= from.time_)
     {
-        UnsubscribeFromEvent(GetScene(), E_UPDATESMOOTHING);
-        subscribed_ = false;
+        // Hold the only sample, or the first one until the interpolation time reaches it
+        node_->SetPosition(from.position_);
+        node_->SetRotation(from.rotation_);
+        if (samples_.size() == 1 && time >= from.time_)
+            smoothingMask_ = SMOOTH_NONE;
+        return;
     }
+
+    const Sample& to = samples_[1];
+    const float t = (float)((time - from.time_) / (to.time_ - from.time_));
+    if ((to.position_ - from.position_).LengthSquared() > squaredSnapThreshold)
+        node_->SetPosition(to.position_);
+    else
+        node_->SetPosition(from.position_.Lerp(to.position_, t));
+    node_->SetRotation(from.rotation_.Slerp(to.rotation_, t));
+}
+
+void SmoothedTransform::AddSample()
+{
+    Scene* scene = GetScene();
+    const double time = scene ? scene->GetReceivedNetworkTime() : 0.0;
+    if (time <= 0.0)
+    {
+        // Targets set by the application or by unstamped network data are smoothed toward instead of interpolated
+        samples_.clear();
+        return;
+    }
+
+    if (!samples_.empty() && time == samples_.back().time_)
+    {
+        // Position and rotation of the same update
+        samples_.back().position_ = targetPosition_;
+        samples_.back().rotation_ = targetRotation_;
+        return;
+    }
+    // Updates received out of order are too late to interpolate
+    if (!samples_.empty() && time < samples_.back().time_)
+        return;
+
+    // The server only sends changes, so a node that was at rest stayed there until now rather than since its last sample
+    if (samples_.size() == 1)
+        samples_.front().time_ = Max(samples_.front().time_, Min(scene->GetNetworkInterpolationTime(), time));
+
+    if (samples_.size() >= MAX_INTERPOLATION_SAMPLES)
+        samples_.erase(samples_.begin());
+    samples_.push_back(Sample{time, targetPosition_, targetRotation_});
 }
 
 void SmoothedTransform::SetTargetPosition(const Vector3& position)
 {
     targetPosition_ = position;
     smoothingMask_ |= SMOOTH_POSITION;
+    AddSample();
 
     // Subscribe to smoothing update if not yet subscribed
-    if (!subscribed_)
-    {
-        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_HANDLER(SmoothedTransform, HandleUpdateSmoothing));
-        subscribed_ = true;
-    }
+    SubscribeToSmoothing();
 
     SendEvent(E_TARGETPOSITION);
 }
@@ -115,12 +170,9 @@ void SmoothedTransform::SetTargetRotation(const Quaternion& rotation)
 {
     targetRotation_ = rotation;
     smoothingMask_ |= SMOOTH_ROTATION;
+    AddSample();
 
-    if (!subscribed_)
-    {
-        SubscribeToEvent(GetScene(), E_UPDATESMOOTHING, URHO3D_HANDLER(SmoothedTransform, HandleUpdateSmoothing));
-        subscribed_ = true;
-    }
+    SubscribeToSmoothing();
 
     SendEvent(E_TARGETROTATION);
 }
@@ -167,13 +219,42 @@ void SmoothedTransform::OnNodeSet(Node* node)
     }
 }
 
-void SmoothedTransform::HandleUpdateSmoothing(StringHash eventType, VariantMap& eventData)
+void SmoothedTransform::OnSceneSet(Scene* scene)
 {
-    using namespace UpdateSmoothing;
+    UnsubscribeFromSmoothing();
+    if (scene && smoothingMask_)
+        SubscribeToSmoothing();
+}
 
-    float constant = eventData[P_CONSTANT].GetFloat();
-    float squaredSnapThreshold = eventData[P_SQUAREDSNAPTHRESHOLD].GetFloat();
-    Update(constant, squaredSnapThreshold);
+void SmoothedTransform::SubscribeToSmoothing()
+{
+    Scene* scene = GetScene();
+    if (scene && subscribedScene_ != scene)
+    {
+        UnsubscribeFromSmoothing();
+        scene->updateSmoothingEvent_.Subscribe(this, &SmoothedTransform::HandleUpdateSmoothing);
+        subscribedScene_ = scene;
+    }
+}
+
+void SmoothedTransform::UnsubscribeFromSmoothing()
+{
+    if (subscribedScene_)
+        subscribedScene_->updateSmoothingEvent_.Unsubscribe(this);
+    subscribedScene_ = nullptr;
+}
+
+bool SmoothedTransform::HandleUpdateSmoothing(RefCounted* sender, SceneSmoothingArgs& args)
+{
+    if (args.interpolationTime_ > 0.0 && !samples_.empty() && node_)
+    {
+        UpdateInterpolation(args.interpolationTime_, args.squaredSnapThreshold_);
+        if (!smoothingMask_)
+            UnsubscribeFromSmoothing();
+    }
+    else
+        Update(args.constant_, args.squaredSnapThreshold_);
+    return subscribedScene_ != nullptr;
 }
 
 }
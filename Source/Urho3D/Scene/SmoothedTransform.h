@@ -29,6 +29,8 @@
 namespace Urho3D
 {
 
+struct SceneSmoothingArgs;
+
 enum SmoothingType : unsigned
 {
     /// No ongoing smoothing.
@@ -40,7 +42,7 @@ enum SmoothingType : unsigned
 };
 URHO3D_FLAGSET(SmoothingType, SmoothingTypeFlags);
 
-/// Transform smoothing component for network updates.
+/// Transform smoothing component for network updates. Interpolates between time-stamped server updates when the client has network interpolation enabled, otherwise smooths exponentially toward the latest target.
 class URHO3D_API SmoothedTransform : public Component
 {
     URHO3D_OBJECT(SmoothedTransform, Component);
@@ -86,14 +88,37 @@ public:
     /// Return whether smoothing is in progress.
     /// @property
     bool IsInProgress() const { return smoothingMask_ != SMOOTH_NONE; }
+    /// Return number of buffered interpolation samples.
+    unsigned GetNumSamples() const { return samples_.size(); }
 
 protected:
     /// Handle scene node being assigned at creation.
     void OnNodeSet(Node* node) override;
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Handle smoothing update event.
-    void HandleUpdateSmoothing(StringHash eventType, VariantMap& eventData);
+    /// Subscribe to smoothing update of the current scene if not subscribed yet.
+    void SubscribeToSmoothing();
+    /// Unsubscribe from smoothing update.
+    void UnsubscribeFromSmoothing();
+    /// Handle smoothing update. Return false to unsubscribe.
+    bool HandleUpdateSmoothing(RefCounted* sender, SceneSmoothingArgs& args);
+    /// Buffer current targets as a sample at the server time of the network data being applied. Clear the samples if the targets were not set from time-stamped network data.
+    void AddSample();
+    /// Interpolate between buffered samples at the given server time.
+    void UpdateInterpolation(double time, float squaredSnapThreshold);
+
+    /// Time-stamped target transform.
+    struct Sample
+    {
+        /// Server time in seconds.
+        double time_;
+        /// Position in parent space.
+        Vector3 position_;
+        /// Rotation in parent space.
+        Quaternion rotation_;
+    };
 
     /// Target position.
     Vector3 targetPosition_;
@@ -101,8 +126,10 @@ private:
     Quaternion targetRotation_;
     /// Active smoothing operations bitmask.
     SmoothingTypeFlags smoothingMask_;
-    /// Subscribed to smoothing update event flag.
-    bool subscribed_;
+    /// Interpolation samples in time order.
+    ea::vector<Sample> samples_;
+    /// Scene whose smoothing update is subscribed to.
+    WeakPtr<Scene> subscribedScene_;
 };
 
 }
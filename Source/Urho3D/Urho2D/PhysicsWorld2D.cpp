@@ -704,20 +704,30 @@ bool PhysicsWorld2D::GetAutoClearForces() const
 
 void PhysicsWorld2D::OnSceneSet(Scene* scene)
 {
-    // Subscribe to the scene subsystem update, which will trigger the physics simulation step
+    if (scene_)
+        scene_->GetUpdateScheduler().RemoveTasks(this);
+
+    // Add the scene subsystem update task, which will trigger the physics simulation step
+    scene_ = scene;
     if (scene)
-        SubscribeToEvent(scene, E_SCENESUBSYSTEMUPDATE, URHO3D_HANDLER(PhysicsWorld2D, HandleSceneSubsystemUpdate));
-    else
-        UnsubscribeFromEvent(E_SCENESUBSYSTEMUPDATE);
+    {
+        // Contact and step events may run arbitrary user code, so the step is executed on the main thread in order
+        SceneUpdateTaskDesc task;
+        task.name_ = "PhysicsWorld2D";
+        task.phase_ = SUP_SUBSYSTEM;
+        task.reads_ = SUR_ALL;
+        task.writes_ = SUR_PHYSICS2D | SUR_NODE_TRANSFORMS | SUR_USER_LOGIC;
+        task.function_ = [this](float timeStep) { HandleSceneSubsystemUpdate(timeStep); };
+        scene->GetUpdateScheduler().AddTask(this, task);
+    }
 }
 
-void PhysicsWorld2D::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData)
+void PhysicsWorld2D::HandleSceneSubsystemUpdate(float timeStep)
 {
     if (!updateEnabled_)
         return;
 
-    using namespace SceneSubsystemUpdate;
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(timeStep);
 }
 
 void PhysicsWorld2D::SendBeginContactEvents()
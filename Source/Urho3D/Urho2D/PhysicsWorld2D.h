@@ -237,8 +237,8 @@ protected:
     /// Handle scene being assigned.
     void OnSceneSet(Scene* scene) override;
 
-    /// Handle the scene subsystem update event, step simulation here.
-    void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the scene subsystem update task, step simulation here.
+    void HandleSceneSubsystemUpdate(float timeStep);
     /// Send begin contact events.
     void SendBeginContactEvents();
     /// Send end contact events.